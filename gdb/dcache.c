@@ -24,6 +24,7 @@
 #include "inferior.h"
 #include "splay-tree.h"
 #include "gdbarch.h"
+#include "gdbsupport/byte-vector.h"
 
 /* Commands with a prefix of `{set,show} dcache'.  */
 static struct cmd_list_element *dcache_set_list = NULL;
@@ -390,6 +391,69 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   return db;
 }
 
+/* Return true if the line containing ADDR is in DCACHE.  Unlike
+   dcache_hit, this doesn't count as a use of the line.  */
+
+static bool
+dcache_line_cached_p (DCACHE *dcache, CORE_ADDR addr)
+{
+  return splay_tree_lookup (dcache->tree,
+			    (splay_tree_key) MASK (dcache, addr)) != nullptr;
+}
+
+/* Fill the lines of DCACHE in [START, END) that aren't cached yet
+   with a single request, if the target can read several ranges at
+   once.  START and END must be line aligned.  Runs of adjacent missing
+   lines are read as one range.  Lines crossing into another memory
+   region or in a write-only one are left to dcache_read_line.
+   Returns false if the target can't read several ranges at once.  */
+
+static bool
+dcache_fill_lines (DCACHE *dcache, CORE_ADDR start, CORE_ADDR end)
+{
+  /* Don't bother collecting the ranges if they can't be read.  */
+  if (!target_read_memory_ranges ({}))
+    return false;
+
+  std::vector<memory_read_range> ranges;
+  gdb::byte_vector buf (end - start);
+
+  for (CORE_ADDR addr = start; addr < end; addr += dcache->line_size)
+    {
+      if (dcache_line_cached_p (dcache, addr))
+	continue;
+
+      struct mem_region *region = lookup_mem_region (addr);
+      if (region->attrib.mode == MEM_WO
+	  || (region->hi != 0 && addr + dcache->line_size > region->hi))
+	continue;
+
+      if (!ranges.empty () && ranges.back ().addr + ranges.back ().len == addr)
+	ranges.back ().len += dcache->line_size;
+      else
+	ranges.push_back ({ addr, (ULONGEST) dcache->line_size,
+			    &buf[addr - start] });
+    }
+
+  if (ranges.empty ())
+    return true;
+
+  if (!target_read_memory_ranges (ranges))
+    return false;
+
+  /* Keep only the lines that were read in full.  */
+  for (const memory_read_range &range : ranges)
+    for (ULONGEST offset = 0;
+	 offset + dcache->line_size <= range.xfered_len;
+	 offset += dcache->line_size)
+      {
+	struct dcache_block *db = dcache_alloc (dcache, range.addr + offset);
+	memcpy (db->data, range.buf + offset, dcache->line_size);
+      }
+
+  return true;
+}
+
 /* Using the data cache DCACHE, store in *PTR the contents of the byte at
    address ADDR in the remote machine.  
 
@@ -463,6 +527,21 @@ dcache_init (void)
 }
 
 
+/* If the current thread is a different thread from what we've
+   recorded in DCACHE, flush the cache.  */
+
+static void
+dcache_check_thread (DCACHE *dcache)
+{
+  process_stratum_target *proc_target = current_inferior ()->process_target ();
+  if (proc_target != dcache->proc_target || inferior_ptid != dcache->ptid)
+    {
+      dcache_invalidate (dcache);
+      dcache->ptid = inferior_ptid;
+      dcache->proc_target = proc_target;
+    }
+}
+
 /* Read LEN bytes from dcache memory at MEMADDR, transferring to
    debugger address MYADDR.  If the data is presently cached, this
    fills the cache.  Arguments/return are like the target_xfer_partial
@@ -475,15 +554,19 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
 {
   ULONGEST i;
 
-  /* If this is a different thread from what we've recorded, flush the
-     cache.  */
+  dcache_check_thread (dcache);
 
-  process_stratum_target *proc_target = current_inferior ()->process_target ();
-  if (proc_target != dcache->proc_target || inferior_ptid != dcache->ptid)
+  /* If the read spans several lines, fetch the missing ones with one
+     request instead of one request per line.  */
+  if (len > 0)
     {
-      dcache_invalidate (dcache);
-      dcache->ptid = inferior_ptid;
-      dcache->proc_target = proc_target;
+      CORE_ADDR start = MASK (dcache, memaddr);
+      CORE_ADDR end = MASK (dcache, memaddr + len - 1) + dcache->line_size;
+
+      if (start < end
+	  && end - start > dcache->line_size
+	  && (end - start) / dcache->line_size <= dcache_size)
+	dcache_fill_lines (dcache, start, end);
     }
 
   for (i = 0; i < len; i++)
@@ -542,6 +625,66 @@ dcache_update (DCACHE *dcache, enum target_xfer_status status,
       }
 }
 
+/* See dcache.h.  */
+
+void
+dcache_prefetch (DCACHE *dcache, CORE_ADDR memaddr, ULONGEST len)
+{
+  dcache_check_thread (dcache);
+
+  /* Don't read more than fits in the cache.  */
+  len = std::min (len, (ULONGEST) dcache_size * dcache->line_size);
+  if (len == 0)
+    return;
+
+  CORE_ADDR start = MASK (dcache, memaddr);
+  CORE_ADDR end = MASK (dcache, memaddr + len - 1) + dcache->line_size;
+  if (end <= start)
+    return;
+
+  /* If the target can, read just the lines not cached yet.  */
+  if (dcache_fill_lines (dcache, start, end))
+    return;
+
+  /* Otherwise read the range with as few requests as the target
+     allows, stopping at the first byte that can't be read, e.g. because
+     the range runs past the end of the stack mapping, or at the end of
+     the memory region.  */
+  struct mem_region *region = lookup_mem_region (start);
+  if (region->attrib.mode == MEM_WO)
+    return;
+  if (region->hi != 0 && end > region->hi)
+    end = region->hi;
+
+  gdb::byte_vector buf (end - start);
+  ULONGEST xfered_total = 0;
+  while (xfered_total < end - start)
+    {
+      ULONGEST xfered_len;
+      enum target_xfer_status status
+	= target_xfer_partial (current_inferior ()->top_target (),
+			       TARGET_OBJECT_RAW_MEMORY, NULL,
+			       buf.data () + xfered_total, NULL,
+			       start + xfered_total,
+			       end - start - xfered_total, &xfered_len);
+      if (status != TARGET_XFER_OK)
+	break;
+      xfered_total += xfered_len;
+    }
+
+  /* Cache the lines that were read completely.  */
+  for (CORE_ADDR addr = start;
+       addr + dcache->line_size <= start + xfered_total;
+       addr += dcache->line_size)
+    {
+      if (dcache_line_cached_p (dcache, addr))
+	continue;
+
+      struct dcache_block *db = dcache_alloc (dcache, addr);
+      memcpy (db->data, &buf[addr - start], dcache->line_size);
+    }
+}
+
 /* Print DCACHE line INDEX.  */
 
 static void
@@ -52,4 +52,11 @@ void dcache_update (DCACHE *dcache, enum target_xfer_status status,
 		    CORE_ADDR memaddr, const gdb_byte *myaddr,
 		    ULONGEST len);
 
+/* Fill the lines of DCACHE covering LEN bytes at MEMADDR with a single
+   read from target memory, on behalf of the current thread.  Lines
+   already in the cache are left alone.  If the range can't be read as a
+   whole, only the lines before the first unreadable byte are filled.  */
+
+void dcache_prefetch (DCACHE *dcache, CORE_ADDR memaddr, ULONGEST len);
+
 #endif /* DCACHE_H */
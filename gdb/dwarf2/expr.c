@@ -1444,6 +1444,46 @@ dwarf_block_to_fb_offset (const gdb_byte *buf, const gdb_byte *buf_end,
   return 1;
 }
 
+/* If <BUF..BUF_END] contains DW_FORM_block* with single DW_OP_breg*(X) fill
+   in OFFSET_RETURN with the X offset and return the DWARF register number.
+   Otherwise return -1.  */
+
+int
+dwarf_block_to_breg_offset (const gdb_byte *buf, const gdb_byte *buf_end,
+			    CORE_ADDR *offset_return)
+{
+  uint64_t dwarf_reg;
+  int64_t offset;
+
+  if (buf_end <= buf)
+    return -1;
+  if (*buf >= DW_OP_breg0 && *buf <= DW_OP_breg31)
+    {
+      dwarf_reg = *buf - DW_OP_breg0;
+      buf++;
+    }
+  else
+    {
+      if (*buf != DW_OP_bregx)
+	return -1;
+      buf++;
+      buf = gdb_read_uleb128 (buf, buf_end, &dwarf_reg);
+      if (buf == NULL)
+	return -1;
+      if ((int) dwarf_reg != dwarf_reg)
+	return -1;
+    }
+
+  buf = gdb_read_sleb128 (buf, buf_end, &offset);
+  if (buf == NULL)
+    return -1;
+  *offset_return = offset;
+  if (buf != buf_end || offset != (LONGEST) *offset_return)
+    return -1;
+
+  return dwarf_reg;
+}
+
 /* If <BUF..BUF_END] contains DW_FORM_block* with single DW_OP_bregSP(X) fill
    in SP_OFFSET_RETURN with the X offset and return 1.  Otherwise return 0.
    The matched SP register number depends on GDBARCH.  */
@@ -270,6 +270,9 @@ int dwarf_block_to_dwarf_reg_deref (const gdb_byte *buf,
 int dwarf_block_to_fb_offset (const gdb_byte *buf, const gdb_byte *buf_end,
 			      CORE_ADDR *fb_offset_return);
 
+int dwarf_block_to_breg_offset (const gdb_byte *buf, const gdb_byte *buf_end,
+				CORE_ADDR *offset_return);
+
 int dwarf_block_to_sp_offset (struct gdbarch *gdbarch, const gdb_byte *buf,
 			      const gdb_byte *buf_end,
 			      CORE_ADDR *sp_offset_return);
@@ -31,6 +31,8 @@
 #include "regcache.h"
 #include "value.h"
 #include "record.h"
+#include "observable.h"
+#include "cli/cli-cmds.h"
 
 #include "complaints.h"
 #include "dwarf2/frame.h"
@@ -1619,11 +1621,75 @@ set_comp_unit (struct objfile *objfile, struct comp_unit *unit)
   return dwarf2_frame_bfd_data.set (abfd, unit);
 }
 
-/* Find the FDE for *PC.  Return a pointer to the FDE, and store the
-   initial location associated with it into *PC.  */
+/* A cache of the results of dwarf2_frame_find_fde, stored per program
+   space.  Looking up an FDE means searching the FDE table of every
+   objfile in turn, which is expensive when there are many shared
+   libraries and is done at least twice for every frame unwound.  The
+   results only depend on the set of objfiles, so they are kept across
+   stops and discarded whenever an objfile is added, removed or
+   relocated.  */
+
+struct dwarf2_fde_lookup_cache
+{
+  struct entry
+  {
+    /* The FDE covering the PC, or NULL if there is none.  */
+    dwarf2_fde *fde;
+
+    /* The objfile FDE belongs to, and its text section offset at the
+       time of the lookup.  */
+    objfile *objf;
+    CORE_ADDR offset;
+  };
+
+  /* Map from a (relocated) PC to the result of looking it up.  */
+  std::unordered_map<CORE_ADDR, entry> entries;
+
+  /* Statistics for "maint info dwarf-frame-cache".  */
+  unsigned int hits = 0;
+  unsigned int misses = 0;
+};
+
+/* The maximum number of PCs cached per program space.  The cache is
+   simply emptied when it grows past this.  */
+
+static const size_t dwarf2_fde_lookup_cache_max = 65536;
+
+static const registry<program_space>::key<dwarf2_fde_lookup_cache>
+  dwarf2_fde_lookup_cache_data;
+
+/* Return the FDE lookup cache for PSPACE, creating it if needed.  */
+
+static dwarf2_fde_lookup_cache *
+get_fde_lookup_cache (program_space *pspace)
+{
+  dwarf2_fde_lookup_cache *cache = dwarf2_fde_lookup_cache_data.get (pspace);
+  if (cache == nullptr)
+    cache = dwarf2_fde_lookup_cache_data.emplace (pspace);
+  return cache;
+}
+
+/* Discard the cached FDE lookups of the program space of OBJFILE, as
+   OBJFILE is being added, removed or relocated.  Negative entries are
+   discarded too, as the PC they were looked up for may now be covered
+   by OBJFILE.  */
+
+static void
+dwarf2_fde_lookup_cache_invalidate (struct objfile *objfile)
+{
+  dwarf2_fde_lookup_cache *cache
+    = dwarf2_fde_lookup_cache_data.get (objfile->pspace ());
+  if (cache != nullptr)
+    cache->entries.clear ();
+}
+
+/* Find the FDE for *PC by searching all objfiles of the current
+   program space.  Return a pointer to the FDE, and store the objfile
+   it belongs to into *OUT_OBJFILE.  Return NULL if there is no FDE
+   for *PC.  */
 
 static struct dwarf2_fde *
-dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
+dwarf2_frame_find_fde_1 (CORE_ADDR pc, objfile **out_objfile)
 {
   for (objfile *objfile : current_program_space->objfiles ())
     {
@@ -1648,7 +1714,7 @@ dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
       offset = objfile->text_section_offset ();
 
       gdb_assert (!fde_table->empty ());
-      unrelocated_addr seek_pc = (unrelocated_addr) (*pc - offset);
+      unrelocated_addr seek_pc = (unrelocated_addr) (pc - offset);
       if (seek_pc < (*fde_table)[0]->initial_location)
 	continue;
 
@@ -1656,16 +1722,67 @@ dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
 				    seek_pc, bsearch_fde_cmp);
       if (it != fde_table->end ())
 	{
-	  *pc = (CORE_ADDR) (*it)->initial_location + offset;
-	  if (out_per_objfile != nullptr)
-	    *out_per_objfile = get_dwarf2_per_objfile (objfile);
-
+	  *out_objfile = objfile;
 	  return *it;
 	}
     }
   return NULL;
 }
 
+/* Find the FDE for *PC.  Return a pointer to the FDE, and store the
+   initial location associated with it into *PC.  */
+
+static struct dwarf2_fde *
+dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
+{
+  dwarf2_fde_lookup_cache *cache
+    = get_fde_lookup_cache (current_program_space);
+  dwarf2_fde_lookup_cache::entry result;
+
+  auto it = cache->entries.find (*pc);
+  if (it != cache->entries.end ()
+      && (it->second.fde == nullptr
+	  || it->second.objf->text_section_offset () == it->second.offset))
+    {
+      ++cache->hits;
+      result = it->second;
+    }
+  else
+    {
+      ++cache->misses;
+      result.objf = nullptr;
+      result.fde = dwarf2_frame_find_fde_1 (*pc, &result.objf);
+      result.offset = (result.fde != nullptr
+		       ? result.objf->text_section_offset () : 0);
+
+      if (cache->entries.size () >= dwarf2_fde_lookup_cache_max)
+	cache->entries.clear ();
+      cache->entries[*pc] = result;
+    }
+
+  if (result.fde == nullptr)
+    return NULL;
+
+  *pc = (CORE_ADDR) result.fde->initial_location + result.offset;
+  if (out_per_objfile != nullptr)
+    *out_per_objfile = get_dwarf2_per_objfile (result.objf);
+
+  return result.fde;
+}
+
+/* Implement "maint info dwarf-frame-cache".  */
+
+static void
+maintenance_info_dwarf_frame_cache (const char *args, int from_tty)
+{
+  dwarf2_fde_lookup_cache *cache
+    = get_fde_lookup_cache (current_program_space);
+
+  gdb_printf (_("Cached FDE lookups: %zu\n"), cache->entries.size ());
+  gdb_printf (_("Cache hits: %u\n"), cache->hits);
+  gdb_printf (_("Cache misses: %u\n"), cache->misses);
+}
+
 /* Add FDE to FDE_TABLE.  */
 static void
 add_fde (dwarf2_fde_table *fde_table, struct dwarf2_fde *fde)
@@ -2281,6 +2398,27 @@ architecture that doesn't support them will have no effect."),
 			   &set_dwarf_cmdlist,
 			   &show_dwarf_cmdlist);
 
+  add_cmd ("dwarf-frame-cache", class_maintenance,
+	   maintenance_info_dwarf_frame_cache,
+	   _("Show statistics about the DWARF FDE lookup cache of the "
+	     "current program space."),
+	   &maintenanceinfolist);
+
+  gdb::observers::new_objfile.attach (dwarf2_fde_lookup_cache_invalidate,
+				      "dwarf2-frame");
+  gdb::observers::free_objfile.attach (dwarf2_fde_lookup_cache_invalidate,
+				       "dwarf2-frame");
+  gdb::observers::objfile_relocated.attach
+    (dwarf2_fde_lookup_cache_invalidate, "dwarf2-frame");
+  gdb::observers::all_objfiles_removed.attach
+    ([] (program_space *pspace)
+      {
+	dwarf2_fde_lookup_cache *cache
+	  = dwarf2_fde_lookup_cache_data.get (pspace);
+	if (cache != nullptr)
+	  cache->entries.clear ();
+      }, "dwarf2-frame");
+
 #if GDB_SELF_TEST
   selftests::register_test_foreach_arch ("execute_cfa_program",
 					 selftests::execute_cfa_program_test);
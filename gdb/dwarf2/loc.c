@@ -43,7 +43,9 @@
 #include "compile/compile.h"
 #include <algorithm>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
+#include "gdbsupport/function-view.h"
 #include "gdbsupport/underlying.h"
 #include "gdbsupport/byte-vector.h"
 
@@ -353,18 +355,16 @@ decode_debug_loc_dwo_addresses (dwarf2_per_cu_data *per_cu,
     }
 }
 
-/* A function for dealing with location lists.  Given a
-   symbol baton (BATON) and a pc value (PC), find the appropriate
-   location expression, set *LOCEXPR_LENGTH, and return a pointer
-   to the beginning of the expression.  Returns NULL on failure.
+/* Call CALLBACK for each entry of the location list of BATON, in
+   order, with the range of unrelocated addresses LOW to HIGH where the
+   entry applies and its location expression, until CALLBACK returns
+   true.  Throw an error if the list is corrupted.  */
 
-   For now, only return the first matching location expression; there
-   can be more than one in the list.  */
-
-const gdb_byte *
-dwarf2_find_location_expression (const dwarf2_loclist_baton *baton,
-				 size_t *locexpr_length, const CORE_ADDR pc,
-				 bool at_entry)
+static void
+iterate_over_location_list
+  (const dwarf2_loclist_baton *baton,
+   gdb::function_view<bool (unrelocated_addr low, unrelocated_addr high,
+			    const gdb_byte *data, size_t length)> callback)
 {
   dwarf2_per_objfile *per_objfile = baton->per_objfile;
   struct objfile *objfile = per_objfile->objfile;
@@ -372,9 +372,6 @@ dwarf2_find_location_expression (const dwarf2_loclist_baton *baton,
   enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
   unsigned int addr_size = baton->per_cu->addr_size ();
   int signed_addr_p = bfd_get_sign_extend_vma (objfile->obfd.get ());
-  /* Adjustment for relocatable objects.  */
-  CORE_ADDR text_offset = baton->per_objfile->objfile->text_section_offset ();
-  unrelocated_addr unrel_pc = (unrelocated_addr) (pc - text_offset);
   unrelocated_addr base_address = baton->base_address;
   const gdb_byte *loc_ptr, *buf_end;
 
@@ -409,8 +406,7 @@ dwarf2_find_location_expression (const dwarf2_loclist_baton *baton,
       switch (kind)
 	{
 	case DEBUG_LOC_END_OF_LIST:
-	  *locexpr_length = 0;
-	  return NULL;
+	  return;
 
 	case DEBUG_LOC_BASE_ADDRESS:
 	  base_address = high;
@@ -457,32 +453,207 @@ dwarf2_find_location_expression (const dwarf2_loclist_baton *baton,
 	  loc_ptr += bytes_read;
 	}
 
-      if (low == high && unrel_pc == low && at_entry)
-	{
-	  /* This is entry PC record present only at entry point
-	     of a function.  Verify it is really the function entry point.  */
+      if (callback (low, high, loc_ptr, length))
+	return;
 
-	  const struct block *pc_block = block_for_pc (pc);
-	  struct symbol *pc_func = NULL;
+      loc_ptr += length;
+    }
+}
 
-	  if (pc_block)
-	    pc_func = pc_block->linkage_function ();
+/* Whether location lists are decoded once and cached, and simple
+   location expressions are evaluated without the general DWARF
+   expression evaluator.  This is the "maint set dwarf location-cache"
+   setting.  */
 
-	  if (pc_func && pc == pc_func->value_block ()->entry_pc ())
-	    {
-	      *locexpr_length = length;
-	      return loc_ptr;
-	    }
-	}
+static bool dwarf2_location_cache = true;
+
+static void
+show_dwarf_location_cache (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file,
+	      _("Whether DWARF location lists are cached is %s.\n"),
+	      value);
+}
 
-      if (unrel_pc >= low && unrel_pc < high)
+/* A function for dealing with location lists.  Given a
+   symbol baton (BATON) and a pc value (PC), find the appropriate
+   location expression, set *LOCEXPR_LENGTH, and return a pointer
+   to the beginning of the expression.  Returns NULL on failure.
+
+   For now, only return the first matching location expression; there
+   can be more than one in the list.  */
+
+const gdb_byte *
+dwarf2_find_location_expression (const dwarf2_loclist_baton *baton,
+				 size_t *locexpr_length, const CORE_ADDR pc,
+				 bool at_entry)
+{
+  /* Adjustment for relocatable objects.  */
+  CORE_ADDR text_offset = baton->per_objfile->objfile->text_section_offset ();
+  unrelocated_addr unrel_pc = (unrelocated_addr) (pc - text_offset);
+  const gdb_byte *result = NULL;
+
+  *locexpr_length = 0;
+  iterate_over_location_list
+    (baton, [&] (unrelocated_addr low, unrelocated_addr high,
+		 const gdb_byte *data, size_t length)
+     {
+       if (low == high && unrel_pc == low && at_entry)
+	 {
+	   /* This is entry PC record present only at entry point
+	      of a function.  Verify it is really the function entry point.  */
+
+	   const struct block *pc_block = block_for_pc (pc);
+	   struct symbol *pc_func = NULL;
+
+	   if (pc_block)
+	     pc_func = pc_block->linkage_function ();
+
+	   if (pc_func && pc == pc_func->value_block ()->entry_pc ())
+	     {
+	       *locexpr_length = length;
+	       result = data;
+	       return true;
+	     }
+	 }
+
+       if (unrel_pc >= low && unrel_pc < high)
+	 {
+	   *locexpr_length = length;
+	   result = data;
+	   return true;
+	 }
+
+       return false;
+     });
+
+  return result;
+}
+
+/* The location lists of the symbols of an objfile that were looked up,
+   decoded once so that printing a variable doesn't walk its whole
+   location list again.  */
+
+struct dwarf2_decoded_loclists
+{
+  struct entry
+  {
+    /* The range of unrelocated addresses where the entry applies.  */
+    unrelocated_addr low, high;
+
+    /* The location expression.  */
+    const gdb_byte *data;
+    size_t size;
+  };
+
+  struct loclist
+  {
+    /* The entries with a non-empty range, in the order of the list.  */
+    std::vector<entry> entries;
+
+    /* True if ENTRIES are sorted by address and don't overlap, so that
+       they can be searched with a binary search.  */
+    bool sorted = true;
+
+    /* True if the list is corrupted after the last entry in
+       ENTRIES.  */
+    bool truncated = false;
+  };
+
+  /* Map from the location baton of a symbol to its decoded list.  */
+  std::unordered_map<const dwarf2_loclist_baton *, loclist> lists;
+};
+
+static const registry<objfile>::key<dwarf2_decoded_loclists>
+  dwarf2_decoded_loclists_data;
+
+/* Like dwarf2_find_location_expression, but decode the location list
+   of BATON the first time, and look up PC in the decoded list after.
+   BATON must be the location baton of a symbol, which lives as long
+   as its objfile.  */
+
+static const gdb_byte *
+find_location_expression_cached (const dwarf2_loclist_baton *baton,
+				 size_t *locexpr_length, CORE_ADDR pc)
+{
+  if (!dwarf2_location_cache)
+    return dwarf2_find_location_expression (baton, locexpr_length, pc);
+
+  struct objfile *objfile = baton->per_objfile->objfile;
+  dwarf2_decoded_loclists *cache = dwarf2_decoded_loclists_data.get (objfile);
+  if (cache == nullptr)
+    cache = dwarf2_decoded_loclists_data.emplace (objfile);
+
+  auto [it, inserted] = cache->lists.try_emplace (baton);
+  dwarf2_decoded_loclists::loclist &list = it->second;
+  if (inserted)
+    {
+      try
+	{
+	  iterate_over_location_list
+	    (baton, [&] (unrelocated_addr low, unrelocated_addr high,
+			 const gdb_byte *data, size_t length)
+	     {
+	       /* An empty range only matters when looking for the
+		  value at the function entry.  */
+	       if (low >= high)
+		 return false;
+
+	       if (!list.entries.empty ()
+		   && low < list.entries.back ().high)
+		 list.sorted = false;
+	       list.entries.push_back ({ low, high, data, length });
+	       return false;
+	     });
+	}
+      catch (const gdb_exception_error &ex)
 	{
-	  *locexpr_length = length;
-	  return loc_ptr;
+	  list.truncated = true;
 	}
+      list.entries.shrink_to_fit ();
+    }
 
-      loc_ptr += length;
+  CORE_ADDR text_offset = objfile->text_section_offset ();
+  unrelocated_addr unrel_pc = (unrelocated_addr) (pc - text_offset);
+  const dwarf2_decoded_loclists::entry *found = nullptr;
+
+  if (list.sorted)
+    {
+      auto entry_it
+	= std::upper_bound (list.entries.begin (), list.entries.end (),
+			    unrel_pc,
+			    [] (unrelocated_addr addr,
+				const dwarf2_decoded_loclists::entry &e)
+			    {
+			      return addr < e.low;
+			    });
+      if (entry_it != list.entries.begin ()
+	  && unrel_pc < std::prev (entry_it)->high)
+	found = &*std::prev (entry_it);
+    }
+  else
+    {
+      for (const dwarf2_decoded_loclists::entry &e : list.entries)
+	if (unrel_pc >= e.low && unrel_pc < e.high)
+	  {
+	    found = &e;
+	    break;
+	  }
     }
+
+  if (found != nullptr)
+    {
+      *locexpr_length = found->size;
+      return found->data;
+    }
+
+  /* Let the uncached lookup report the corruption.  */
+  if (list.truncated)
+    return dwarf2_find_location_expression (baton, locexpr_length, pc);
+
+  *locexpr_length = 0;
+  return nullptr;
 }
 
 /* Implement find_frame_base_location method for LOC_BLOCK functions using
@@ -554,7 +725,7 @@ loclist_find_frame_base_location (struct symbol *framefunc, CORE_ADDR pc,
   struct dwarf2_loclist_baton *symbaton
     = (struct dwarf2_loclist_baton *) SYMBOL_LOCATION_BATON (framefunc);
 
-  *start = dwarf2_find_location_expression (symbaton, length, pc);
+  *start = find_location_expression_cached (symbaton, length, pc);
 }
 
 /* Implement the struct symbol_block_ops::get_frame_base method for
@@ -1484,6 +1655,136 @@ indirect_synthetic_pointer (sect_offset die, LONGEST byte_offset,
 						     per_objfile, type);
 }
 
+/* Truncate ADDR to an address of ADDR_SIZE bytes, as the DWARF
+   expression evaluator does when it pushes an address.  */
+
+static CORE_ADDR
+truncate_dwarf_address (CORE_ADDR addr, int addr_size)
+{
+  if (addr_size < sizeof (CORE_ADDR))
+    addr &= ((CORE_ADDR) 1 << (8 * addr_size)) - 1;
+  return addr;
+}
+
+/* Compute the frame base of FRAME for a DW_OP_fbreg without the
+   general DWARF expression evaluator, if the frame base expression is
+   DW_OP_call_frame_cfa or a single register operation.  Store it in
+   *BASE and return true on success.  Return false if the frame base
+   is anything else.  */
+
+static bool
+simple_frame_base (const frame_info_ptr &frame, int addr_size,
+		   CORE_ADDR *base)
+{
+  const block *bl = get_frame_block (frame, NULL);
+  if (bl == NULL)
+    return false;
+
+  symbol *framefunc = bl->linkage_function ();
+  if (framefunc == NULL)
+    return false;
+
+  const gdb_byte *start;
+  size_t length;
+  func_get_frame_base_dwarf_block (framefunc,
+				   get_frame_address_in_block (frame),
+				   &start, &length);
+
+  const gdb_byte *end = start + length;
+  CORE_ADDR offset;
+  int dwarf_reg;
+
+  if (length == 1 && start[0] == DW_OP_call_frame_cfa)
+    *base = dwarf2_frame_cfa (frame);
+  else if (start[0] != DW_OP_regval_type
+	   && start[0] != DW_OP_GNU_regval_type
+	   && (dwarf_reg = dwarf_block_to_dwarf_reg (start, end)) != -1)
+    *base = read_addr_from_reg (frame, dwarf_reg);
+  else if ((dwarf_reg = dwarf_block_to_breg_offset (start, end,
+						    &offset)) != -1)
+    *base = read_addr_from_reg (frame, dwarf_reg) + offset;
+  else
+    return false;
+
+  *base = truncate_dwarf_address (*base, addr_size);
+  return true;
+}
+
+/* Try to evaluate the location description DATA of length SIZE
+   without the general DWARF expression evaluator, for the common
+   cases of a single DW_OP_fbreg, DW_OP_breg* or DW_OP_addr operation,
+   where the variable is simply in memory.  The arguments are as for
+   dwarf2_evaluate_loc_desc_full.  Return the value, or NULL if the
+   location description is anything else.  */
+
+static struct value *
+evaluate_simple_loc_desc (struct type *type, const frame_info_ptr &frame,
+			  const gdb_byte *data, size_t size,
+			  dwarf2_per_cu_data *per_cu,
+			  dwarf2_per_objfile *per_objfile,
+			  struct type *subobj_type,
+			  LONGEST subobj_byte_offset)
+{
+  struct objfile *objfile = per_objfile->objfile;
+  struct gdbarch *arch = objfile->arch ();
+  const gdb_byte *end = data + size;
+  int addr_size = per_cu->addr_size ();
+  CORE_ADDR address, offset;
+  bool in_stack_memory = false;
+  int dwarf_reg;
+
+  /* Addresses need converting on these architectures, leave that to
+     the evaluator.  */
+  if (gdbarch_integer_to_address_p (arch))
+    return NULL;
+
+  if (data[0] == DW_OP_addr && size == 1 + addr_size)
+    {
+      address = extract_unsigned_integer (data + 1, addr_size,
+					  gdbarch_byte_order (arch));
+      address += objfile->text_section_offset ();
+    }
+  else if (frame == NULL)
+    return NULL;
+  else if (dwarf_block_to_fb_offset (data, end, &offset))
+    {
+      if (!simple_frame_base (frame, addr_size, &address))
+	return NULL;
+      address += offset;
+      in_stack_memory = true;
+    }
+  else if ((dwarf_reg = dwarf_block_to_breg_offset (data, end,
+						    &offset)) != -1)
+    address = read_addr_from_reg (frame, dwarf_reg) + offset;
+  else
+    return NULL;
+
+  address = truncate_dwarf_address (address, addr_size);
+
+  /* Convert the address like dwarf_expr_context::fetch_result.  */
+  check_typedef (type);
+  check_typedef (subobj_type);
+
+  struct type *ptr_type;
+  switch (subobj_type->code ())
+    {
+    case TYPE_CODE_FUNC:
+    case TYPE_CODE_METHOD:
+      ptr_type = builtin_type (arch)->builtin_func_ptr;
+      break;
+    default:
+      ptr_type = builtin_type (arch)->builtin_data_ptr;
+      break;
+    }
+  address = value_as_address (value_from_pointer (ptr_type, address));
+
+  value *retval = value_at_lazy (subobj_type, address + subobj_byte_offset,
+				 frame);
+  if (in_stack_memory)
+    retval->set_stack (true);
+  return retval;
+}
+
 /* Evaluate a location description, starting at DATA and with length
    SIZE, to find the current location of variable of TYPE in the
    context of FRAME.  If SUBOBJ_TYPE is non-NULL, return instead the
@@ -1517,8 +1818,14 @@ dwarf2_evaluate_loc_desc_full (struct type *type, const frame_info_ptr &frame,
 
   try
     {
-      retval = ctx.evaluate (data, size, as_lval, per_cu, frame, nullptr,
-			     type, subobj_type, subobj_byte_offset);
+      retval = nullptr;
+      if (as_lval && dwarf2_location_cache)
+	retval = evaluate_simple_loc_desc (type, frame, data, size, per_cu,
+					   per_objfile, subobj_type,
+					   subobj_byte_offset);
+      if (retval == nullptr)
+	retval = ctx.evaluate (data, size, as_lval, per_cu, frame, nullptr,
+			       type, subobj_type, subobj_byte_offset);
     }
   catch (const gdb_exception_error &ex)
     {
@@ -3889,7 +4196,7 @@ loclist_read_variable (struct symbol *symbol, const frame_info_ptr &frame)
   size_t size;
   CORE_ADDR pc = frame ? get_frame_address_in_block (frame) : 0;
 
-  data = dwarf2_find_location_expression (dlbaton, &size, pc);
+  data = find_location_expression_cached (dlbaton, &size, pc);
   val = dwarf2_evaluate_loc_desc (symbol->type (), frame, data, size,
 				  dlbaton->per_cu, dlbaton->per_objfile);
 
@@ -4141,4 +4448,18 @@ conversational style, when possible."),
 			   show_dwarf_always_disassemble,
 			   &set_dwarf_cmdlist,
 			   &show_dwarf_cmdlist);
+
+  add_setshow_boolean_cmd ("location-cache", class_obscure,
+			   &dwarf2_location_cache, _("\
+Set whether DWARF location lists are cached."), _("\
+Show whether DWARF location lists are cached."), _("\
+When enabled, the location list of a variable is decoded once and\n\
+cached, and simple location expressions, such as a frame base or\n\
+register offset, are evaluated without the general DWARF expression\n\
+evaluator.  This speeds up printing many variables, e.g. with\n\
+\"info locals\".  This is enabled by default."),
+			   NULL,
+			   show_dwarf_location_cache,
+			   &set_dwarf_cmdlist,
+			   &show_dwarf_cmdlist);
 }
@@ -500,6 +500,14 @@ gdb_bfd_init_data (struct bfd *abfd, struct stat *st)
 
 /* See gdb_bfd.h.  */
 
+bool
+gdb_bfd_sharing_p ()
+{
+  return bfd_sharing;
+}
+
+/* See gdb_bfd.h.  */
+
 gdb_bfd_ref_ptr
 gdb_bfd_open (const char *name, const char *target, int fd,
 	      bool warn_if_slow)
@@ -1246,6 +1254,12 @@ gdb_bfd_error_handler (const char *fmt, va_list ap)
   bfd_print_error (print_error_callback, &output, fmt, ap);
   std::string str = output.release ();
 
+#if CXX_STD_THREAD
+  /* BFDs may be opened from worker threads, see
+     prefetch_solib_bfds.  */
+  std::lock_guard<std::recursive_mutex> guard (gdb_bfd_mutex);
+#endif
+
   if (increment_bfd_error_count (str) > 1)
     return;
 
@@ -102,6 +102,11 @@ typedef gdb::ref_ptr<struct bfd, gdb_bfd_ref_policy> gdb_bfd_ref_ptr;
 gdb_bfd_ref_ptr gdb_bfd_open (const char *name, const char *target,
 			      int fd = -1, bool warn_if_slow = true);
 
+/* Return true if gdb_bfd_open shares BFDs between callers opening the
+   same file, see "maint set bfd-sharing".  */
+
+bool gdb_bfd_sharing_p ();
+
 /* Mark the CHILD BFD as being a member of PARENT.  Also, increment
    the reference count of CHILD.  Calling this function ensures that
    as along as CHILD remains alive, PARENT will as well.  Both CHILD
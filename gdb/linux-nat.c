@@ -707,6 +707,12 @@ lwp_lwpid_htab_add_lwp (struct lwp_info *lp)
 
 static intrusive_list<lwp_info> lwp_list;
 
+/* Incremented each time an LWP is resumed and each time a stop is
+   reported to the core.  Used to tell whether information cached in
+   lwp_info may be stale.  */
+
+static ULONGEST lwp_cache_generation = 1;
+
 /* See linux-nat.h.  */
 
 lwp_info_range
@@ -1622,6 +1628,7 @@ linux_resume_one_lwp_throw (struct lwp_info *lp, int step,
   lp->stopped = 0;
   lp->core = -1;
   lp->stop_reason = TARGET_STOPPED_BY_NO_REASON;
+  lwp_cache_generation++;
   registers_changed_ptid (linux_target, lp->ptid);
 }
 
@@ -3602,6 +3609,13 @@ linux_nat_target::wait (ptid_t ptid, struct target_waitstatus *ourstatus,
 
   event_ptid = linux_nat_wait_1 (ptid, ourstatus, target_options);
 
+  /* Don't trust names cached before this stop.  Some paths let an LWP
+     run with a plain PTRACE_CONT, e.g. to collect a pending SIGSTOP,
+     so a thread may have renamed itself with pthread_setname_np
+     without lwp_cache_generation being bumped.  */
+  if (ourstatus->kind () != TARGET_WAITKIND_IGNORE)
+    lwp_cache_generation++;
+
   /* If we requested any event, and something came out, assume there
      may be more.  If we requested a specific lwp or process, also
      assume there may be more.  */
@@ -3973,6 +3987,48 @@ linux_nat_target::update_thread_list ()
     }
 }
 
+/* Implement the "prefetch_thread_registers" target_ops method.  Read
+   the general purpose registers of every stopped LWP of the current
+   inferior in a single pass, so that the commands walking all threads
+   find them in the register caches instead of fetching them as they
+   switch to each thread in turn.  Reading the PC is enough, since the
+   architecture backends fetch it together with the rest of the general
+   purpose register set.  */
+
+void
+linux_nat_target::prefetch_thread_registers ()
+{
+  int count = 0;
+
+  for (thread_info *tp : current_inferior ()->non_exited_threads ())
+    {
+      lwp_info *lp = find_lwp_pid (tp->ptid);
+      if (lp == nullptr || !lp->stopped || tp->executing ())
+	continue;
+
+      regcache *regcache = get_thread_regcache (tp);
+      int pc_regnum = gdbarch_pc_regnum (regcache->arch ());
+      if (pc_regnum < 0)
+	return;
+
+      try
+	{
+	  regcache->raw_update (pc_regnum);
+	  count++;
+	}
+      catch (const gdb_exception_error &ex)
+	{
+	  /* The thread may have exited meanwhile.  Leave the error to
+	     the command that reads its registers.  */
+	  linux_nat_debug_printf ("failed to read the registers of %s: %s",
+				  lp->ptid.to_string ().c_str (),
+				  ex.what ());
+	}
+    }
+
+  linux_nat_debug_printf ("prefetched the registers of %d LWPs", count);
+}
+
 std::string
 linux_nat_target::pid_to_str (ptid_t ptid)
 {
@@ -3987,7 +4043,26 @@ linux_nat_target::pid_to_str (ptid_t ptid)
 const char *
 linux_nat_target::thread_name (struct thread_info *thr)
 {
-  return linux_proc_tid_get_name (thr->ptid);
+  lwp_info *lp = find_lwp_pid (thr->ptid);
+
+  /* Only a running thread can change the name of a thread of its
+     process.  In all-stop mode, all LWPs are stopped whenever this one
+     is, so reuse the name read from /proc during the same stop.
+     Commands like "info threads" and "thread apply all" ask for the
+     name of every thread, and reading thousands of /proc files each
+     time is noticeably expensive.  */
+  if (lp == nullptr || non_stop || !lp->stopped)
+    return linux_proc_tid_get_name (thr->ptid);
+
+  if (lp->name_generation != lwp_cache_generation)
+    {
+      const char *name = linux_proc_tid_get_name (thr->ptid);
+
+      lp->name.reset (name != nullptr ? xstrdup (name) : nullptr);
+      lp->name_generation = lwp_cache_generation;
+    }
+
+  return lp->name.get ();
 }
 
 /* Accepts an integer PID; Returns a string representing a file that
@@ -64,6 +64,8 @@ class linux_nat_target : public inf_ptrace_target
 
   void update_thread_list () override;
 
+  void prefetch_thread_registers () override;
+
   std::string pid_to_str (ptid_t) override;
 
   const char *thread_name (struct thread_info *) override;
@@ -286,6 +288,13 @@ struct lwp_info : intrusive_list_node<lwp_info>
   /* The processor core this LWP was last seen on.  */
   int core = -1;
 
+  /* The name of this LWP as last read from /proc, and the value of
+     lwp_cache_generation at the time it was read.  A generation of
+     zero means the name was never read.  See
+     linux_nat_target::thread_name.  */
+  gdb::unique_xmalloc_ptr<char> name;
+  ULONGEST name_generation = 0;
+
   /* Arch-specific additions.  */
   struct arch_lwp_info *arch_private = nullptr;
 };
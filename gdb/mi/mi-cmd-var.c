@@ -315,6 +315,32 @@ mi_cmd_var_info_num_children (const char *command, const char *const *argv,
   uiout->field_signed ("numchild", varobj_get_num_children (var));
 }
 
+void
+mi_cmd_var_info_update_statistics (const char *command,
+				   const char *const *argv, int argc)
+{
+  struct ui_out *uiout = current_uiout;
+  bool reset = false;
+
+  if (argc == 1 && strcmp (argv[0], "--reset") == 0)
+    reset = true;
+  else if (argc != 0)
+    error (_("-var-info-update-statistics: Usage: [--reset]."));
+
+  const varobj_update_statistics &stats = varobj_get_update_statistics ();
+  std::chrono::duration<double> time = stats.time;
+
+  uiout->field_unsigned ("updates", stats.updates);
+  uiout->field_unsigned ("varobjs-updated", stats.varobjs_updated);
+  uiout->field_unsigned ("roots-unchanged", stats.roots_unchanged);
+  uiout->field_unsigned ("varobjs-skipped", stats.varobjs_skipped);
+  uiout->field_unsigned ("bytes-read", stats.bytes_read);
+  uiout->field_fmt ("time", "%.6f", time.count ());
+
+  if (reset)
+    varobj_reset_update_statistics ();
+}
+
 /* Return 1 if given the argument PRINT_VALUES we should display
    the varobj VAR.  */
 
@@ -347,6 +347,8 @@ add_builtin_mi_commands ()
   add_mi_cmd_mi ("var-info-expression", mi_cmd_var_info_expression);
   add_mi_cmd_mi ("var-info-num-children", mi_cmd_var_info_num_children);
   add_mi_cmd_mi ("var-info-type", mi_cmd_var_info_type);
+  add_mi_cmd_mi ("var-info-update-statistics",
+		 mi_cmd_var_info_update_statistics);
   add_mi_cmd_mi ("var-list-children", mi_cmd_var_list_children);
   add_mi_cmd_mi ("var-set-format", mi_cmd_var_set_format);
   add_mi_cmd_mi ("var-set-frozen", mi_cmd_var_set_frozen);
@@ -659,6 +659,8 @@ objfile_relocate1 (struct objfile *objfile,
 				s->addr ());
     }
 
+  gdb::observers::objfile_relocated.notify (objfile);
+
   /* Data changed.  */
   return 1;
 }
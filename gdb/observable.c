@@ -43,6 +43,7 @@ DEFINE_OBSERVABLE (solib_unloaded);
 DEFINE_OBSERVABLE (new_objfile);
 DEFINE_OBSERVABLE (all_objfiles_removed);
 DEFINE_OBSERVABLE (free_objfile);
+DEFINE_OBSERVABLE (objfile_relocated);
 DEFINE_OBSERVABLE (new_thread);
 DEFINE_OBSERVABLE (thread_exit);
 DEFINE_OBSERVABLE (thread_deleted);
@@ -115,6 +115,10 @@ extern observable<program_space */* pspace */> all_objfiles_removed;
 /* The object file specified by OBJFILE is about to be freed.  */
 extern observable<struct objfile */* objfile */> free_objfile;
 
+/* The sections of the object file specified by OBJFILE have been
+   relocated to new addresses.  */
+extern observable<struct objfile */* objfile */> objfile_relocated;
+
 /* The thread specified by T has been created.  */
 extern observable<struct thread_info */* t */> new_thread;
 
@@ -77,6 +77,7 @@
 #include <algorithm>
 #include <iterator>
 #include <unordered_map>
+#include <unordered_set>
 #include "async-event.h"
 #include "gdbsupport/selftest.h"
 #include "cli/cli-style.h"
@@ -291,6 +292,9 @@ enum {
   /* Support for target-side breakpoint commands.  */
   PACKET_BreakpointCommands,
 
+  /* Support for installing conditional breakpoints as jump pads.  */
+  PACKET_FastConditionalBreakpoints,
+
   /* Support for fast tracepoints.  */
   PACKET_FastTracepoints,
 
@@ -395,6 +399,25 @@ enum {
      errors, and so they should not need to check for this feature.  */
   PACKET_accept_error_message,
 
+  /* Support for the 'x' binary memory read packet.  */
+  PACKET_x,
+
+  /* Support for the vReadMemory packet.  */
+  PACKET_vReadMemory,
+
+  /* Support for several vFile:pread requests in flight at once.  */
+  PACKET_vFile_pread_window,
+
+  /* Support for reading the changes to the thread list with
+     qXfer:threads:read.  */
+  PACKET_ThreadListDelta,
+
+  /* Support for the vReadRegisters packet.  */
+  PACKET_vReadRegisters,
+
+  /* Support for the QCompress packet.  */
+  PACKET_QCompress,
+
   PACKET_MAX
 };
 
@@ -574,6 +597,23 @@ class remote_state
      reliable.  */
   bool noack_mode = false;
 
+  /* The number of vFile:pread requests the stub accepts before GDB
+     reads the replies, as reported by the "vFile:pread-window"
+     feature.  */
+  int pread_window = 1;
+
+  /* The generation of the last thread list read with
+     qXfer:threads:read, if the stub reported one.  With the
+     "ThreadListDelta" feature, GDB then only asks for the threads
+     added and removed since.  */
+  std::optional<ULONGEST> thread_list_generation;
+
+  /* The thread whose registers GDB last read with a 'g' packet since
+     the target was last resumed, or null_ptid.  Once GDB needs the
+     registers of a second thread, it reads those of several threads
+     at once with the vReadRegisters packet.  */
+  ptid_t g_packet_ptid = null_ptid;
+
   /* True if we're connected in extended remote mode.  */
   bool extended = false;
 
@@ -948,6 +988,9 @@ class remote_target : public process_stratum_target
 
   ULONGEST get_memory_xfer_limit () override;
 
+  bool read_memory_ranges (gdb::array_view<memory_read_range> ranges)
+    override;
+
   void rcmd (const char *command, struct ui_file *output) override;
 
   const char *pid_to_exec_file (int pid) override;
@@ -1164,10 +1207,16 @@ class remote_target : public process_stratum_target
 			    ULONGEST offset, fileio_error *remote_errno);
   int remote_hostio_pread_vFile (int fd, gdb_byte *read_buf, int len,
 				 ULONGEST offset, fileio_error *remote_errno);
+  int remote_hostio_pread_window (int fd, gdb::byte_vector &buf,
+				  ULONGEST offset, int count,
+				  fileio_error *remote_errno);
 
   int remote_hostio_send_command (int command_bytes, int which_packet,
 				  fileio_error *remote_errno, const char **attachment,
 				  int *attachment_len);
+  int remote_hostio_parse_reply (int bytes_read, int which_packet,
+				 fileio_error *remote_errno,
+				 const char **attachment, int *attachment_len);
   int remote_hostio_set_filesystem (struct inferior *inf,
 				    fileio_error *remote_errno);
   /* We should get rid of this and use fileio_open directly.  */
@@ -1242,6 +1291,7 @@ class remote_target : public process_stratum_target
   void remote_interrupt_ns ();
 
   char *remote_get_noisy_reply ();
+  void remote_relocate_instruction (char *buf);
   int remote_query_attached (int pid);
   inferior *remote_add_inferior (bool fake_pid_p, int pid, int attached,
 				 int try_open_exec);
@@ -1293,6 +1343,8 @@ class remote_target : public process_stratum_target
   void remote_supported_thread_options (const protocol_feature *feature,
 					enum packet_support support,
 					const char *value);
+  void remote_pread_window (const protocol_feature *feature,
+			    enum packet_support support, const char *value);
 
   void remote_serial_quit_handler ();
 
@@ -1311,7 +1363,8 @@ class remote_target : public process_stratum_target
   int fetch_register_using_p (struct regcache *regcache,
 			      packet_reg *reg);
   int send_g_packet ();
-  void process_g_packet (struct regcache *regcache);
+  void process_g_packet (struct regcache *regcache, const char *buf);
+  bool fetch_registers_in_bulk (struct regcache *regcache);
   void fetch_registers_using_g (struct regcache *regcache);
   int store_register_using_P (const struct regcache *regcache,
 			      packet_reg *reg);
@@ -1700,6 +1753,64 @@ trace_error (char *buf)
     }
 }
 
+/* Handle the qRelocInsn request in BUF, sent by the stub while it
+   installs a fast tracepoint or a jump pad breakpoint.  */
+
+void
+remote_target::remote_relocate_instruction (char *buf)
+{
+  struct remote_state *rs = get_remote_state ();
+  ULONGEST ul;
+  CORE_ADDR from, to, org_to;
+  const char *p, *pp;
+  int adjusted_size = 0;
+  int relocated = 0;
+
+  p = buf + strlen ("qRelocInsn:");
+  pp = unpack_varlen_hex (p, &ul);
+  if (*pp != ';')
+    error (_("invalid qRelocInsn packet: %s"), buf);
+  from = ul;
+
+  p = pp + 1;
+  unpack_varlen_hex (p, &ul);
+  to = ul;
+
+  org_to = to;
+
+  try
+    {
+      gdbarch_relocate_instruction (current_inferior ()->arch (), &to, from);
+      relocated = 1;
+    }
+  catch (const gdb_exception &ex)
+    {
+      if (ex.error == MEMORY_ERROR)
+	{
+	  /* Propagate memory errors silently back to the target.  The
+	     stub may have limited the range of addresses we can write
+	     to, for example.  */
+	}
+      else
+	{
+	  /* Something unexpectedly bad happened.  Be verbose so we can
+	     tell what, and propagate the error back to the stub, so it
+	     doesn't get stuck waiting for a response.  */
+	  exception_fprintf (gdb_stderr, ex,
+			     _("warning: relocating instruction: "));
+	}
+      putpkt ("E01");
+    }
+
+  if (relocated)
+    {
+      adjusted_size = to - org_to;
+
+      xsnprintf (buf, rs->buf.size (), "qRelocInsn:%x", adjusted_size);
+      putpkt (buf);
+    }
+}
+
 /* Utility: wait for reply from stub, while accepting "O" packets.  */
 
 char *
@@ -1717,59 +1828,7 @@ remote_target::remote_get_noisy_reply ()
       if (buf[0] == 'E')
 	trace_error (buf);
       else if (startswith (buf, "qRelocInsn:"))
-	{
-	  ULONGEST ul;
-	  CORE_ADDR from, to, org_to;
-	  const char *p, *pp;
-	  int adjusted_size = 0;
-	  int relocated = 0;
-
-	  p = buf + strlen ("qRelocInsn:");
-	  pp = unpack_varlen_hex (p, &ul);
-	  if (*pp != ';')
-	    error (_("invalid qRelocInsn packet: %s"), buf);
-	  from = ul;
-
-	  p = pp + 1;
-	  unpack_varlen_hex (p, &ul);
-	  to = ul;
-
-	  org_to = to;
-
-	  try
-	    {
-	      gdbarch_relocate_instruction (current_inferior ()->arch (),
-					    &to, from);
-	      relocated = 1;
-	    }
-	  catch (const gdb_exception &ex)
-	    {
-	      if (ex.error == MEMORY_ERROR)
-		{
-		  /* Propagate memory errors silently back to the
-		     target.  The stub may have limited the range of
-		     addresses we can write to, for example.  */
-		}
-	      else
-		{
-		  /* Something unexpectedly bad happened.  Be verbose
-		     so we can tell what, and propagate the error back
-		     to the stub, so it doesn't get stuck waiting for
-		     a response.  */
-		  exception_fprintf (gdb_stderr, ex,
-				     _("warning: relocating instruction: "));
-		}
-	      putpkt ("E01");
-	    }
-
-	  if (relocated)
-	    {
-	      adjusted_size = to - org_to;
-
-	      xsnprintf (buf, rs->buf.size (), "qRelocInsn:%x", adjusted_size);
-	      putpkt (buf);
-	    }
-	}
+	remote_relocate_instruction (buf);
       else if (buf[0] == 'O' && buf[1] != 'K')
 	{
 	  /* 'O' message from stub */
@@ -2069,6 +2128,39 @@ show_interrupt_sequence (struct ui_file *file, int from_tty,
    expects BREAK g which is Magic SysRq g for connecting gdb.  */
 static bool interrupt_on_connect = false;
 
+/* This boolean variable specifies whether GDB asks the remote target
+   to compress the data it sends, if it supports it.  This is the
+   "set/show remote compression" setting.  */
+static bool remote_compression = false;
+
+/* This boolean variable specifies whether GDB lets the remote target
+   install conditional breakpoints as jumps to jump pads that evaluate
+   the condition in the inferior.  This is the "set/show remote
+   fast-conditional-breakpoints" setting.  */
+static bool remote_fast_conditional_breakpoints = false;
+
+static void
+show_remote_fast_conditional_breakpoints (struct ui_file *file,
+					  int from_tty,
+					  struct cmd_list_element *c,
+					  const char *value)
+{
+  gdb_printf (file,
+	      _("Evaluation of breakpoint conditions in jump pads "
+		"is %s.\n"),
+	      value);
+}
+
+static void
+show_remote_compression (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file,
+	      _("Compression of the data sent by the remote target "
+		"is %s.\n"),
+	      value);
+}
+
 /* This variable is used to implement the "set/show remotebreak" commands.
    Since these commands are now deprecated in favor of "set/show remote
    interrupt-sequence", it no longer has any effect on the code.  */
@@ -4056,8 +4148,20 @@ struct threads_listing_context
       this->items.erase (it);
   }
 
-  /* The threads found on the remote target.  */
+  /* The threads found on the remote target.  If DELTA is true, only
+     the threads added or changed since the previous listing.  */
   std::vector<thread_item> items;
+
+  /* The generation of this thread list, if the target reported one.  */
+  std::optional<ULONGEST> generation;
+
+  /* True if this is not the whole thread list, but only the changes
+     since the previous listing.  */
+  bool delta = false;
+
+  /* If DELTA is true, the threads removed since the previous
+     listing.  */
+  std::unordered_set<ptid_t> removed;
 };
 
 static int
@@ -4112,6 +4216,37 @@ remote_target::remote_get_threads_with_ql (threads_listing_context *context)
 
 #if defined(HAVE_LIBEXPAT)
 
+static void
+start_threads (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data,
+	       std::vector<gdb_xml_value> &attributes)
+{
+  struct threads_listing_context *data
+    = (struct threads_listing_context *) user_data;
+  struct gdb_xml_value *attr;
+
+  attr = xml_find_attribute (attributes, "generation");
+  if (attr != NULL)
+    data->generation = *(ULONGEST *) attr->value.get ();
+
+  attr = xml_find_attribute (attributes, "since");
+  data->delta = attr != NULL;
+}
+
+static void
+start_removed_thread (struct gdb_xml_parser *parser,
+		      const struct gdb_xml_element *element,
+		      void *user_data,
+		      std::vector<gdb_xml_value> &attributes)
+{
+  struct threads_listing_context *data
+    = (struct threads_listing_context *) user_data;
+
+  char *id = (char *) xml_find_attribute (attributes, "id")->value.get ();
+  data->removed.insert (read_ptid (id, NULL));
+}
+
 static void
 start_thread (struct gdb_xml_parser *parser,
 	      const struct gdb_xml_element *element,
@@ -4164,16 +4299,30 @@ const struct gdb_xml_element thread_children[] = {
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute removed_thread_attributes[] = {
+  { "id", GDB_XML_AF_NONE, NULL, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_children[] = {
   { "thread", thread_attributes, thread_children,
     GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
     start_thread, end_thread },
+  { "removed", removed_thread_attributes, NULL,
+    GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
+    start_removed_thread, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute threads_attributes[] = {
+  { "generation", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "since", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_elements[] = {
-  { "threads", NULL, threads_children,
-    GDB_XML_EF_NONE, NULL, NULL },
+  { "threads", threads_attributes, threads_children,
+    GDB_XML_EF_NONE, start_threads, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
@@ -4187,13 +4336,29 @@ remote_target::remote_get_threads_with_qxfer (threads_listing_context *context)
 #if defined(HAVE_LIBEXPAT)
   if (m_features.packet_support (PACKET_qXfer_threads) == PACKET_ENABLE)
     {
+      struct remote_state *rs = get_remote_state ();
+      const char *annex = NULL;
+
+      /* If we already have the thread list of some generation, only
+	 ask for what changed since.  */
+      if (m_features.packet_support (PACKET_ThreadListDelta) == PACKET_ENABLE
+	  && rs->thread_list_generation.has_value ())
+	annex = phex_nz (*rs->thread_list_generation, 0);
+
+      /* Forget the generation until we have parsed the new list, so
+	 that an error here results in reading the whole list next
+	 time.  */
+      rs->thread_list_generation.reset ();
+
       std::optional<gdb::char_vector> xml
-	= target_read_stralloc (this, TARGET_OBJECT_THREADS, NULL);
+	= target_read_stralloc (this, TARGET_OBJECT_THREADS, annex);
 
       if (xml && (*xml)[0] != '\0')
 	{
-	  gdb_xml_parse_quick (_("threads"), "threads.dtd",
-			       threads_elements, xml->data (), context);
+	  if (gdb_xml_parse_quick (_("threads"), "threads.dtd",
+				   threads_elements, xml->data (),
+				   context) == 0)
+	    rs->thread_list_generation = context->generation;
 	}
 
       return 1;
@@ -4273,7 +4438,8 @@ remote_target::update_thread_list ()
     {
       got_list = 1;
 
-      if (context.items.empty ()
+      if (!context.delta
+	  && context.items.empty ()
 	  && remote_thread_always_alive (inferior_ptid))
 	{
 	  /* Some targets don't really support threads, but still
@@ -4285,14 +4451,20 @@ remote_target::update_thread_list ()
 	}
 
       /* CONTEXT now holds the current thread list on the remote
-	 target end.  Delete GDB-side threads no longer found on the
-	 target.  */
+	 target end, or the changes to it since the last listing.
+	 Delete GDB-side threads no longer found on the target.  */
       for (thread_info *tp : all_threads_safe ())
 	{
 	  if (tp->inf->process_target () != this)
 	    continue;
 
-	  if (!context.contains_thread (tp->ptid))
+	  bool gone;
+	  if (context.delta)
+	    gone = context.removed.count (tp->ptid) != 0;
+	  else
+	    gone = !context.contains_thread (tp->ptid);
+
+	  if (gone)
 	    {
 	      /* Do not remove the thread if it is the last thread in
 		 the inferior.  This situation happens when we have a
@@ -5165,6 +5337,20 @@ remote_target::start_remote_1 (int from_tty, int extended_p)
 	rs->noack_mode = 1;
     }
 
+  /* Ask the stub to compress what it sends from now on.  Only the
+     stub's output is compressed, so that GDB can still interrupt the
+     target by sending a plain ^C.  */
+  if (remote_compression
+      && m_features.packet_support (PACKET_QCompress) != PACKET_DISABLE
+      && serial_can_decompress_input (rs->remote_desc))
+    {
+      putpkt ("QCompress:zlib");
+      getpkt (&rs->buf);
+      if ((m_features.packet_ok (rs->buf, PACKET_QCompress)).status ()
+	  == PACKET_OK)
+	serial_decompress_input (rs->remote_desc);
+    }
+
   if (extended_p)
     {
       /* Tell the remote that we are using the extended protocol.  */
@@ -5713,6 +5899,46 @@ remote_supported_thread_options (remote_target *remote,
   remote->remote_supported_thread_options (feature, support, value);
 }
 
+void
+remote_target::remote_pread_window (const protocol_feature *feature,
+				    enum packet_support support,
+				    const char *value)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  m_features.m_protocol_packets[feature->packet].support = support;
+
+  if (support != PACKET_ENABLE)
+    return;
+
+  if (value == nullptr || *value == '\0')
+    {
+      warning (_("Remote target reported \"%s\" without a size."),
+	       feature->name);
+      return;
+    }
+
+  ULONGEST window = 0;
+  const char *p = unpack_varlen_hex (value, &window);
+
+  if (*p != '\0' || window == 0)
+    {
+      warning (_("Remote target reported \"%s\" with a bad size: \"%s\"."),
+	       feature->name, value);
+      return;
+    }
+
+  /* Don't keep an unbounded amount of data in flight.  */
+  rs->pread_window = std::min (window, (ULONGEST) 64);
+}
+
+static void
+remote_pread_window (remote_target *remote, const protocol_feature *feature,
+		     enum packet_support support, const char *value)
+{
+  remote->remote_pread_window (feature, support, value);
+}
+
 static const struct protocol_feature remote_protocol_features[] = {
   { "PacketSize", PACKET_DISABLE, remote_packet_size, -1 },
   { "qXfer:auxv:read", PACKET_DISABLE, remote_supported_packet,
@@ -5766,6 +5992,8 @@ static const struct protocol_feature remote_protocol_features[] = {
     PACKET_ConditionalBreakpoints },
   { "BreakpointCommands", PACKET_DISABLE, remote_supported_packet,
     PACKET_BreakpointCommands },
+  { "FastConditionalBreakpoints", PACKET_DISABLE, remote_supported_packet,
+    PACKET_FastConditionalBreakpoints },
   { "FastTracepoints", PACKET_DISABLE, remote_supported_packet,
     PACKET_FastTracepoints },
   { "StaticTracepoints", PACKET_DISABLE, remote_supported_packet,
@@ -5824,6 +6052,17 @@ static const struct protocol_feature remote_protocol_features[] = {
     PACKET_memory_tagging_feature },
   { "error-message", PACKET_ENABLE, remote_supported_packet,
     PACKET_accept_error_message },
+  { "binary-upload", PACKET_DISABLE, remote_supported_packet, PACKET_x },
+  { "vReadMemory", PACKET_DISABLE, remote_supported_packet,
+    PACKET_vReadMemory },
+  { "vReadRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_vReadRegisters },
+  { "QCompress", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QCompress },
+  { "vFile:pread-window", PACKET_DISABLE, remote_pread_window,
+    PACKET_vFile_pread_window },
+  { "ThreadListDelta", PACKET_DISABLE, remote_supported_packet,
+    PACKET_ThreadListDelta },
 };
 
 static char *remote_support_xml;
@@ -6235,6 +6474,8 @@ remote_target::open_1 (const char *name, int from_tty, int extended_p)
   remote->m_features.reset_all_packet_configs_support ();
   rs->explicit_packet_size = 0;
   rs->noack_mode = 0;
+  rs->pread_window = 1;
+  rs->thread_list_generation.reset ();
   rs->extended = extended_p;
   rs->waiting_for_stop_reply = 0;
   rs->ctrlc_pending_p = 0;
@@ -7004,6 +7245,8 @@ remote_target::resume (ptid_t scope_ptid, int step, enum gdb_signal siggnal)
 {
   struct remote_state *rs = get_remote_state ();
 
+  rs->g_packet_ptid = null_ptid;
+
   /* When connected in non-stop mode, the core resumes threads
      individually.  Resuming remote threads directly in target_resume
      would thus result in sending one packet per thread.  Instead, to
@@ -8927,23 +9170,22 @@ remote_target::send_g_packet ()
 }
 
 void
-remote_target::process_g_packet (struct regcache *regcache)
+remote_target::process_g_packet (struct regcache *regcache, const char *buf)
 {
   struct gdbarch *gdbarch = regcache->arch ();
   struct remote_state *rs = get_remote_state ();
   remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
   int i, buf_len;
-  char *p;
+  const char *p;
   char *regs;
 
-  buf_len = strlen (rs->buf.data ());
+  buf_len = strlen (buf);
 
   /* Further sanity checks, with knowledge of the architecture.  */
   if (buf_len > 2 * rsa->sizeof_g_packet)
     error (_("Remote 'g' packet reply is too long (expected %ld bytes, got %d "
 	     "bytes): %s"),
-	   rsa->sizeof_g_packet, buf_len / 2,
-	   rs->buf.data ());
+	   rsa->sizeof_g_packet, buf_len / 2, buf);
 
   /* Save the size of the packet sent to us by the target.  It is used
      as a heuristic when determining the max size of packets that the
@@ -8993,7 +9235,7 @@ remote_target::process_g_packet (struct regcache *regcache)
      hex characters.  Suck them all up, then supply them to the
      register cacheing/storage mechanism.  */
 
-  p = rs->buf.data ();
+  p = buf;
   for (i = 0; i < rsa->sizeof_g_packet; i++)
     {
       if (p[0] == 0 || p[1] == 0)
@@ -9014,12 +9256,12 @@ remote_target::process_g_packet (struct regcache *regcache)
 
       if (r->in_g_packet)
 	{
-	  if ((r->offset + reg_size) * 2 > strlen (rs->buf.data ()))
+	  if ((r->offset + reg_size) * 2 > buf_len)
 	    /* This shouldn't happen - we adjusted in_g_packet above.  */
 	    internal_error (_("unexpected end of 'g' packet reply"));
-	  else if (rs->buf[r->offset * 2] == 'x')
+	  else if (buf[r->offset * 2] == 'x')
 	    {
-	      gdb_assert (r->offset * 2 < strlen (rs->buf.data ()));
+	      gdb_assert (r->offset * 2 < buf_len);
 	      /* The register isn't available, mark it as such (at
 		 the same time setting the value to zero).  */
 	      regcache->raw_supply (r->regnum, NULL);
@@ -9030,11 +9272,129 @@ remote_target::process_g_packet (struct regcache *regcache)
     }
 }
 
+/* Read the registers of REGCACHE's thread, and of other stopped
+   threads of the same inferior whose registers GDB doesn't have yet,
+   with one vReadRegisters packet.  Return false if GDB should use the
+   'g' packet instead.  */
+
+bool
+remote_target::fetch_registers_in_bulk (struct regcache *regcache)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct gdbarch *gdbarch = regcache->arch ();
+  remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
+
+  if (m_features.packet_support (PACKET_vReadRegisters) != PACKET_ENABLE
+      || get_traceframe_number () != -1)
+    return false;
+
+  /* Most stops only need the registers of the thread that stopped.
+     Only read other threads' registers too once GDB needs those of
+     a second thread, e.g. for "info threads" or "thread apply all".  */
+  if (rs->g_packet_ptid == null_ptid || rs->g_packet_ptid == regcache->ptid ())
+    {
+      rs->g_packet_ptid = regcache->ptid ();
+      return false;
+    }
+
+  thread_info *thr = this->find_thread (regcache->ptid ());
+  if (thr == nullptr)
+    return false;
+
+  /* A register of the 'g' packet, to tell whether GDB already has a
+     thread's registers.  */
+  int probe_regnum = -1;
+  for (int i = 0; i < gdbarch_num_regs (gdbarch); i++)
+    if (rsa->regs[i].in_g_packet)
+      {
+	probe_regnum = i;
+	break;
+      }
+  if (probe_regnum == -1)
+    return false;
+
+  /* Each thread's registers take up 2 * sizeof_g_packet characters
+     and a separator in the reply, and its thread-id and separator at
+     most MAX_PTID_SIZE characters in the request.  */
+  const int max_ptid_size = 40;
+  int max_threads
+    = std::min ((get_remote_packet_size () - 1) / (2 * rsa->sizeof_g_packet + 1),
+		(get_remote_packet_size () - 20) / max_ptid_size);
+  if (max_threads < 2)
+    return false;
+
+  std::vector<struct regcache *> regcaches;
+  regcaches.push_back (regcache);
+  for (thread_info *tp : thr->inf->non_exited_threads ())
+    {
+      if ((int) regcaches.size () >= max_threads)
+	break;
+      if (tp == thr || tp->executing ())
+	continue;
+
+      struct regcache *other = get_thread_regcache (tp);
+      if (other->arch () == gdbarch
+	  && other->get_register_status (probe_regnum) == REG_UNKNOWN)
+	regcaches.push_back (other);
+    }
+  if (regcaches.size () < 2)
+    return false;
+
+  char *p = rs->buf.data ();
+  char *endp = p + get_remote_packet_size ();
+  strcpy (p, "vReadRegisters:");
+  p += strlen (p);
+  for (struct regcache *rc : regcaches)
+    {
+      if (rc != regcache)
+	*p++ = ';';
+      p = write_ptid (p, endp, rc->ptid ());
+    }
+  *p = '\0';
+
+  putpkt (rs->buf);
+  getpkt (&rs->buf);
+  if (m_features.packet_ok (rs->buf, PACKET_vReadRegisters).status ()
+      != PACKET_OK)
+    return false;
+
+  /* The reply has the registers of each thread in 'g' format, in the
+     same order, separated by ';'.  A thread's registers may be empty
+     if the stub couldn't read them, and the reply may stop early if
+     they didn't all fit.  */
+  char *reply = rs->buf.data ();
+  bool got_regcache = false;
+  for (struct regcache *rc : regcaches)
+    {
+      char *sep = strchr (reply, ';');
+      if (sep != nullptr)
+	*sep = '\0';
+
+      if (*reply != '\0')
+	{
+	  if (strlen (reply) % 2 != 0)
+	    error (_("Invalid reply to vReadRegisters packet: %s"), reply);
+	  process_g_packet (rc, reply);
+	  if (rc == regcache)
+	    got_regcache = true;
+	}
+
+      if (sep == nullptr)
+	break;
+      reply = sep + 1;
+    }
+
+  return got_regcache;
+}
+
 void
 remote_target::fetch_registers_using_g (struct regcache *regcache)
 {
+  if (fetch_registers_in_bulk (regcache))
+    return;
+
   send_g_packet ();
-  process_g_packet (regcache);
+  process_g_packet (regcache, get_remote_state ()->buf.data ());
 }
 
 /* Make the remote selected traceframe match GDB's selected
@@ -9648,27 +10008,49 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   /* The packet buffer will be large enough for the payload;
      get_memory_packet_size ensures this.  */
 
+  /* If the stub can reply in binary, each unit takes at least
+     UNIT_SIZE bytes of the reply, after the leading 'b'.  */
+  bool binary = m_features.packet_support (PACKET_x) == PACKET_ENABLE;
+
   /* Number of units that will fit.  */
-  todo_units = std::min (len_units,
-			 (ULONGEST) (buf_size_bytes / unit_size) / 2);
+  if (binary)
+    todo_units = std::min (len_units,
+			   (ULONGEST) ((buf_size_bytes - 1) / unit_size));
+  else
+    todo_units = std::min (len_units,
+			   (ULONGEST) (buf_size_bytes / unit_size) / 2);
 
-  /* Construct "m"<memaddr>","<len>".  */
+  /* Construct "m"<memaddr>","<len>" or "x"<memaddr>","<len>".  */
   memaddr = remote_address_masked (memaddr);
   p = rs->buf.data ();
-  *p++ = 'm';
+  *p++ = binary ? 'x' : 'm';
   p += hexnumstr (p, (ULONGEST) memaddr);
   *p++ = ',';
   p += hexnumstr (p, (ULONGEST) todo_units);
   *p = '\0';
   putpkt (rs->buf);
-  getpkt (&rs->buf);
+  int packet_len = getpkt (&rs->buf);
   packet_result result = packet_check_result (rs->buf);
   if (result.status () == PACKET_ERROR)
     return TARGET_XFER_E_IO;
-  /* Reply describes memory byte by byte, each byte encoded as two hex
-     characters.  */
   p = rs->buf.data ();
-  decoded_bytes = hex2bin (p, myaddr, todo_units * unit_size);
+  if (binary)
+    {
+      /* Reply is a 'b' followed by the escaped memory contents.  The
+	 stub may send fewer bytes than requested if escaping made the
+	 data too large for its packet buffer.  */
+      if (packet_len < 1 || *p != 'b')
+	error (_("Invalid reply to 'x' packet: %s"), p);
+      decoded_bytes = remote_unescape_input ((const gdb_byte *) p + 1,
+					     packet_len - 1, myaddr,
+					     todo_units * unit_size);
+    }
+  else
+    {
+      /* Reply describes memory byte by byte, each byte encoded as two
+	 hex characters.  */
+      decoded_bytes = hex2bin (p, myaddr, todo_units * unit_size);
+    }
   /* Return what we have.  Let higher layers handle partial reads.  */
   *xfered_len_units = (ULONGEST) (decoded_bytes / unit_size);
   return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
@@ -11023,6 +11405,23 @@ remote_target::insert_breakpoint (struct gdbarch *gdbarch,
       if (!gdbarch_has_global_breakpoints (current_inferior ()->arch ()))
 	set_general_process ();
 
+      addr = (ULONGEST) remote_address_masked (addr);
+
+      /* If the user allows it, tell a stub that can evaluate the
+	 conditions in the inferior how many bytes it would need to
+	 displace to install the breakpoint as a jump to a jump pad, as
+	 for fast tracepoints.  This may read memory, and even send
+	 packets, so do it before building the Z0 packet in RS->BUF.  */
+      int insn_len = 0;
+      if (remote_fast_conditional_breakpoints
+	  && (m_features.packet_support (PACKET_FastConditionalBreakpoints)
+	      == PACKET_ENABLE)
+	  && supports_evaluation_of_breakpoint_conditions ()
+	  && !bp_tgt->conditions.empty ()
+	  && bp_tgt->tcommands.empty ()
+	  && gdbarch_fast_tracepoint_valid_at (gdbarch, addr, NULL))
+	insn_len = gdb_insn_length (gdbarch, addr);
+
       rs = get_remote_state ();
       p = rs->buf.data ();
       endbuf = p + get_remote_packet_size ();
@@ -11030,19 +11429,32 @@ remote_target::insert_breakpoint (struct gdbarch *gdbarch,
       *(p++) = 'Z';
       *(p++) = '0';
       *(p++) = ',';
-      addr = (ULONGEST) remote_address_masked (addr);
       p += hexnumstr (p, addr);
       xsnprintf (p, endbuf - p, ",%d", bp_tgt->kind);
 
       if (supports_evaluation_of_breakpoint_conditions ())
 	remote_add_target_side_condition (gdbarch, bp_tgt, p, endbuf);
 
+      if (insn_len > 0)
+	{
+	  p += strlen (p);
+	  xsnprintf (p, endbuf - p, ";F%x", insn_len);
+	}
+
       if (can_run_breakpoint_commands ())
 	remote_add_target_side_commands (gdbarch, bp_tgt, p);
 
       putpkt (rs->buf);
       getpkt (&rs->buf);
 
+      /* The stub asks us to relocate the instruction at ADDR before
+	 replying, if it installs the breakpoint as a jump pad.  */
+      while (startswith (rs->buf.data (), "qRelocInsn:"))
+	{
+	  remote_relocate_instruction (rs->buf.data ());
+	  getpkt (&rs->buf);
+	}
+
       switch ((m_features.packet_ok (rs->buf, PACKET_Z0)).status ())
 	{
 	case PACKET_ERROR:
@@ -11772,7 +12184,10 @@ remote_target::xfer_partial (enum target_object object,
 	 PACKET_qXfer_osdata);
 
     case TARGET_OBJECT_THREADS:
-      gdb_assert (annex == NULL);
+      /* Only the thread list changes are read with an annex.  */
+      gdb_assert (annex == NULL
+		  || (m_features.packet_support (PACKET_ThreadListDelta)
+		      == PACKET_ENABLE));
       return remote_read_qxfer
 	("threads", annex, readbuf, offset, len, xfered_len,
 	 PACKET_qXfer_threads);
@@ -11862,6 +12277,124 @@ remote_target::get_memory_xfer_limit ()
   return get_memory_write_packet_size ();
 }
 
+/* Implementation of target_ops::read_memory_ranges, using the
+   vReadMemory packet.  */
+
+bool
+remote_target::read_memory_ranges (gdb::array_view<memory_read_range> ranges)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (m_features.packet_support (PACKET_vReadMemory) != PACKET_ENABLE)
+    return false;
+
+  /* Targets above us may change how memory is read, e.g. to restrict
+     memory access while replaying or to switch threads, and only do so
+     in xfer_partial.  Traceframes need the handling in
+     remote_read_bytes too.  */
+  if (current_inferior ()->top_target () != this
+      || get_traceframe_number () != -1
+      || !target_has_execution ()
+      || (gdbarch_addressable_memory_unit_size (current_inferior ()->arch ())
+	  != 1))
+    return false;
+
+  if (ranges.empty ())
+    return true;
+
+  set_general_thread (inferior_ptid);
+
+  /* The most characters a hex number takes, plus a separator.  */
+  const int hex_max = 2 * sizeof (ULONGEST) + 1;
+  int request_size = get_remote_packet_size ();
+  int reply_size = get_memory_read_packet_size ();
+  size_t next = 0;
+
+  while (next < ranges.size ())
+    {
+      /* Construct "vReadMemory:"<addr>","<len>[";"<addr>","<len>]...
+	 with as many ranges as fit both in the request and in the
+	 reply, where each range takes its data plus its length.  */
+      char *p = rs->buf.data ();
+      strcpy (p, "vReadMemory:");
+      p += strlen (p);
+
+      std::vector<ULONGEST> sent_lens;
+      ULONGEST reply_room = reply_size > 2 ? reply_size - 2 : 0;
+      for (size_t i = next; i < ranges.size (); i++)
+	{
+	  if (p - rs->buf.data () + 2 * hex_max >= request_size
+	      || reply_room <= (ULONGEST) hex_max)
+	    break;
+
+	  reply_room -= hex_max;
+	  ULONGEST len = std::min (ranges[i].len, reply_room);
+	  reply_room -= len;
+
+	  if (i > next)
+	    *p++ = ';';
+	  p += hexnumstr (p, (ULONGEST) remote_address_masked (ranges[i].addr));
+	  *p++ = ',';
+	  p += hexnumstr (p, len);
+	  sent_lens.push_back (len);
+	}
+      *p = '\0';
+
+      if (sent_lens.empty ())
+	break;
+
+      putpkt (rs->buf);
+      int packet_len = getpkt (&rs->buf);
+
+      /* On error, leave the remaining ranges to the caller.  */
+      if (packet_len < 1 || rs->buf[0] != 'b')
+	break;
+
+      /* Reply is 'b', the number of bytes read from each range, then
+	 ';' and the data of all of them in binary.  */
+      const char *reply = rs->buf.data ();
+      const char *q = reply + 1;
+      std::vector<ULONGEST> lens;
+      ULONGEST total = 0;
+      while (q < reply + packet_len && *q != ';')
+	{
+	  ULONGEST len;
+	  const char *end = unpack_varlen_hex (q, &len);
+
+	  if (end == q || lens.size () == sent_lens.size ()
+	      || len > sent_lens[lens.size ()]
+	      || (*end != ',' && *end != ';'))
+	    error (_("Invalid reply to vReadMemory packet: %s"), reply);
+
+	  lens.push_back (len);
+	  total += len;
+	  q = *end == ',' ? end + 1 : end;
+	}
+
+      if (q == reply + packet_len || lens.empty ())
+	error (_("Invalid reply to vReadMemory packet: %s"), reply);
+      q++;
+
+      gdb::byte_vector data (total);
+      int data_len = remote_unescape_input ((const gdb_byte *) q,
+					    packet_len - (q - reply),
+					    data.data (), total);
+      if ((ULONGEST) data_len != total)
+	error (_("Invalid reply to vReadMemory packet: %s"), reply);
+
+      const gdb_byte *src = data.data ();
+      for (ULONGEST len : lens)
+	{
+	  memcpy (ranges[next].buf, src, len);
+	  ranges[next].xfered_len = len;
+	  src += len;
+	  next++;
+	}
+    }
+
+  return true;
+}
+
 int
 remote_target::search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
 			      const gdb_byte *pattern, ULONGEST pattern_len,
@@ -12632,8 +13165,7 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
 					   int *attachment_len)
 {
   struct remote_state *rs = get_remote_state ();
-  int ret, bytes_read;
-  const char *attachment_tmp;
+  int bytes_read;
 
   if (m_features.packet_support (which_packet) == PACKET_DISABLE)
     {
@@ -12644,6 +13176,24 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
   putpkt_binary (rs->buf.data (), command_bytes);
   bytes_read = getpkt (&rs->buf);
 
+  return remote_hostio_parse_reply (bytes_read, which_packet, remote_errno,
+				    attachment, attachment_len);
+}
+
+/* Parse the reply to a host I/O packet, of length BYTES_READ (as
+   returned by getpkt), found in the packet buffer.  The arguments and
+   result are as for remote_hostio_send_command.  */
+
+int
+remote_target::remote_hostio_parse_reply (int bytes_read, int which_packet,
+					  fileio_error *remote_errno,
+					  const char **attachment,
+					  int *attachment_len)
+{
+  struct remote_state *rs = get_remote_state ();
+  int ret;
+  const char *attachment_tmp;
+
   /* If it timed out, something is wrong.  Don't try to parse the
      buffer.  */
   if (bytes_read < 0)
@@ -12879,6 +13429,144 @@ remote_target::remote_hostio_pread_vFile (int fd, gdb_byte *read_buf, int len,
   return ret;
 }
 
+/* Read COUNT packets' worth of FD, starting at OFFSET, into BUF,
+   sending all of the vFile:pread requests before reading any of the
+   replies.  BUF is resized to the data read, which stops at the first
+   short read.  Returns the number of bytes read, or -1 if the first
+   read failed (and sets *REMOTE_ERRNO).  */
+
+int
+remote_target::remote_hostio_pread_window (int fd, gdb::byte_vector &buf,
+					   ULONGEST offset, int count,
+					   fileio_error *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (count <= 1)
+    {
+      buf.resize (get_remote_packet_size ());
+      int ret = remote_hostio_pread_vFile (fd, buf.data (), buf.size (),
+					   offset, remote_errno);
+      buf.resize (std::max (ret, 0));
+      return ret;
+    }
+
+  if (m_features.packet_support (PACKET_vFile_pread) == PACKET_DISABLE)
+    {
+      *remote_errno = FILEIO_ENOSYS;
+      return -1;
+    }
+
+  /* The requests are for consecutive chunks, so a reply cut short by
+     escaping would leave a hole.  Leave some room for escaping to make
+     that unlikely.  */
+  int chunk = get_remote_packet_size () / 8 * 7;
+
+  buf.resize ((size_t) count * chunk);
+  int total = 0;
+  bool done = false;
+  bool bad_reply = false;
+
+  /* The number of requests sent, and of replies read.  */
+  int sent = 0;
+  int received = 0;
+
+  try
+    {
+      for (; sent < count; sent++)
+	{
+	  char *p = rs->buf.data ();
+	  int left = get_remote_packet_size ();
+
+	  remote_buffer_add_string (&p, &left, "vFile:pread:");
+	  remote_buffer_add_int (&p, &left, fd);
+	  remote_buffer_add_string (&p, &left, ",");
+	  remote_buffer_add_int (&p, &left, chunk);
+	  remote_buffer_add_string (&p, &left, ",");
+	  remote_buffer_add_int (&p, &left, offset + (ULONGEST) sent * chunk);
+
+	  putpkt_binary (rs->buf.data (), p - rs->buf.data ());
+	}
+
+      /* Read every reply, even after a short or failed read, so that
+	 none is left behind to confuse the next command.  */
+      for (; received < count; received++)
+	{
+	  fileio_error reply_errno;
+	  const char *attachment;
+	  int attachment_len;
+
+	  int bytes_read = getpkt (&rs->buf);
+	  int ret = remote_hostio_parse_reply (bytes_read, PACKET_vFile_pread,
+					       &reply_errno, &attachment,
+					       &attachment_len);
+	  if (done)
+	    continue;
+
+	  if (ret < 0)
+	    {
+	      if (received == 0)
+		{
+		  buf.clear ();
+		  *remote_errno = reply_errno;
+		  total = -1;
+		}
+	      done = true;
+	      continue;
+	    }
+
+	  int read_len = remote_unescape_input ((gdb_byte *) attachment,
+						attachment_len,
+						&buf[total], chunk);
+	  if (read_len != ret)
+	    {
+	      bad_reply = true;
+	      done = true;
+	      continue;
+	    }
+
+	  total += ret;
+	  if (ret < chunk)
+	    done = true;
+	}
+    }
+  catch (const gdb_exception &ex)
+    {
+      /* If we were interrupted with replies still on their way, they
+	 would be taken as the replies to the next commands.  Read and
+	 drop them before passing on the error.  Only if that fails too
+	 give up on the connection, rather than get out of sync with the
+	 stub.  */
+      if (ex.error != TARGET_CLOSE_ERROR
+	  && received < sent
+	  && rs->remote_desc != nullptr)
+	{
+	  try
+	    {
+	      for (; received < sent; received++)
+		getpkt (&rs->buf);
+	    }
+	  catch (const gdb_exception &drain_ex)
+	    {
+	      if (drain_ex.error != TARGET_CLOSE_ERROR)
+		remote_unpush_target (this);
+	      throw_error (TARGET_CLOSE_ERROR,
+			   _("Remote communication error.  "
+			     "Target disconnected: %s"),
+			   ex.what ());
+	    }
+	}
+      throw;
+    }
+
+  if (bad_reply)
+    error (_("Read returned wrong number of bytes."));
+
+  if (total >= 0)
+    buf.resize (total);
+  return total;
+}
+
 /* See declaration.h.  */
 
 int
@@ -12926,20 +13614,28 @@ remote_target::remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
   remote_debug_printf ("readahead cache miss %s",
 		       pulongest (cache->miss_count));
 
+  /* If this read starts where the cached data ends, the file is
+     probably being read sequentially.  If the stub allows it, read
+     ahead several packets at once rather than waiting for each reply
+     before sending the next request.  */
+  int window = 1;
+  if (cache->fd == fd
+      && offset == cache->offset + cache->buf.size ()
+      && rs->noack_mode
+      && m_features.packet_support (PACKET_vFile_pread_window) == PACKET_ENABLE)
+    window = rs->pread_window;
+
   cache->fd = fd;
   cache->offset = offset;
-  cache->buf.resize (get_remote_packet_size ());
 
-  ret = remote_hostio_pread_vFile (cache->fd, &cache->buf[0],
-				   cache->buf.size (),
-				   cache->offset, remote_errno);
+  ret = remote_hostio_pread_window (cache->fd, cache->buf, cache->offset,
+				    window, remote_errno);
   if (ret <= 0)
     {
       cache->invalidate_fd (fd);
       return ret;
     }
 
-  cache->buf.resize (ret);
   return cache->pread (fd, read_buf, len, offset);
 }
 
@@ -16133,6 +16829,36 @@ Specify \"unlimited\" for unlimited hardware breakpoints."),
 			    NULL, show_hardware_breakpoint_limit,
 			    &remote_set_cmdlist, &remote_show_cmdlist);
 
+  add_setshow_boolean_cmd ("compression", class_support,
+			   &remote_compression, _("\
+Set whether the remote target should compress the data it sends."), _("\
+Show whether the remote target should compress the data it sends."), _("\
+If on, and the remote target supports it, GDB asks it to compress\n\
+everything it sends with zlib when connecting.  This reduces the\n\
+amount of data transferred over slow links, at the cost of some\n\
+processing time on both ends.  Over fast links, such as a pipe or a\n\
+TCP connection to the same machine, this makes the connection slower,\n\
+so only turn it on for slow links.  The setting takes effect on the\n\
+next connection.  The default is off."),
+			   NULL, show_remote_compression,
+			   &remote_set_cmdlist, &remote_show_cmdlist);
+
+  add_setshow_boolean_cmd ("fast-conditional-breakpoints", class_support,
+			   &remote_fast_conditional_breakpoints, _("\
+Set whether conditional breakpoints may be evaluated in jump pads."), _("\
+Show whether conditional breakpoints may be evaluated in jump pads."), _("\
+If on, and the remote target supports it, a breakpoint whose condition\n\
+the target evaluates may be installed as a jump to a jump pad that\n\
+evaluates the condition in the inferior, like a fast tracepoint, rather\n\
+than as a software breakpoint.  This avoids stopping the inferior when\n\
+the condition is false, but the jump pad has the same limitations as a\n\
+fast tracepoint: the condition can only read the general purpose\n\
+registers, and code using the stack below the stack pointer may be\n\
+corrupted.  The setting takes effect for breakpoints inserted after it\n\
+is changed.  The default is off."),
+			   NULL, show_remote_fast_conditional_breakpoints,
+			   &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zuinteger_cmd ("remoteaddresssize", class_obscure,
 			     &remote_address_size, _("\
 Set the maximum size of the address (in bits) in a memory packet."), _("\
@@ -16282,6 +17008,10 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (PACKET_BreakpointCommands, "BreakpointCommands",
 			 "breakpoint-commands", 0);
 
+  add_packet_config_cmd (PACKET_FastConditionalBreakpoints,
+			 "FastConditionalBreakpoints",
+			 "fast-conditional-breakpoints", 0);
+
   add_packet_config_cmd (PACKET_FastTracepoints, "FastTracepoints",
 			 "fast-tracepoints", 0);
 
@@ -16374,6 +17104,19 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (PACKET_accept_error_message,
 			 "error-message", "error-message", 0);
 
+  add_packet_config_cmd (PACKET_x, "x", "binary-upload", 0);
+
+  add_packet_config_cmd (PACKET_vReadRegisters, "vReadRegisters",
+			 "read-thread-registers", 0);
+  add_packet_config_cmd (PACKET_QCompress, "QCompress", "compression", 0);
+  add_packet_config_cmd (PACKET_vReadMemory, "vReadMemory",
+			 "read-memory-ranges", 0);
+
+  add_packet_config_cmd (PACKET_vFile_pread_window, "vFile:pread-window",
+			 "hostio-pread-window", 0);
+  add_packet_config_cmd (PACKET_ThreadListDelta, "ThreadListDelta",
+			 "thread-list-delta", 0);
+
   /* Assert that we've registered "set remote foo-packet" commands
      for all packet configs.  */
   {
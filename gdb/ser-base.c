@@ -65,6 +65,19 @@ enum {
 static void
 reschedule (struct serial *scb)
 {
+  /* Decompressed input may be pending even though there is nothing
+     to read from the device.  */
+  if (scb->bufcnt == 0)
+    {
+      int n = serial_inflate_pending (scb, BUFSIZ);
+
+      if (n > 0)
+	{
+	  scb->bufcnt = n;
+	  scb->bufp = scb->buf;
+	}
+    }
+
   if (serial_is_async_p (scb))
     {
       int next_state;
@@ -168,10 +181,18 @@ fd_event (int error, void *context)
 
       do
 	{
-	  nr = scb->ops->read_prim (scb, BUFSIZ);
+	  nr = serial_read_prim (scb, BUFSIZ);
 	}
       while (nr < 0 && errno == EINTR);
 
+      /* If the compressed data read doesn't decompress to anything
+	 yet, wait for more.  */
+      if (nr < 0 && errno == EAGAIN && scb->inflate != NULL)
+	{
+	  reschedule (scb);
+	  return;
+	}
+
       if (nr == 0)
 	{
 	  scb->bufcnt = SERIAL_EOF;
@@ -346,53 +367,73 @@ do_ser_base_readchar (struct serial *scb, int timeout)
      Also, timeout = 0 means to poll, so we just set the delta to 0,
      so we will only go through the loop once.  */
 
-  delta = (timeout == 0 ? 0 : 1);
   while (1)
     {
-      /* N.B. The UI may destroy our world (for instance by calling
-	 remote_stop,) in which case we want to get out of here as
-	 quickly as possible.  It is not safe to touch scb, since
-	 someone else might have freed it.  The
-	 deprecated_ui_loop_hook signals that we should exit by
-	 returning 1.  */
-
-      if (deprecated_ui_loop_hook)
+      /* Decompressed input may be pending even though there is nothing
+	 to read from the device.  */
+      status = serial_inflate_pending (scb, BUFSIZ);
+      if (status > 0)
 	{
-	  if (deprecated_ui_loop_hook (0))
-	    return SERIAL_TIMEOUT;
+	  scb->bufcnt = status - 1;
+	  scb->bufp = scb->buf;
+	  return *scb->bufp++;
 	}
 
-      status = ser_base_wait_for (scb, delta);
-      if (timeout > 0)
-	timeout -= delta;
+      delta = (timeout == 0 ? 0 : 1);
+      while (1)
+	{
+	  /* N.B. The UI may destroy our world (for instance by calling
+	     remote_stop,) in which case we want to get out of here as
+	     quickly as possible.  It is not safe to touch scb, since
+	     someone else might have freed it.  The
+	     deprecated_ui_loop_hook signals that we should exit by
+	     returning 1.  */
+
+	  if (deprecated_ui_loop_hook)
+	    {
+	      if (deprecated_ui_loop_hook (0))
+		return SERIAL_TIMEOUT;
+	    }
 
-      /* If we got a character or an error back from wait_for, then we can 
-	 break from the loop before the timeout is completed.  */
-      if (status != SERIAL_TIMEOUT)
-	break;
+	  status = ser_base_wait_for (scb, delta);
+	  if (timeout > 0)
+	    timeout -= delta;
 
-      /* If we have exhausted the original timeout, then generate
-	 a SERIAL_TIMEOUT, and pass it out of the loop.  */
-      else if (timeout == 0)
-	{
-	  status = SERIAL_TIMEOUT;
-	  break;
+	  /* If we got a character or an error back from wait_for, then we can 
+	     break from the loop before the timeout is completed.  */
+	  if (status != SERIAL_TIMEOUT)
+	    break;
+
+	  /* If we have exhausted the original timeout, then generate
+	     a SERIAL_TIMEOUT, and pass it out of the loop.  */
+	  else if (timeout == 0)
+	    {
+	      status = SERIAL_TIMEOUT;
+	      break;
+	    }
+
+	  /* We also need to check and consume the stderr because it could
+	     come before the stdout for some stubs.  If we just sit and wait
+	     for stdout, we would hit a deadlock for that case.  */
+	  ser_base_read_error_fd (scb, 0);
 	}
 
-      /* We also need to check and consume the stderr because it could
-	 come before the stdout for some stubs.  If we just sit and wait
-	 for stdout, we would hit a deadlock for that case.  */
-      ser_base_read_error_fd (scb, 0);
-    }
+      if (status < 0)
+	return status;
 
-  if (status < 0)
-    return status;
+      do
+	{
+	  status = serial_read_prim (scb, BUFSIZ);
+	}
+      while (status < 0 && errno == EINTR);
 
-  do
-    {
-      status = scb->ops->read_prim (scb, BUFSIZ);
+      /* If the compressed data read doesn't decompress to anything yet,
+	 wait for more.  */
+      if (status < 0 && errno == EAGAIN && scb->inflate != NULL)
+	continue;
+
+      break;
     }
-  while (status < 0 && errno == EINTR);
 
   if (status <= 0)
     {
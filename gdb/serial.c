@@ -19,9 +19,24 @@
 
 #include <ctype.h>
 #include "serial.h"
+#include <zlib.h>
 #include "cli/cli-cmds.h"
 #include "cli/cli-utils.h"
 
+/* The state of a serial device whose input is compressed.  */
+
+struct serial_inflate
+{
+  z_stream stream {};
+
+  /* Compressed data read from the device and not decompressed yet.  */
+  unsigned char in[BUFSIZ];
+
+  /* True if the last call to inflate filled the output buffer, so
+     that more output may be pending.  */
+  bool output_full = false;
+};
+
 /* Is serial being debugged?  */
 
 static unsigned int global_serial_debug_p;
@@ -316,6 +331,13 @@ do_serial_close (struct serial *scb, int really_close)
   if (really_close)
     scb->ops->close (scb);
 
+  if (scb->inflate != NULL)
+    {
+      inflateEnd (&scb->inflate->stream);
+      delete scb->inflate;
+      scb->inflate = NULL;
+    }
+
   xfree (scb->name);
 
   /* For serial_is_open.  */
@@ -430,6 +452,98 @@ serial_write (struct serial *scb, const void *buf, size_t count)
   scb->ops->write (scb, buf, count);
 }
 
+/* See serial.h.  */
+
+bool
+serial_can_decompress_input (struct serial *scb)
+{
+  return scb->ops->read_prim != NULL;
+}
+
+/* See serial.h.  */
+
+void
+serial_decompress_input (struct serial *scb)
+{
+  gdb_assert (scb->inflate == NULL);
+  gdb_assert (serial_can_decompress_input (scb));
+
+  std::unique_ptr<serial_inflate> state (new serial_inflate);
+  if (inflateInit (&state->stream) != Z_OK)
+    error (_("Could not initialize decompression: %s"),
+	   state->stream.msg != NULL ? state->stream.msg : "");
+
+  /* What is left in the input buffer was read after the point where
+     the other end started compressing.  */
+  if (scb->bufcnt > 0)
+    {
+      memcpy (state->in, scb->bufp, scb->bufcnt);
+      state->stream.next_in = state->in;
+      state->stream.avail_in = scb->bufcnt;
+      scb->bufcnt = 0;
+    }
+  scb->bufp = scb->buf;
+  scb->inflate = state.release ();
+
+  int n = serial_inflate_pending (scb, sizeof (scb->buf));
+  if (n > 0)
+    scb->bufcnt = n;
+}
+
+/* See serial.h.  */
+
+int
+serial_inflate_pending (struct serial *scb, size_t count)
+{
+  serial_inflate *state = scb->inflate;
+
+  if (state == NULL
+      || (state->stream.avail_in == 0 && !state->output_full))
+    return 0;
+
+  state->stream.next_out = scb->buf;
+  state->stream.avail_out = count;
+  int ret = inflate (&state->stream, Z_SYNC_FLUSH);
+  if (ret != Z_OK && ret != Z_BUF_ERROR)
+    error (_("Could not decompress remote data: %s"),
+	   state->stream.msg != NULL ? state->stream.msg : "");
+  state->output_full = state->stream.avail_out == 0;
+
+  return count - state->stream.avail_out;
+}
+
+/* See serial.h.  */
+
+int
+serial_read_prim (struct serial *scb, size_t count)
+{
+  serial_inflate *state = scb->inflate;
+
+  if (state == NULL)
+    return scb->ops->read_prim (scb, count);
+
+  int n = serial_inflate_pending (scb, count);
+  if (n > 0)
+    return n;
+
+  /* All the compressed data read so far has been decompressed, so
+     the input buffer is free.  */
+  n = scb->ops->read_prim (scb, std::min (count, sizeof (state->in)));
+  if (n <= 0)
+    return n;
+
+  memcpy (state->in, scb->buf, n);
+  state->stream.next_in = state->in;
+  state->stream.avail_in = n;
+
+  n = serial_inflate_pending (scb, count);
+  if (n > 0)
+    return n;
+
+  errno = EAGAIN;
+  return -1;
+}
+
 void
 serial_printf (struct serial *desc, const char *format, ...)
 {
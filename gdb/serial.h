@@ -129,6 +129,32 @@ extern void serial_write (struct serial *scb, const void *buf, size_t count);
 extern void serial_printf (struct serial *desc, 
 			   const char *,...) ATTRIBUTE_PRINTF (2, 3);
 
+/* Return true if the data read from SCB can be decompressed, see
+   serial_decompress_input.  */
+
+extern bool serial_can_decompress_input (struct serial *scb);
+
+/* From now on, treat the data read from SCB, including any data
+   already buffered, as a zlib stream, and return the decompressed
+   data from serial_readchar.  The other end must flush the stream
+   after each write, so that nothing it sent remains stuck in the
+   compressor.  */
+
+extern void serial_decompress_input (struct serial *scb);
+
+/* For serial implementations.  If the input of SCB is compressed,
+   decompress the compressed data pending into SCB->BUF, up to COUNT
+   bytes.  Return the number of bytes, or 0 if there is none.  */
+
+extern int serial_inflate_pending (struct serial *scb, size_t count);
+
+/* For serial implementations.  Like SCB->ops->read_prim, but if the
+   input of SCB is compressed, decompress the data read.  Return -1
+   with errno set to EAGAIN if the data read doesn't decompress to
+   anything yet.  */
+
+extern int serial_read_prim (struct serial *scb, size_t count);
+
 /* Allow pending output to drain.  */
 
 extern int serial_drain_output (struct serial *);
@@ -254,6 +280,9 @@ struct serial
     int async_state;		/* Async internal state.  */
     void *async_context;	/* Async event thread's context */
     serial_event_ftype *async_handler;/* Async event handler */
+    /* If non-NULL, the data read from the device is compressed; see
+       serial_decompress_input.  */
+    struct serial_inflate *inflate;
   };
 
 struct serial_ops
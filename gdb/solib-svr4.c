@@ -47,6 +47,7 @@
 #include "probe.h"
 
 #include <map>
+#include <unordered_map>
 
 static struct link_map_offsets *svr4_fetch_link_map_offsets (void);
 static int svr4_have_link_map_offsets (void);
@@ -1207,16 +1208,24 @@ svr4_default_sos (svr4_info *info)
   return sos;
 }
 
+/* Map from the address of a link map entry to the shared object
+   previously read from it.  */
+
+using svr4_so_by_lm_map = std::unordered_map<CORE_ADDR, const svr4_so *>;
+
 /* Read the whole inferior libraries chain starting at address LM.
    Expect the first entry in the chain's previous entry to be PREV_LM.
    Add the entries to SOS.  Ignore the first entry if IGNORE_FIRST and set
-   global MAIN_LM_ADDR according to it.  Returns nonzero upon success.  If zero
+   global MAIN_LM_ADDR according to it.  If KNOWN is non-NULL, entries
+   found in it which are unchanged reuse the previously read name.
+   Returns nonzero upon success.  If zero
    is returned the entries stored to LINK_PTR_PTR are still valid although they may
    represent only part of the inferior library list.  */
 
 static int
 svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
-		   std::vector<svr4_so> &sos, int ignore_first)
+		   std::vector<svr4_so> &sos, int ignore_first,
+		   const svr4_so_by_lm_map *known = nullptr)
 {
   CORE_ADDR first_l_name = 0;
   CORE_ADDR next_lm;
@@ -1249,6 +1258,28 @@ svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
 	  continue;
 	}
 
+      /* If this entry was already read by a previous walk of the list
+	 and still describes the same object, reuse its name rather than
+	 reading it from the inferior again.  Reading the name is done in
+	 small chunks and dominates the cost of a full reload when many
+	 objects are loaded.  */
+      if (known != nullptr)
+	{
+	  auto it = known->find (li->lm_addr);
+	  if (it != known->end ())
+	    {
+	      const lm_info_svr4 &old_li = *it->second->lm_info;
+
+	      if (old_li.l_name == li->l_name
+		  && old_li.l_addr_inferior == li->l_addr_inferior
+		  && old_li.l_ld == li->l_ld)
+		{
+		  sos.emplace_back (it->second->name.c_str (), std::move (li));
+		  continue;
+		}
+	    }
+	}
+
       /* Extract this shared object's name.  */
       gdb::unique_xmalloc_ptr<char> name
 	= target_read_string (li->l_name, SO_NAME_MAX_PATH_SIZE - 1);
@@ -1286,7 +1317,11 @@ svr4_current_sos_direct (struct svr4_info *info)
   bool ignore_first;
   struct svr4_library_list library_list;
 
-  /* Remove any old libraries.  We're going to read them back in again.  */
+  /* Remove any old libraries.  We're going to read them back in again,
+     but keep them around until then so that the names of objects which
+     are still loaded need not be read from the inferior again.  */
+  std::map<CORE_ADDR, std::vector<svr4_so>> old_lists
+    = std::move (info->solib_lists);
   info->solib_lists.clear ();
 
   /* Fall back to manual examination of the target if the packet is not
@@ -1338,6 +1373,11 @@ svr4_current_sos_direct (struct svr4_info *info)
   auto cleanup = make_scope_exit ([info] ()
     { info->solib_lists.clear (); });
 
+  svr4_so_by_lm_map known;
+  for (const auto &tuple : old_lists)
+    for (const svr4_so &so : tuple.second)
+      known.emplace (so.lm_info->lm_addr, &so);
+
   /* Collect the sos in each namespace.  */
   CORE_ADDR debug_base = info->debug_base;
   for (; debug_base != 0;
@@ -1347,7 +1387,7 @@ svr4_current_sos_direct (struct svr4_info *info)
       lm = solib_svr4_r_map (debug_base);
       if (lm != 0)
 	svr4_read_so_list (info, lm, 0, info->solib_lists[debug_base],
-			   ignore_first);
+			   ignore_first, &known);
     }
 
   /* On Solaris, the dynamic linker is not in the normal list of
@@ -44,7 +44,9 @@
 #include "interps.h"
 #include "filesystem.h"
 #include "gdb_bfd.h"
+#include "target-file-cache.h"
 #include "gdbsupport/filestuff.h"
+#include "gdbsupport/parallel-for.h"
 #include "gdbsupport/scoped_fd.h"
 #include "debuginfod-support.h"
 #include "source.h"
@@ -76,6 +78,68 @@ show_solib_search_path (struct ui_file *file, int from_tty,
 #define DOS_BASED_FILE_SYSTEM 0
 #endif
 
+/* The settings and inferior state used to search for binary files.
+   They are read on the main thread when the search starts, so that the
+   search itself can be done by worker threads, which must not access
+   GDB's global state.  */
+
+struct solib_search_state
+{
+  solib_search_state ();
+
+  /* Return the value of the inferior's environment variable VAR
+     (PATH or LD_LIBRARY_PATH), or NULL if it is not set.  */
+  const char *
+  env (const std::optional<std::string> &var) const
+  {
+    return var.has_value () ? var->c_str () : nullptr;
+  }
+
+  /* The value of gdb_sysroot.  */
+  std::string sysroot;
+
+  /* The value of solib_search_path.  */
+  std::string search_path;
+
+  /* The file system kind of the target.  */
+  const char *fskind;
+
+  /* Whether target_fileio accesses the local filesystem.  */
+  bool filesystem_is_local;
+
+  /* The inferior's PATH and LD_LIBRARY_PATH.  */
+  std::optional<std::string> path;
+  std::optional<std::string> ld_library_path;
+
+  /* The architecture of the current inferior, and the extension of
+     its shared library symbol files.  */
+  const bfd_arch_info *arch_info;
+  const char *symbols_extension;
+
+  /* The BFD target to open the files with.  */
+  std::string gnutarget;
+};
+
+solib_search_state::solib_search_state ()
+  : sysroot (gdb_sysroot),
+    search_path (solib_search_path),
+    fskind (effective_target_file_system_kind ()),
+    filesystem_is_local (target_filesystem_is_local ())
+{
+  inferior *inf = current_inferior ();
+  if (const char *val = inf->environment.get ("PATH"))
+    path = val;
+  if (const char *val = inf->environment.get ("LD_LIBRARY_PATH"))
+    ld_library_path = val;
+
+  gdbarch *gdbarch = inf->arch ();
+  arch_info = gdbarch_bfd_arch_info (gdbarch);
+  symbols_extension = gdbarch_solib_symbols_extension (gdbarch);
+
+  if (::gnutarget != nullptr)
+    gnutarget = ::gnutarget;
+}
+
 /* Return the full pathname of a binary file (the main executable or a
    shared library file), or NULL if not found.  If FD is non-NULL, *FD
    is set to either -1 or an open file handle for the binary file.
@@ -112,12 +176,13 @@ show_solib_search_path (struct ui_file *file, int from_tty,
 */
 
 static gdb::unique_xmalloc_ptr<char>
-solib_find_1 (const char *in_pathname, int *fd, bool is_solib)
+solib_find_1 (const solib_search_state &state, const char *in_pathname,
+	      int *fd, bool is_solib)
 {
   int found_file = -1;
   gdb::unique_xmalloc_ptr<char> temp_pathname;
-  const char *fskind = effective_target_file_system_kind ();
-  const char *sysroot = gdb_sysroot.c_str ();
+  const char *fskind = state.fskind;
+  const char *sysroot = state.sysroot.c_str ();
   int prefix_len, orig_prefix_len;
 
   /* If the absolute prefix starts with "target:" but the filesystem
@@ -126,7 +191,7 @@ solib_find_1 (const char *in_pathname, int *fd, bool is_solib)
      filesystem.  This ensures that the same search algorithm is used
      for all local files regardless of whether a "target:" prefix was
      used.  */
-  if (is_target_filename (sysroot) && target_filesystem_is_local ())
+  if (is_target_filename (sysroot) && state.filesystem_is_local)
     sysroot += strlen (TARGET_SYSROOT_PREFIX);
 
   /* Strip any trailing slashes from the absolute prefix.  */
@@ -281,8 +346,8 @@ solib_find_1 (const char *in_pathname, int *fd, bool is_solib)
 
   /* If not found, and we're looking for a solib, search the
      solib_search_path (if any).  */
-  if (is_solib && found_file < 0 && !solib_search_path.empty ())
-    found_file = openp (solib_search_path.c_str (),
+  if (is_solib && found_file < 0 && !state.search_path.empty ())
+    found_file = openp (state.search_path.c_str (),
 			OPF_TRY_CWD_FIRST | OPF_RETURN_REALPATH, in_pathname,
 			O_RDONLY | O_BINARY, &temp_pathname);
 
@@ -290,15 +355,15 @@ solib_find_1 (const char *in_pathname, int *fd, bool is_solib)
      solib_search_path (if any) for the basename only (ignoring the
      path).  This is to allow reading solibs from a path that differs
      from the opened path.  */
-  if (is_solib && found_file < 0 && !solib_search_path.empty ())
-    found_file = openp (solib_search_path.c_str (),
+  if (is_solib && found_file < 0 && !state.search_path.empty ())
+    found_file = openp (state.search_path.c_str (),
 			OPF_TRY_CWD_FIRST | OPF_RETURN_REALPATH,
 			target_lbasename (fskind, in_pathname),
 			O_RDONLY | O_BINARY, &temp_pathname);
 
   /* If not found, next search the inferior's $PATH environment variable.  */
   if (found_file < 0 && sysroot == NULL)
-    found_file = openp (current_inferior ()->environment.get ("PATH"),
+    found_file = openp (state.env (state.path),
 			OPF_TRY_CWD_FIRST | OPF_RETURN_REALPATH, in_pathname,
 			O_RDONLY | O_BINARY, &temp_pathname);
 
@@ -306,7 +371,7 @@ solib_find_1 (const char *in_pathname, int *fd, bool is_solib)
      inferior's $LD_LIBRARY_PATH environment variable.  */
   if (is_solib && found_file < 0 && sysroot == NULL)
     found_file
-      = openp (current_inferior ()->environment.get ("LD_LIBRARY_PATH"),
+      = openp (state.env (state.ld_library_path),
 	       OPF_TRY_CWD_FIRST | OPF_RETURN_REALPATH, in_pathname,
 	       O_RDONLY | O_BINARY, &temp_pathname);
 
@@ -336,7 +401,8 @@ exec_file_find (const char *in_pathname, int *fd)
 
   if (!gdb_sysroot.empty () && IS_TARGET_ABSOLUTE_PATH (fskind, in_pathname))
     {
-      result = solib_find_1 (in_pathname, fd, false);
+      solib_search_state state;
+      result = solib_find_1 (state, in_pathname, fd, false);
 
       if (result == NULL && fskind == file_system_kind_dos_based)
 	{
@@ -346,7 +412,7 @@ exec_file_find (const char *in_pathname, int *fd)
 	  strcpy (new_pathname, in_pathname);
 	  strcat (new_pathname, ".exe");
 
-	  result = solib_find_1 (new_pathname, fd, false);
+	  result = solib_find_1 (state, new_pathname, fd, false);
 	}
     }
   else
@@ -375,11 +441,11 @@ exec_file_find (const char *in_pathname, int *fd)
    The search algorithm used is described in solib_find_1's comment
    above.  */
 
-gdb::unique_xmalloc_ptr<char>
-solib_find (const char *in_pathname, int *fd)
+static gdb::unique_xmalloc_ptr<char>
+solib_find (const solib_search_state &state, const char *in_pathname,
+	    int *fd)
 {
-  const char *solib_symbols_extension
-    = gdbarch_solib_symbols_extension (current_inferior ()->arch ());
+  const char *solib_symbols_extension = state.symbols_extension;
 
   /* If solib_symbols_extension is set, replace the file's
      extension.  */
@@ -405,7 +471,13 @@ solib_find (const char *in_pathname, int *fd)
 	}
     }
 
-  return solib_find_1 (in_pathname, fd, true);
+  return solib_find_1 (state, in_pathname, fd, true);
+}
+
+gdb::unique_xmalloc_ptr<char>
+solib_find (const char *in_pathname, int *fd)
+{
+  return solib_find (solib_search_state (), in_pathname, fd);
 }
 
 /* Open and return a BFD for the shared library PATHNAME.  If FD is not -1,
@@ -414,10 +486,10 @@ solib_find (const char *in_pathname, int *fd)
 
    If unsuccessful, the FD will be closed (unless FD was -1).  */
 
-gdb_bfd_ref_ptr
-solib_bfd_fopen (const char *pathname, int fd)
+static gdb_bfd_ref_ptr
+solib_bfd_fopen (const char *pathname, int fd, const char *target)
 {
-  gdb_bfd_ref_ptr abfd (gdb_bfd_open (pathname, gnutarget, fd));
+  gdb_bfd_ref_ptr abfd (gdb_bfd_open (pathname, target, fd));
 
   if (abfd == NULL)
     {
@@ -429,17 +501,26 @@ solib_bfd_fopen (const char *pathname, int fd)
   return abfd;
 }
 
-/* Find shared library PATHNAME and open a BFD for it.  */
-
 gdb_bfd_ref_ptr
-solib_bfd_open (const char *pathname)
+solib_bfd_fopen (const char *pathname, int fd)
+{
+  return solib_bfd_fopen (pathname, fd, gnutarget);
+}
+
+/* Find shared library PATHNAME and open a BFD for it, using the search
+   settings in STATE.  */
+
+static gdb_bfd_ref_ptr
+solib_bfd_open_1 (const solib_search_state &state, const char *pathname)
 {
   int found_file;
   const struct bfd_arch_info *b;
+  const char *target
+    = state.gnutarget.empty () ? nullptr : state.gnutarget.c_str ();
 
   /* Search for shared library file.  */
   gdb::unique_xmalloc_ptr<char> found_pathname
-    = solib_find (pathname, &found_file);
+    = solib_find (state, pathname, &found_file);
   if (found_pathname == NULL)
     {
       /* Return failure if the file could not be found, so that we can
@@ -450,16 +531,33 @@ solib_bfd_open (const char *pathname)
       perror_with_name (pathname);
     }
 
-  /* Open bfd for shared library.  */
-  gdb_bfd_ref_ptr abfd (solib_bfd_fopen (found_pathname.get (), found_file));
+  /* Prefer a local copy of a library on the target's filesystem.  */
+  bool on_target = (is_target_filename (found_pathname.get ())
+		    && !state.filesystem_is_local);
+  gdb_bfd_ref_ptr abfd;
+  if (on_target)
+    abfd = target_file_cache_lookup (found_pathname.get (), target);
 
-  /* Check bfd format.  */
-  if (!bfd_check_format (abfd.get (), bfd_object))
-    error (_ ("`%s': not in executable format: %s"),
-	   bfd_get_filename (abfd.get ()), bfd_errmsg (bfd_get_error ()));
+  if (abfd == nullptr)
+    {
+      /* Open bfd for shared library.  */
+      abfd = solib_bfd_fopen (found_pathname.get (), found_file, target);
+
+      /* Check bfd format.  */
+      if (!bfd_check_format (abfd.get (), bfd_object))
+	error (_ ("`%s': not in executable format: %s"),
+	       bfd_get_filename (abfd.get ()), bfd_errmsg (bfd_get_error ()));
+
+      if (on_target)
+	{
+	  gdb_bfd_ref_ptr copy = target_file_cache_open (abfd.get ());
+	  if (copy != nullptr)
+	    abfd = std::move (copy);
+	}
+    }
 
   /* Check bfd arch.  */
-  b = gdbarch_bfd_arch_info (current_inferior ()->arch ());
+  b = state.arch_info;
   if (!b->compatible (b, bfd_get_arch_info (abfd.get ())))
     error (_ ("`%s': Shared library architecture %s is not compatible "
 	      "with target architecture %s."),
@@ -469,6 +567,14 @@ solib_bfd_open (const char *pathname)
   return abfd;
 }
 
+/* Find shared library PATHNAME and open a BFD for it.  */
+
+gdb_bfd_ref_ptr
+solib_bfd_open (const char *pathname)
+{
+  return solib_bfd_open_1 (solib_search_state (), pathname);
+}
+
 /* Mapping of a core file's shared library sonames to their respective
    build-ids.  Added to the registries of core file bfds.  */
 
@@ -734,6 +840,72 @@ notify_solib_unloaded (program_space *pspace, const solib &so)
   gdb::observers::solib_unloaded.notify (pspace, so);
 }
 
+/* Open the BFDs of the newly loaded shared objects NEW_SOS on the
+   thread pool.  BFDs are shared between callers opening the same file,
+   so the serial calls to solib_map_sections done by update_solib_list
+   then find them already opened and checked, instead of searching for,
+   opening and reading the headers of each file in turn.  Returns the
+   opened BFDs, which the caller must keep alive until the sections of
+   NEW_SOS have been mapped.  Failures are ignored here; they are
+   reported by the serial pass.  */
+
+static std::vector<gdb_bfd_ref_ptr>
+prefetch_solib_bfds (const solib_ops *ops, const intrusive_list<solib> &new_sos)
+{
+  std::vector<gdb_bfd_ref_ptr> result;
+
+  /* Only the default method is known to be safe to call off the main
+     thread, and only when not going through target fileio.  */
+  if (ops->bfd_open != solib_bfd_open
+      || !target_filesystem_is_local ()
+      || !gdb_bfd_sharing_p ())
+    return result;
+
+  std::vector<std::string> names;
+  for (const solib &so : new_sos)
+    {
+      gdb::unique_xmalloc_ptr<char> filename
+	(tilde_expand (so.so_name.c_str ()));
+      names.emplace_back (filename.get ());
+    }
+
+  if (names.size () < 2)
+    return result;
+
+  result.resize (names.size ());
+  std::vector<deferred_warnings> warnings (names.size ());
+
+  /* The workers search for the files with the settings read here,
+     rather than reading GDB's global state themselves.  */
+  const solib_search_state state;
+
+  gdb::parallel_for_each (1, names.begin (), names.end (),
+    [&] (std::vector<std::string>::iterator start,
+	 std::vector<std::string>::iterator end)
+    {
+      for (auto iter = start; iter < end; ++iter)
+	{
+	  size_t idx = iter - names.begin ();
+	  scoped_restore_warning_hook restore_warnings (&warnings[idx]);
+
+	  try
+	    {
+	      result[idx] = solib_bfd_open_1 (state, iter->c_str ());
+	    }
+	  catch (const gdb_exception_error &)
+	    {
+	    }
+	}
+    });
+
+  /* BFD only reports a given problem once, so the serial pass would
+     not repeat warnings issued while opening the files here.  */
+  for (const deferred_warnings &w : warnings)
+    w.emit ();
+
+  return result;
+}
+
 /* See solib.h.  */
 
 void
@@ -859,6 +1031,9 @@ update_solib_list (int from_tty)
       int not_found = 0;
       const char *not_found_filename = NULL;
 
+      std::vector<gdb_bfd_ref_ptr> prefetched
+	= prefetch_solib_bfds (ops, inferior);
+
       /* Fill in the rest of each of the `so' nodes.  */
       for (solib &new_so : inferior)
 	{
@@ -59,6 +59,7 @@
 #include "cli/cli-option.h"
 #include "cli/cli-style.h"
 #include "gdbsupport/buildargv.h"
+#include "target-dcache.h"
 
 /* The possible choices of "set print frame-arguments", and the value
    of this setting.  */
@@ -1983,6 +1984,19 @@ backtrace_command_1 (const frame_print_options &fp_opts,
   if (!target_has_stack ())
     error (_("No stack."));
 
+  /* Read ahead the part of the stack that unwinding is likely to
+     need, rather than fetching it one cache line at a time.  */
+  try
+    {
+      frame_info_ptr frame = get_current_frame ();
+      target_dcache_prefetch_stack (get_frame_arch (frame),
+				    get_frame_sp (frame));
+    }
+  catch (const gdb_exception_error &)
+    {
+      /* Unwinding will report any real problem.  */
+    }
+
   if (count_exp)
     {
       count = parse_and_eval_long (count_exp);
@@ -18,6 +18,9 @@
 #include "target-dcache.h"
 #include "progspace.h"
 #include "cli/cli-cmds.h"
+#include "gdbarch.h"
+#include "inferior.h"
+#include "tracepoint.h"
 
 /* The target dcache is kept per-address-space.  This key lets us
    associate the cache with the address space.  */
@@ -151,6 +154,46 @@ code_cache_enabled_p (void)
   return code_cache_enabled;
 }
 
+/* The number of bytes of stack read ahead by
+   target_dcache_prefetch_stack.  Zero disables it.  */
+
+static unsigned int stack_cache_prefetch_size = 0;
+
+/* Show option "stack-cache-prefetch".  */
+
+static void
+show_stack_cache_prefetch (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  if (stack_cache_prefetch_size == 0)
+    gdb_printf (file, _("Stack prefetching is disabled.\n"));
+  else
+    gdb_printf (file, _("Number of bytes of stack to prefetch is %s.\n"),
+		value);
+}
+
+/* See target-dcache.h.  */
+
+void
+target_dcache_prefetch_stack (gdbarch *gdbarch, CORE_ADDR sp)
+{
+  if (!stack_cache_enabled_p () || stack_cache_prefetch_size == 0)
+    return;
+
+  /* There's no live stack to read ahead when looking at a traceframe,
+     which only holds the memory collected, or without a thread.  */
+  if (get_traceframe_number () != -1 || inferior_ptid == null_ptid)
+    return;
+
+  DCACHE *dcache = target_dcache_get_or_init (current_program_space->aspace);
+  ULONGEST len = stack_cache_prefetch_size;
+
+  if (gdbarch_inner_than (gdbarch, 1, 2))
+    dcache_prefetch (dcache, sp, len);
+  else
+    dcache_prefetch (dcache, sp - std::min ((ULONGEST) sp, len), len);
+}
+
 /* Implement the 'maint flush dcache' command.  */
 
 static void
@@ -176,6 +219,20 @@ By default, caching for stack access is on."),
 			   show_stack_cache,
 			   &setlist, &showlist);
 
+  add_setshow_zuinteger_cmd ("stack-cache-prefetch", class_support,
+			     &stack_cache_prefetch_size, _("\
+Set the number of bytes of stack to read ahead for backtraces."), _("\
+Show the number of bytes of stack to read ahead for backtraces."), _("\
+When non-zero, and the stack cache is on, the backtrace command reads\n\
+this many bytes of stack above the innermost frame's stack pointer into\n\
+the target memory cache with a single request before unwinding.  This\n\
+saves a round trip for every cache line the unwinder touches, which\n\
+matters when backtracing many threads over a slow connection.\n\
+Zero, the default, disables read ahead."),
+			     NULL,
+			     show_stack_cache_prefetch,
+			     &setlist, &showlist);
+
   add_setshow_boolean_cmd ("code-cache", class_support,
 			   &code_cache_enabled_1, _("\
 Set cache use for code segment access."), _("\
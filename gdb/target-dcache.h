@@ -33,4 +33,10 @@ extern int stack_cache_enabled_p (void);
 
 extern int code_cache_enabled_p (void);
 
+/* Read ahead the stack of the current thread into the target dcache,
+   starting at stack pointer SP and growing in the direction of outer
+   frames as per GDBARCH, according to "set stack-cache-prefetch".  */
+
+extern void target_dcache_prefetch_stack (gdbarch *gdbarch, CORE_ADDR sp);
+
 #endif /* TARGET_DCACHE_H */
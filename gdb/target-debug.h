@@ -277,6 +277,11 @@ target_debug_print_gdb_array_view_const_int
   (const gdb::array_view<const int> &view)
 { return host_address_to_string (view.data ()); }
 
+static std::string
+target_debug_print_gdb_array_view_memory_read_range
+  (gdb::array_view<memory_read_range> ranges)
+{ return string_printf ("%zu ranges", ranges.size ()); }
+
 static std::string
 target_debug_print_record_print_flags (record_print_flags flags)
 { return plongest (flags); }
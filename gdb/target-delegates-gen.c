@@ -86,6 +86,7 @@ struct dummy_target : public target_ops
   void program_signals (gdb::array_view<const unsigned char> arg0) override;
   bool thread_alive (ptid_t arg0) override;
   void update_thread_list () override;
+  void prefetch_thread_registers () override;
   std::string pid_to_str (ptid_t arg0) override;
   const char *extra_thread_info (thread_info *arg0) override;
   const char *thread_name (thread_info *arg0) override;
@@ -116,6 +117,7 @@ struct dummy_target : public target_ops
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
   ULONGEST get_memory_xfer_limit () override;
+  bool read_memory_ranges (gdb::array_view<memory_read_range> arg0) override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
   void flash_done () override;
@@ -263,6 +265,7 @@ struct debug_target : public target_ops
   void program_signals (gdb::array_view<const unsigned char> arg0) override;
   bool thread_alive (ptid_t arg0) override;
   void update_thread_list () override;
+  void prefetch_thread_registers () override;
   std::string pid_to_str (ptid_t arg0) override;
   const char *extra_thread_info (thread_info *arg0) override;
   const char *thread_name (thread_info *arg0) override;
@@ -293,6 +296,7 @@ struct debug_target : public target_ops
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
   ULONGEST get_memory_xfer_limit () override;
+  bool read_memory_ranges (gdb::array_view<memory_read_range> arg0) override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
   void flash_done () override;
@@ -1716,6 +1720,26 @@ debug_target::update_thread_list ()
 	      this->beneath ()->shortname ());
 }
 
+void
+target_ops::prefetch_thread_registers ()
+{
+  this->beneath ()->prefetch_thread_registers ();
+}
+
+void
+dummy_target::prefetch_thread_registers ()
+{
+}
+
+void
+debug_target::prefetch_thread_registers ()
+{
+  target_debug_printf_nofunc ("-> %s->prefetch_thread_registers (...)", this->beneath ()->shortname ());
+  this->beneath ()->prefetch_thread_registers ();
+  target_debug_printf_nofunc ("<- %s->prefetch_thread_registers ()",
+	      this->beneath ()->shortname ());
+}
+
 std::string
 target_ops::pid_to_str (ptid_t arg0)
 {
@@ -2441,6 +2465,31 @@ debug_target::get_memory_xfer_limit ()
   return result;
 }
 
+bool
+target_ops::read_memory_ranges (gdb::array_view<memory_read_range> arg0)
+{
+  return this->beneath ()->read_memory_ranges (arg0);
+}
+
+bool
+dummy_target::read_memory_ranges (gdb::array_view<memory_read_range> arg0)
+{
+  return false;
+}
+
+bool
+debug_target::read_memory_ranges (gdb::array_view<memory_read_range> arg0)
+{
+  target_debug_printf_nofunc ("-> %s->read_memory_ranges (...)", this->beneath ()->shortname ());
+  bool result
+    = this->beneath ()->read_memory_ranges (arg0);
+  target_debug_printf_nofunc ("<- %s->read_memory_ranges (%s) = %s",
+	      this->beneath ()->shortname (),
+	      target_debug_print_gdb_array_view_memory_read_range (arg0).c_str (),
+	      target_debug_print_bool (result).c_str ());
+  return result;
+}
+
 std::vector<mem_region>
 target_ops::memory_map ()
 {
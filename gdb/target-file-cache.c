@@ -0,0 +1,507 @@
+/* Persistent cache of files read from the target's filesystem.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "target-file-cache.h"
+
+#include "build-id.h"
+#include "cli/cli-cmds.h"
+#include "command.h"
+#include "event-top.h"
+#include "filenames.h"
+#include "inferior.h"
+#include "target.h"
+#include "gdbsupport/byte-vector.h"
+#include "gdbsupport/filestuff.h"
+#include "gdbsupport/gdb_unlinker.h"
+#include "gdbsupport/pathstuff.h"
+#include "gdbsupport/scoped_fd.h"
+
+/* When set to true, show debug messages about the target file
+   cache.  */
+static bool debug_target_file_cache = false;
+
+#define target_file_cache_debug(FMT, ...)				\
+  debug_prefixed_printf_cond_nofunc (debug_target_file_cache,		\
+				     "target-file-cache", FMT, ## __VA_ARGS__)
+
+/* Whether the cache is enabled, for "set/show target-file-cache
+   enabled".  */
+static bool target_file_cache_enabled = false;
+
+/* The cache directory, for "set/show target-file-cache directory".  */
+static std::string target_file_cache_directory;
+
+/* Number of lookups that found, or missed, a copy in the cache.  */
+static unsigned int target_file_cache_hits;
+static unsigned int target_file_cache_misses;
+
+/* set/show target-file-cache commands.  */
+static cmd_list_element *set_target_file_cache_list;
+static cmd_list_element *show_target_file_cache_list;
+
+/* A BFD stream reading a copy of a target file from the cache.  */
+
+struct target_file_cache_stream : public gdb_bfd_iovec_base
+{
+  explicit target_file_cache_stream (scoped_fd fd)
+    : m_fd (std::move (fd))
+  {
+  }
+
+  file_ptr read (bfd *abfd, void *buffer, file_ptr nbytes,
+		 file_ptr offset) override
+  {
+    file_ptr pos = 0;
+
+    while (nbytes > pos)
+      {
+	ssize_t n;
+
+#ifdef HAVE_PREAD
+	n = pread (m_fd.get (), (gdb_byte *) buffer + pos, nbytes - pos,
+		   offset + pos);
+#else
+	n = lseek (m_fd.get (), offset + pos, SEEK_SET);
+	if (n != -1)
+	  n = ::read (m_fd.get (), (gdb_byte *) buffer + pos, nbytes - pos);
+#endif
+	if (n < 0 && errno == EINTR)
+	  continue;
+	if (n < 0)
+	  {
+	    bfd_set_error (bfd_error_system_call);
+	    return -1;
+	  }
+	if (n == 0)
+	  break;
+	pos += n;
+      }
+
+    return pos;
+  }
+
+  int stat (struct bfd *abfd, struct stat *sb) override
+  {
+    return fstat (m_fd.get (), sb);
+  }
+
+private:
+
+  /* The local copy.  */
+  scoped_fd m_fd;
+};
+
+/* Open FILENAME, the copy in the cache of the target file
+   TARGET_FILENAME (including the "target:" prefix), as a BFD of target
+   TARGET.  The BFD is named TARGET_FILENAME, as if it had been read
+   from the target, and only the data comes from the copy.  Return
+   NULL if there is no such file, or if its build-id isn't BUILD_ID, a
+   hex string.  */
+
+static gdb_bfd_ref_ptr
+target_file_cache_open_copy (const std::string &filename,
+			     const char *target_filename, const char *target,
+			     const std::string &build_id)
+{
+  scoped_fd fd = gdb_open_cloexec (filename, O_RDONLY | O_BINARY, 0);
+  if (fd.get () == -1)
+    return nullptr;
+
+  auto open = [&] (bfd *nbfd) -> gdb_bfd_iovec_base *
+    {
+      return new target_file_cache_stream (std::move (fd));
+    };
+  gdb_bfd_ref_ptr abfd = gdb_bfd_openr_iovec (target_filename, target, open);
+  if (abfd == nullptr || !bfd_check_format (abfd.get (), bfd_object))
+    return nullptr;
+
+  const bfd_build_id *copy_build_id = build_id_bfd_get (abfd.get ());
+  if (copy_build_id == nullptr
+      || build_id_to_string (copy_build_id) != build_id)
+    {
+      target_file_cache_debug ("%s does not have build-id %s",
+			       filename.c_str (), build_id.c_str ());
+      return nullptr;
+    }
+
+  return abfd;
+}
+
+/* Return the name of the index file recording which copy in the cache
+   is of TARGET_FILENAME, an absolute file name on the target's
+   filesystem, or an empty string if that name can't be used in the
+   cache directory.  */
+
+static std::string
+target_file_cache_index_name (const char *target_filename)
+{
+  if (!IS_DIR_SEPARATOR (target_filename[0])
+      || strstr (target_filename, "/../") != nullptr
+      || strstr (target_filename, "/./") != nullptr)
+    return {};
+
+  return (target_file_cache_directory + SLASH_STRING + "by-name"
+	  + target_filename);
+}
+
+/* Record in the index that the copy of TARGET_FILENAME in the cache is
+   the one with build-id BUILD_ID, and that the file on the target had
+   the size and modification time in ST when copied.  */
+
+static void
+target_file_cache_write_index (const char *target_filename,
+			       const std::string &build_id,
+			       const struct stat &st)
+{
+  std::string index_name = target_file_cache_index_name (target_filename);
+  if (index_name.empty ())
+    return;
+
+  std::string dir = ldirname (index_name.c_str ());
+  if (!mkdir_recursive (dir.c_str ()))
+    return;
+
+  std::string temp_name = string_printf ("%s.%ld.tmp", index_name.c_str (),
+					 (long) getpid ());
+  gdb_file_up file = gdb_fopen_cloexec (temp_name, "w");
+  if (file == nullptr)
+    return;
+  gdb::unlinker unlink_temp (temp_name.c_str ());
+
+  fprintf (file.get (), "%s %lld %lld\n", build_id.c_str (),
+	   (long long) st.st_size, (long long) st.st_mtime);
+  if (fclose (file.release ()) != 0
+      || rename (temp_name.c_str (), index_name.c_str ()) != 0)
+    return;
+  unlink_temp.keep ();
+}
+
+/* Return true if the file TARGET_FILENAME on the target's filesystem
+   has the same build-id note as COPY, the copy of it in the cache.
+   Besides opening and closing the file, this costs a single read from
+   the target.  */
+
+static bool
+target_file_cache_same_build_id (const char *target_filename, bfd *copy)
+{
+  asection *sect = bfd_get_section_by_name (copy, ".note.gnu.build-id");
+  if (sect == nullptr || bfd_section_size (sect) == 0)
+    return false;
+
+  bfd_size_type size = bfd_section_size (sect);
+  gdb::byte_vector copy_note (size);
+  if (!bfd_get_section_contents (copy, sect, copy_note.data (), 0, size))
+    return false;
+
+  fileio_error target_errno;
+  scoped_target_fd fd (target_fileio_open (current_inferior (),
+					   target_filename, FILEIO_O_RDONLY,
+					   0, false, &target_errno));
+  if (fd.get () == -1)
+    return false;
+
+  gdb::byte_vector target_note (size);
+  int n = target_fileio_pread (fd.get (), target_note.data (), size,
+			       sect->filepos, &target_errno);
+  return n >= 0 && (bfd_size_type) n == size && target_note == copy_note;
+}
+
+/* Copy TARGET_FILENAME, on the target's filesystem, to FILENAME.
+   Return true on success.  */
+
+static bool
+target_file_cache_copy (const char *target_filename,
+			const std::string &filename)
+{
+  fileio_error target_errno;
+  scoped_target_fd fd (target_fileio_open (current_inferior (),
+					   target_filename, FILEIO_O_RDONLY,
+					   0, false, &target_errno));
+  if (fd.get () == -1)
+    {
+      target_file_cache_debug ("could not open %s on the target",
+			       target_filename);
+      return false;
+    }
+
+  /* Write to a temporary file and rename it into place at the end, so
+     that nobody ever sees a partial copy.  */
+  std::string temp_filename = string_printf ("%s.%ld.tmp", filename.c_str (),
+					     (long) getpid ());
+  gdb_file_up file = gdb_fopen_cloexec (temp_filename, "wb");
+  if (file == nullptr)
+    {
+      warning (_("target file cache: could not create %s: %s"),
+	       temp_filename.c_str (), safe_strerror (errno));
+      return false;
+    }
+  gdb::unlinker unlink_temp (temp_filename.c_str ());
+
+  /* Read in large chunks; the target reads ahead when it sees a file
+     being read sequentially.  */
+  gdb::byte_vector buf (1024 * 1024);
+  ULONGEST offset = 0;
+  while (true)
+    {
+      int n = target_fileio_pread (fd.get (), buf.data (), buf.size (),
+				   offset, &target_errno);
+      if (n < 0)
+	{
+	  target_file_cache_debug ("could not read %s on the target",
+				   target_filename);
+	  return false;
+	}
+      if (n == 0)
+	break;
+
+      if (fwrite (buf.data (), 1, n, file.get ()) != (size_t) n)
+	{
+	  warning (_("target file cache: could not write %s: %s"),
+		   temp_filename.c_str (), safe_strerror (errno));
+	  return false;
+	}
+
+      offset += n;
+      QUIT;
+    }
+
+  if (fclose (file.release ()) != 0
+      || rename (temp_filename.c_str (), filename.c_str ()) != 0)
+    {
+      warning (_("target file cache: could not write %s: %s"),
+	       filename.c_str (), safe_strerror (errno));
+      return false;
+    }
+  unlink_temp.keep ();
+
+  target_file_cache_debug ("copied %s to %s (%s bytes)", target_filename,
+			   filename.c_str (), pulongest (offset));
+  return true;
+}
+
+/* See target-file-cache.h.  */
+
+gdb_bfd_ref_ptr
+target_file_cache_lookup (const char *filename, const char *target)
+{
+  if (!target_file_cache_enabled || target_file_cache_directory.empty ())
+    return nullptr;
+
+  gdb_assert (is_target_filename (filename));
+  const char *target_filename = filename + strlen (TARGET_SYSROOT_PREFIX);
+
+  std::string index_name = target_file_cache_index_name (target_filename);
+  if (index_name.empty ())
+    return nullptr;
+
+  std::optional<std::string> index
+    = read_text_file_to_string (index_name.c_str ());
+  if (!index.has_value ())
+    return nullptr;
+
+  char build_id[256];
+  long long size, mtime;
+  if (sscanf (index->c_str (), "%255[0-9a-f] %lld %lld",
+	      build_id, &size, &mtime) != 3)
+    return nullptr;
+
+  /* Check that the file on the target is still the one that was
+     copied.  A change of size or modification time is found with a
+     single request.  */
+  struct stat st;
+  fileio_error target_errno;
+  if (target_fileio_stat (current_inferior (), target_filename, &st,
+			  &target_errno) != 0
+      || st.st_size != size || st.st_mtime != mtime)
+    {
+      target_file_cache_debug ("%s changed on the target", target_filename);
+      return nullptr;
+    }
+
+  gdb_bfd_ref_ptr copy
+    = target_file_cache_open_copy (target_file_cache_directory
+				   + SLASH_STRING + build_id,
+				   filename, target, build_id);
+  if (copy == nullptr)
+    return nullptr;
+
+  /* The modification time only has a resolution of a second, so also
+     compare the build-id note of the file on the target with the
+     copy's.  */
+  if (!target_file_cache_same_build_id (target_filename, copy.get ()))
+    {
+      target_file_cache_debug ("%s does not have build-id %s on the target",
+			       target_filename, build_id);
+      return nullptr;
+    }
+
+  target_file_cache_debug ("using copy %s for %s", build_id,
+			   target_filename);
+  target_file_cache_hits++;
+  return copy;
+}
+
+/* See target-file-cache.h.  */
+
+gdb_bfd_ref_ptr
+target_file_cache_open (bfd *abfd)
+{
+  if (!target_file_cache_enabled)
+    return nullptr;
+
+  const char *filename = bfd_get_filename (abfd);
+  gdb_assert (is_target_filename (filename));
+  const char *target_filename = filename + strlen (TARGET_SYSROOT_PREFIX);
+
+  const bfd_build_id *bfd_build_id = build_id_bfd_get (abfd);
+  if (bfd_build_id == nullptr)
+    {
+      target_file_cache_debug ("%s has no build id", target_filename);
+      return nullptr;
+    }
+
+  if (target_file_cache_directory.empty ())
+    {
+      warning (_("The target file cache directory name is empty, "
+		 "skipping cache lookup."));
+      return nullptr;
+    }
+
+  std::string build_id = build_id_to_string (bfd_build_id);
+  std::string copy_name = (target_file_cache_directory + SLASH_STRING
+			   + build_id);
+  const char *target = bfd_get_target (abfd);
+
+  /* Remember the size and modification time of the file on the target,
+     so that target_file_cache_lookup can find the copy next time
+     without opening the file.  Stubs that can't stat a file by name
+     just don't get that shortcut.  */
+  struct stat st;
+  fileio_error target_errno;
+  bool have_stat = target_fileio_stat (current_inferior (), target_filename,
+				       &st, &target_errno) == 0;
+
+  gdb_bfd_ref_ptr copy
+    = target_file_cache_open_copy (copy_name, filename, target, build_id);
+  if (copy != nullptr)
+    {
+      target_file_cache_debug ("using copy %s for %s", build_id.c_str (),
+			       target_filename);
+      target_file_cache_hits++;
+    }
+  else
+    {
+      target_file_cache_misses++;
+
+      if (!mkdir_recursive (target_file_cache_directory.c_str ()))
+	{
+	  warning (_("target file cache: could not make cache directory: %s"),
+		   safe_strerror (errno));
+	  return nullptr;
+	}
+
+      if (!target_file_cache_copy (target_filename, copy_name))
+	return nullptr;
+
+      copy = target_file_cache_open_copy (copy_name, filename, target,
+					  build_id);
+      if (copy == nullptr)
+	return nullptr;
+    }
+
+  if (have_stat)
+    target_file_cache_write_index (target_filename, build_id, st);
+
+  return copy;
+}
+
+/* "set target-file-cache directory" handler.  */
+
+static void
+set_target_file_cache_directory_command (const char *arg, int from_tty,
+					 cmd_list_element *element)
+{
+  /* Make sure the cache directory is absolute and tilde-expanded.  */
+  target_file_cache_directory = gdb_abspath (target_file_cache_directory);
+}
+
+/* "show target-file-cache stats" handler.  */
+
+static void
+show_target_file_cache_stats_command (const char *arg, int from_tty)
+{
+  gdb_printf (_("  Cache hits (this session): %u\n"),
+	      target_file_cache_hits);
+  gdb_printf (_("Cache misses (this session): %u\n"),
+	      target_file_cache_misses);
+}
+
+void _initialize_target_file_cache ();
+void
+_initialize_target_file_cache ()
+{
+  /* Set the default cache directory.  */
+  std::string cache_dir = get_standard_cache_dir ();
+  if (!cache_dir.empty ())
+    target_file_cache_directory = cache_dir + SLASH_STRING + "target-files";
+
+  add_setshow_prefix_cmd ("target-file-cache", class_files,
+			  _("\
+Set options for the cache of files read from the target."),
+			  _("\
+Show options for the cache of files read from the target."),
+			  &set_target_file_cache_list,
+			  &show_target_file_cache_list,
+			  &setlist, &showlist);
+
+  add_setshow_boolean_cmd ("enabled", class_files,
+			   &target_file_cache_enabled,
+			   _("Enable the target file cache."),
+			   _("Show whether the target file cache is enabled."),
+			   _("\
+When on, shared libraries read from the target's filesystem (with a sysroot\n\
+of \"target:\") are copied to a local cache directory, indexed by build-id.\n\
+Later sessions then use the local copy instead of transferring the file\n\
+again."),
+			   NULL, NULL,
+			   &set_target_file_cache_list,
+			   &show_target_file_cache_list);
+
+  add_setshow_filename_cmd ("directory", class_files,
+			    &target_file_cache_directory,
+			    _("Set the directory of the target file cache."),
+			    _("Show the directory of the target file cache."),
+			    NULL,
+			    set_target_file_cache_directory_command, NULL,
+			    &set_target_file_cache_list,
+			    &show_target_file_cache_list);
+
+  add_cmd ("stats", class_files, show_target_file_cache_stats_command,
+	   _("Show some stats about the target file cache."),
+	   &show_target_file_cache_list);
+
+  add_setshow_boolean_cmd ("target-file-cache", class_maintenance,
+			   &debug_target_file_cache,
+			   _("Set display of target file cache debug messages."),
+			   _("Show display of target file cache debug messages."),
+			   _("\
+When on, debugging output for the target file cache is displayed."),
+			   NULL, NULL,
+			   &setdebuglist, &showdebuglist);
+}
@@ -0,0 +1,46 @@
+/* Persistent cache of files read from the target's filesystem.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef TARGET_FILE_CACHE_H
+#define TARGET_FILE_CACHE_H
+
+#include "gdb_bfd.h"
+
+/* FILENAME is the name of an object file on the target's filesystem,
+   with a "target:" prefix.  If the target file cache is enabled and
+   holds a copy of that file which is still current, return a BFD of
+   target TARGET reading that copy.  This is checked without opening
+   the file on the target.  Otherwise, return NULL.
+
+   BFDs returned by this and target_file_cache_open are named after the
+   file on the target, so they can be used as if read from there.  */
+
+extern gdb_bfd_ref_ptr target_file_cache_lookup (const char *filename,
+						 const char *target);
+
+/* ABFD is an object file opened from the target's filesystem, i.e.
+   with a "target:" file name.  If the target file cache is enabled and
+   ABFD has a build-id, return a BFD reading the local copy of the file
+   in the cache, copying the file from the target first if the cache
+   does not have it yet.  Otherwise, or if anything goes wrong, return
+   NULL.  */
+
+extern gdb_bfd_ref_ptr target_file_cache_open (bfd *abfd);
+
+#endif /* TARGET_FILE_CACHE_H */
@@ -814,6 +814,14 @@ target_is_address_tagged (gdbarch *gdbarch, CORE_ADDR address)
   return current_inferior ()->top_target ()->is_address_tagged (gdbarch, address);
 }
 
+/* See target.h.  */
+
+bool
+target_read_memory_ranges (gdb::array_view<memory_read_range> ranges)
+{
+  return current_inferior ()->top_target ()->read_memory_ranges (ranges);
+}
+
 x86_xsave_layout
 target_fetch_x86_xsave_layout ()
 {
@@ -3419,37 +3427,6 @@ target_fileio_readlink (struct inferior *inf, const char *filename,
   return {};
 }
 
-/* Like scoped_fd, but specific to target fileio.  */
-
-class scoped_target_fd
-{
-public:
-  explicit scoped_target_fd (int fd) noexcept
-    : m_fd (fd)
-  {
-  }
-
-  ~scoped_target_fd ()
-  {
-    if (m_fd >= 0)
-      {
-	fileio_error target_errno;
-
-	target_fileio_close (m_fd, &target_errno);
-      }
-  }
-
-  DISABLE_COPY_AND_ASSIGN (scoped_target_fd);
-
-  int get () const noexcept
-  {
-    return m_fd;
-  }
-
-private:
-  int m_fd;
-};
-
 /* Read target file FILENAME, in the filesystem as seen by INF.  If
    INF is NULL, use the filesystem seen by the debugger (GDB or, for
    remote targets, the remote stub).  Store the result in *BUF_P and
@@ -3757,6 +3734,14 @@ target_update_thread_list (void)
   current_inferior ()->top_target ()->update_thread_list ();
 }
 
+/* See target.h.  */
+
+void
+target_prefetch_thread_registers ()
+{
+  current_inferior ()->top_target ()->prefetch_thread_registers ();
+}
+
 void
 target_stop (ptid_t ptid)
 {
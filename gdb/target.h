@@ -300,6 +300,21 @@ struct memory_read_result
 extern std::vector<memory_read_result> read_memory_robust
     (struct target_ops *ops, const ULONGEST offset, const LONGEST len);
 
+/* One of the ranges read by target_read_memory_ranges.  */
+
+struct memory_read_range
+{
+  /* The address and length of the range.  */
+  CORE_ADDR addr;
+  ULONGEST len;
+
+  /* Where to store the contents of the range.  */
+  gdb_byte *buf;
+
+  /* Set to the number of bytes read from the start of the range.  */
+  ULONGEST xfered_len = 0;
+};
+
 /* Request that OPS transfer up to LEN addressable units from BUF to the
    target's OBJECT.  When writing to a memory object, the addressable unit
    size is architecture dependent and can be found using
@@ -696,6 +711,12 @@ struct target_ops
       TARGET_DEFAULT_RETURN (false);
     virtual void update_thread_list ()
       TARGET_DEFAULT_IGNORE ();
+
+    /* Fetch the general purpose registers of all stopped threads of the
+       current inferior into their register caches, ahead of a command
+       that reads them for every thread.  */
+    virtual void prefetch_thread_registers ()
+      TARGET_DEFAULT_IGNORE ();
     virtual std::string pid_to_str (ptid_t)
       TARGET_DEFAULT_FUNC (default_pid_to_str);
     virtual const char *extra_thread_info (thread_info *)
@@ -849,6 +870,15 @@ struct target_ops
     virtual ULONGEST get_memory_xfer_limit ()
       TARGET_DEFAULT_RETURN (ULONGEST_MAX);
 
+    /* Read the raw memory of each of RANGES, using as few requests to
+       the target as possible, and set each range's XFERED_LEN to the
+       number of bytes read from its start.  Returns false if the target
+       has no way to read several ranges at once; the caller should then
+       read the ranges one by one.  If RANGES is empty, nothing is sent
+       to the target and the return value only tells whether it can.  */
+    virtual bool read_memory_ranges (gdb::array_view<memory_read_range> ranges)
+      TARGET_DEFAULT_RETURN (false);
+
     /* Returns the memory map for the target.  A return value of NULL
        means that no memory map is available.  If a memory address
        does not fall within any returned regions, it's assumed to be
@@ -1849,6 +1879,11 @@ extern int target_thread_alive (ptid_t ptid);
 
 extern void target_update_thread_list (void);
 
+/* Fetch the general purpose registers of all stopped threads of the
+   current inferior, ahead of reading them for every thread.  */
+
+extern void target_prefetch_thread_registers ();
+
 /* Make target stop in a continuable fashion.  (For instance, under
    Unix, this should act like SIGSTOP).  Note that this function is
    asynchronous: it does not wait for the target to become stopped
@@ -2240,6 +2275,37 @@ extern int target_fileio_stat (struct inferior *inf, const char *filename,
    (and set *TARGET_ERRNO).  */
 extern int target_fileio_close (int fd, fileio_error *target_errno);
 
+/* Like scoped_fd, but specific to target fileio.  */
+
+class scoped_target_fd
+{
+public:
+  explicit scoped_target_fd (int fd) noexcept
+    : m_fd (fd)
+  {
+  }
+
+  ~scoped_target_fd ()
+  {
+    if (m_fd >= 0)
+      {
+	fileio_error target_errno;
+
+	target_fileio_close (m_fd, &target_errno);
+      }
+  }
+
+  DISABLE_COPY_AND_ASSIGN (scoped_target_fd);
+
+  int get () const noexcept
+  {
+    return m_fd;
+  }
+
+private:
+  int m_fd;
+};
+
 /* Unlink FILENAME on the target, in the filesystem as seen by INF.
    If INF is NULL, use the filesystem seen by the debugger (GDB or,
    for remote targets, the remote stub).  Return 0, or -1 if an error
@@ -2368,6 +2434,12 @@ extern bool target_is_address_tagged (gdbarch *gdbarch, CORE_ADDR address);
 
 extern x86_xsave_layout target_fetch_x86_xsave_layout ();
 
+/* Read the raw memory of each of RANGES using the current inferior's
+   target stack.  See target_ops::read_memory_ranges.  */
+
+extern bool target_read_memory_ranges
+  (gdb::array_view<memory_read_range> ranges);
+
 /* Command logging facility.  */
 
 extern void target_log_command (const char *p);
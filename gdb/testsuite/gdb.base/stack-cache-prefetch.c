@@ -0,0 +1,43 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+void
+breakpt (void)
+{
+  /* Nothing.  */
+}
+
+int
+func (int depth)
+{
+  /* A large frame, so that reading ahead the stack has plenty of
+     lines to fill that the unwinder never touches.  */
+  volatile char buf[65536];
+
+  buf[0] = depth;
+  if (depth == 0)
+    breakpt ();
+  else
+    func (depth - 1);
+  return buf[0];
+}
+
+int
+main (void)
+{
+  return func (2);
+}
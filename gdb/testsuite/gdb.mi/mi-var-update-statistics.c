@@ -0,0 +1,34 @@
+/* Copyright 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+struct data
+{
+  int count;
+  int values[4];
+  const char *name;
+};
+
+struct data global_data = { 1, { 10, 20, 30, 40 }, "data" };
+
+int
+main (void)
+{
+  global_data.count = 2;	/* First stop.  */
+  global_data.count = 3;	/* Second stop.  */
+  global_data.values[2] = 33;	/* Third stop.  */
+  return 0;			/* Fourth stop.  */
+}
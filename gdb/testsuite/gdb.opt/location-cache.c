@@ -0,0 +1,52 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+volatile int global_counter = 3;
+
+static void __attribute__ ((noinline))
+breakpt (void)
+{
+  asm ("" ::: "memory");
+}
+
+static int __attribute__ ((noinline))
+compute (int n, int *array)
+{
+  int sum = 0;
+  int prod = 1;
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      sum += array[i];
+      prod *= array[i] | 1;
+      if (i == n / 2)
+	breakpt ();	/* Inside the loop.  */
+    }
+
+  return sum + prod + global_counter;
+}
+
+int
+main (void)
+{
+  int array[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  int result;
+
+  result = compute (global_counter + 5, array);
+  return result == 0;
+}
@@ -0,0 +1,37 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+unsigned char buf[BUF_SIZE];
+
+static void
+breakpt (void)
+{
+}
+
+int
+main (void)
+{
+  unsigned int i;
+
+  /* Something between the zeroes of freshly allocated memory and
+     random data: runs of zeroes with hashed bytes in between.  */
+  for (i = 0; i < sizeof (buf); i++)
+    buf[i] = (i % 61) < 40 ? 0 : (i * 2654435761u) >> 24;
+
+  breakpt ();
+  return 0;
+}
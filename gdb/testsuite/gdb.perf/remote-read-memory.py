@@ -0,0 +1,38 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+from perftest import perftest
+
+
+class RemoteReadMemory(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, size):
+        super(RemoteReadMemory, self).__init__("remote-read-memory")
+        self.size = size
+        self.addr = int(gdb.parse_and_eval("&buf").cast(gdb.lookup_type("long")))
+
+    def _read(self, count):
+        inferior = gdb.selected_inferior()
+        for _ in range(0, count):
+            # Make sure every read goes to the target.
+            gdb.execute("maint flush dcache", False, True)
+            inferior.read_memory(self.addr, self.size)
+
+    def warm_up(self):
+        self._read(1)
+
+    def execute_test(self):
+        for i in range(1, 5):
+            func = lambda: self._read(i)
+            self.measure.measure(func, i * self.size)
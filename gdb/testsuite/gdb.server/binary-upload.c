@@ -0,0 +1,35 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+
+/* Holds every byte value, including those that must be escaped in the
+   binary reply of the 'x' packet.  */
+unsigned char buf[4096];
+
+static void
+breakpt (void)
+{
+}
+
+int
+main ()
+{
+  int i;
+
+  for (i = 0; i < sizeof (buf); i++)
+    buf[i] = i;
+
+  breakpt ();	/* After buf is filled.  */
+  return 0;
+}
@@ -0,0 +1,65 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <unistd.h>
+
+#define NTHREADS 4
+
+static pthread_barrier_t barrier;
+
+static void *
+thread_func (void *arg)
+{
+  pthread_barrier_wait (&barrier);
+  sleep (300);
+  return arg;
+}
+
+static void *
+short_thread_func (void *arg)
+{
+  return arg;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+  pthread_t short_thread;
+  int i;
+
+  pthread_barrier_init (&barrier, NULL, NTHREADS + 1);
+
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_func, NULL);
+
+  pthread_barrier_wait (&barrier);	/* All threads started.  */
+
+  pthread_setname_np (pthread_self (), "renamed");
+
+  pthread_create (&short_thread, NULL, short_thread_func, NULL);
+  pthread_join (short_thread, NULL);
+
+  pthread_cancel (threads[0]);	/* Short thread exited.  */
+  pthread_join (threads[0], NULL);
+  pthread_cancel (threads[1]);
+  pthread_join (threads[1], NULL);
+
+  return 0;	/* Two threads exited.  */
+}
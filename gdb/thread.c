@@ -1190,6 +1190,22 @@ print_thread (ui_out *uiout, const char *requested_threads,
 			   default_inf_num, tp, current_thread);
 }
 
+/* Ask the targets of all inferiors to fetch the registers of their
+   stopped threads at once, ahead of a command that reads them for
+   every thread.  */
+
+static void
+prefetch_thread_registers ()
+{
+  scoped_restore_current_thread restore_thread;
+
+  for (inferior *inf : all_non_exited_inferiors ())
+    {
+      switch_to_inferior_no_thread (inf);
+      target_prefetch_thread_registers ();
+    }
+}
+
 /* Like print_thread_info, but in addition, GLOBAL_IDS indicates
    whether REQUESTED_THREADS is a list of global or per-inferior
    thread ids.  */
@@ -1203,6 +1219,10 @@ print_thread_info_1 (struct ui_out *uiout, const char *requested_threads,
 
   update_thread_list ();
 
+  if ((requested_threads == NULL || *requested_threads == '\0')
+      && pid == -1)
+    prefetch_thread_registers ();
+
   /* Whether we saw any thread.  */
   bool any_thread = false;
   /* Whether the current thread is exited.  */
@@ -1701,6 +1721,7 @@ thread_apply_all_command (const char *cmd, int from_tty)
     error (_("Please specify a command at the end of 'thread apply all'"));
 
   update_thread_list ();
+  prefetch_thread_registers ();
 
   int tc = live_threads_count ();
   if (tc != 0)
@@ -32,6 +32,7 @@
 #include "gdbarch.h"
 #include <algorithm>
 #include "observable.h"
+#include "gdbsupport/scope-exit.h"
 
 #if HAVE_PYTHON
 #include "python/python.h"
@@ -110,6 +111,18 @@ struct varobj_root
 
   /* The varobj for this root node.  */
   struct varobj *rootvar = NULL;
+
+  /* The contents of the root variable, if it is in memory, at the last
+     update, and what they were printed with.  If the contents didn't
+     change since, and the values of the children were all taken from
+     them, the children are unchanged too.  See
+     update_root_contents.  */
+  bool contents_valid = false;
+  gdb::byte_vector contents;
+  CORE_ADDR contents_address = 0;
+  struct type *contents_type = nullptr;
+  const struct language_defn *contents_language = nullptr;
+  value_print_options contents_print_options {};
 };
 
 /* Dynamic part of varobj.  */
@@ -200,6 +213,13 @@ static std::list<struct varobj_root *> rootlist;
 /* Pointer to the varobj hash table (built at run time).  */
 static htab_t varobj_table;
 
+/* Statistics about varobj_update.  */
+static varobj_update_statistics update_statistics;
+
+/* The largest root variable that update_root_contents reads in one go
+   and keeps a copy of.  */
+static const ULONGEST max_root_contents_size = 65536;
+
 
 
 /* API Implementation */
@@ -1433,6 +1453,168 @@ varobj_value_has_mutated (const struct varobj *var, struct value *new_value,
     return false;
 }
 
+/* Return true if the values of the descendants of VAR that are not
+   frozen were all taken from the LENGTH bytes of memory at ADDRESS,
+   so that they can't have changed if those bytes didn't.  Add the
+   number of those descendants to *COUNT.  */
+
+static bool
+varobj_children_within (const struct varobj *var, CORE_ADDR address,
+			ULONGEST length, ULONGEST *count)
+{
+  for (const varobj *child : var->children)
+    {
+      /* Frozen children are not updated anyway.  */
+      if (child == NULL || child->frozen)
+	continue;
+
+      ++*count;
+      if (child->updated || varobj_is_dynamic_p (child))
+	return false;
+
+      /* C++ fake children (public/protected/private) have no value.  */
+      if (!CPLUS_FAKE_CHILD (child))
+	{
+	  value *val = child->value.get ();
+
+	  if (val == NULL || val->lazy () || val->lval () != lval_memory)
+	    return false;
+
+	  CORE_ADDR child_address = val->address ();
+	  ULONGEST child_length = check_typedef (val->type ())->length ();
+	  if (child_address < address
+	      || child_address - address > length
+	      || child_length > length - (child_address - address))
+	    return false;
+	}
+
+      if (!varobj_children_within (child, address, length, count))
+	return false;
+    }
+
+  return true;
+}
+
+/* Return true if A and B print values the same way.  */
+
+static bool
+print_options_equal (const value_print_options &a,
+		     const value_print_options &b)
+{
+  return (a.prettyformat == b.prettyformat
+	  && a.prettyformat_arrays == b.prettyformat_arrays
+	  && a.prettyformat_structs == b.prettyformat_structs
+	  && a.vtblprint == b.vtblprint
+	  && a.unionprint == b.unionprint
+	  && a.addressprint == b.addressprint
+	  && a.nibblesprint == b.nibblesprint
+	  && a.objectprint == b.objectprint
+	  && a.print_max == b.print_max
+	  && a.print_max_chars == b.print_max_chars
+	  && a.repeat_count_threshold == b.repeat_count_threshold
+	  && a.output_format == b.output_format
+	  && a.format == b.format
+	  && a.memory_tag_violations == b.memory_tag_violations
+	  && a.stop_print_at_null == b.stop_print_at_null
+	  && a.print_array_indexes == b.print_array_indexes
+	  && a.deref_ref == b.deref_ref
+	  && a.static_field_print == b.static_field_print
+	  && a.pascal_static_field_print == b.pascal_static_field_print
+	  && a.raw == b.raw
+	  && a.summary == b.summary
+	  && a.symbol_print == b.symbol_print
+	  && a.max_depth == b.max_depth);
+}
+
+/* The root variable object VAR has just been given a new value.  If
+   it is in memory and has children, read all its contents at once,
+   so that its children are computed from them rather than read one
+   by one, and compare them with the contents at the previous update.
+   Return true if neither the contents nor how they are printed
+   changed, and all the children were computed from the contents, so
+   that the children don't need updating.  Store the number of
+   children that can be skipped in *SKIPPED then.  */
+
+static bool
+update_root_contents (struct varobj *var, ULONGEST *skipped)
+{
+  varobj_root *root = var->root;
+  bool had_contents = root->contents_valid;
+
+  root->contents_valid = false;
+
+  value *val = var->value.get ();
+  if (val == NULL
+      || var->children.empty ()
+      || varobj_is_dynamic_p (var)
+      || val->lval () != lval_memory)
+    return false;
+
+  ULONGEST length = check_typedef (val->type ())->length ();
+  if (length == 0 || length > max_root_contents_size)
+    return false;
+
+  if (val->lazy ())
+    {
+      try
+	{
+	  val->fetch_lazy ();
+	}
+      catch (const gdb_exception_error &except)
+	{
+	  return false;
+	}
+      update_statistics.bytes_read += length;
+    }
+
+  if (!val->entirely_available ()
+      || val->bits_any_optimized_out (0, TARGET_CHAR_BIT * length))
+    return false;
+
+  CORE_ADDR address = val->address ();
+  gdb::array_view<const gdb_byte> contents = val->contents_for_printing ();
+  bool unchanged
+    = (had_contents
+       && address == root->contents_address
+       && val->type () == root->contents_type
+       && current_language == root->contents_language
+       && print_options_equal (user_print_options,
+			       root->contents_print_options)
+       && contents.size () == root->contents.size ()
+       && std::equal (contents.begin (), contents.end (),
+		      root->contents.begin ()));
+
+  ULONGEST count = 0;
+  if (unchanged && !varobj_children_within (var, address, length, &count))
+    unchanged = false;
+
+  root->contents.assign (contents.begin (), contents.end ());
+  root->contents_address = address;
+  root->contents_type = val->type ();
+  root->contents_language = current_language;
+  root->contents_print_options = user_print_options;
+  root->contents_valid = true;
+
+  *skipped = count;
+  return unchanged;
+}
+
+/* See varobj.h.  */
+
+const varobj_update_statistics &
+varobj_get_update_statistics ()
+{
+  return update_statistics;
+}
+
+/* See varobj.h.  */
+
+void
+varobj_reset_update_statistics ()
+{
+  update_statistics = {};
+}
+
 /* Update the values for a variable and its children.  This is a
    two-pronged attack.  First, re-parse the value for the root's
    expression to see if it's changed.  Then go all the way
@@ -1456,6 +1638,13 @@ varobj_update (struct varobj **varp, bool is_explicit)
   std::vector<varobj_update_result> stack;
   std::vector<varobj_update_result> result;
 
+  auto start = std::chrono::steady_clock::now ();
+  SCOPE_EXIT
+    {
+      update_statistics.time += std::chrono::steady_clock::now () - start;
+    };
+  update_statistics.updates++;
+
   /* Frozen means frozen -- we don't check for any change in
      this varobj, including its going out of scope, or
      changing type.  One use case for frozen varobjs is
@@ -1486,6 +1675,7 @@ varobj_update (struct varobj **varp, bool is_explicit)
       r.type_changed = type_changed;
       if (install_new_value ((*varp), newobj, type_changed))
 	r.changed = true;
+      update_statistics.varobjs_updated++;
       
       if (newobj == NULL)
 	r.status = VAROBJ_NOT_IN_SCOPE;
@@ -1493,12 +1683,27 @@ varobj_update (struct varobj **varp, bool is_explicit)
 
       if (r.status == VAROBJ_NOT_IN_SCOPE)
 	{
+	  (*varp)->root->contents_valid = false;
 	  if (r.type_changed || r.changed)
 	    result.push_back (std::move (r));
 
 	  return result;
 	}
 
+      /* If the memory of the variable didn't change, neither did its
+	 children, so there is no need to recompute and print them
+	 again.  */
+      ULONGEST skipped;
+      if (update_root_contents (*varp, &skipped) && !r.type_changed)
+	{
+	  update_statistics.roots_unchanged++;
+	  update_statistics.varobjs_skipped += skipped;
+	  if (r.changed)
+	    result.push_back (std::move (r));
+
+	  return result;
+	}
+
       stack.push_back (std::move (r));
     }
   else
@@ -1542,6 +1747,7 @@ varobj_update (struct varobj **varp, bool is_explicit)
 	      r.changed = true;
 	      v->updated = false;
 	    }
+	  update_statistics.varobjs_updated++;
 	}
 
       /* We probably should not get children of a dynamic varobj, but
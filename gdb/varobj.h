@@ -20,6 +20,7 @@
 #include "symtab.h"
 #include "gdbtypes.h"
 #include "value.h"
+#include <chrono>
 
 /* Enumeration for the format types */
 enum varobj_display_formats
@@ -314,6 +315,35 @@ extern void all_root_varobjs (gdb::function_view<void (struct varobj *var)>);
 extern std::vector<varobj_update_result>
   varobj_update (struct varobj **varp, bool is_explicit);
 
+/* Statistics about the cost of varobj_update, reported by the
+   -var-info-update-statistics MI command.  */
+
+struct varobj_update_statistics
+{
+  /* Number of calls to varobj_update.  */
+  ULONGEST updates = 0;
+
+  /* Number of variable objects whose value was recomputed.  */
+  ULONGEST varobjs_updated = 0;
+
+  /* Number of root variable objects whose contents were unchanged, so
+     that their children were not updated, and the number of children
+     skipped that way.  */
+  ULONGEST roots_unchanged = 0;
+  ULONGEST varobjs_skipped = 0;
+
+  /* Number of bytes read to get the contents of root variable
+     objects.  */
+  ULONGEST bytes_read = 0;
+
+  /* Total time spent in varobj_update.  */
+  std::chrono::steady_clock::duration time {};
+};
+
+extern const varobj_update_statistics &varobj_get_update_statistics ();
+
+extern void varobj_reset_update_statistics ();
+
 /* Try to recreate any global or floating varobj.  This is called after
    changing symbol files.  */
 
@@ -20,6 +20,14 @@
 #include "gdbsupport/format.h"
 #include "tracepoint.h"
 #include "gdbsupport/rsp-low.h"
+#include "gdbsupport/scope-exit.h"
+#include "gdbsupport/scoped_restore.h"
+#ifndef IN_PROCESS_AGENT
+#include <unordered_map>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#endif
 
 static void ax_vdebug (const char *, ...) ATTRIBUTE_PRINTF (1, 2);
 
@@ -142,6 +150,48 @@ CORE_ADDR current_insn_ptr;
 
 int emit_error;
 
+int emit_host_code;
+
+/* Buffer holding the native code compiled to run inside GDBserver
+   itself.  Code is never released; once the buffer is full, further
+   expressions are left to the interpreter.  */
+
+#define HOST_CODE_BUFFER_SIZE (64 * 1024)
+
+static unsigned char *host_code_buffer;
+static size_t host_code_used;
+
+/* Return the code generator to use: the one producing code for the
+   inferior, or the one producing code for GDBserver itself.  */
+
+static struct emit_ops *
+current_emit_ops ()
+{
+  return emit_host_code ? target_host_emit_ops () : target_emit_ops ();
+}
+
+/* See ax.h.  */
+
+void
+write_emitted_code (CORE_ADDR to, const unsigned char *buf, size_t len)
+{
+  if (!emit_host_code)
+    {
+      target_write_memory (to, buf, len);
+      return;
+    }
+
+  CORE_ADDR start = (CORE_ADDR) (uintptr_t) host_code_buffer;
+
+  if (to < start || to + len > start + HOST_CODE_BUFFER_SIZE)
+    {
+      emit_error = 1;
+      return;
+    }
+
+  memcpy ((unsigned char *) (uintptr_t) to, buf, len);
+}
+
 static struct bytecode_address
 {
   int pc;
@@ -155,169 +205,169 @@ static struct bytecode_address
 void
 emit_prologue (void)
 {
-  target_emit_ops ()->emit_prologue ();
+  current_emit_ops ()->emit_prologue ();
 }
 
 void
 emit_epilogue (void)
 {
-  target_emit_ops ()->emit_epilogue ();
+  current_emit_ops ()->emit_epilogue ();
 }
 
 static void
 emit_add (void)
 {
-  target_emit_ops ()->emit_add ();
+  current_emit_ops ()->emit_add ();
 }
 
 static void
 emit_sub (void)
 {
-  target_emit_ops ()->emit_sub ();
+  current_emit_ops ()->emit_sub ();
 }
 
 static void
 emit_mul (void)
 {
-  target_emit_ops ()->emit_mul ();
+  current_emit_ops ()->emit_mul ();
 }
 
 static void
 emit_lsh (void)
 {
-  target_emit_ops ()->emit_lsh ();
+  current_emit_ops ()->emit_lsh ();
 }
 
 static void
 emit_rsh_signed (void)
 {
-  target_emit_ops ()->emit_rsh_signed ();
+  current_emit_ops ()->emit_rsh_signed ();
 }
 
 static void
 emit_rsh_unsigned (void)
 {
-  target_emit_ops ()->emit_rsh_unsigned ();
+  current_emit_ops ()->emit_rsh_unsigned ();
 }
 
 static void
 emit_ext (int arg)
 {
-  target_emit_ops ()->emit_ext (arg);
+  current_emit_ops ()->emit_ext (arg);
 }
 
 static void
 emit_log_not (void)
 {
-  target_emit_ops ()->emit_log_not ();
+  current_emit_ops ()->emit_log_not ();
 }
 
 static void
 emit_bit_and (void)
 {
-  target_emit_ops ()->emit_bit_and ();
+  current_emit_ops ()->emit_bit_and ();
 }
 
 static void
 emit_bit_or (void)
 {
-  target_emit_ops ()->emit_bit_or ();
+  current_emit_ops ()->emit_bit_or ();
 }
 
 static void
 emit_bit_xor (void)
 {
-  target_emit_ops ()->emit_bit_xor ();
+  current_emit_ops ()->emit_bit_xor ();
 }
 
 static void
 emit_bit_not (void)
 {
-  target_emit_ops ()->emit_bit_not ();
+  current_emit_ops ()->emit_bit_not ();
 }
 
 static void
 emit_equal (void)
 {
-  target_emit_ops ()->emit_equal ();
+  current_emit_ops ()->emit_equal ();
 }
 
 static void
 emit_less_signed (void)
 {
-  target_emit_ops ()->emit_less_signed ();
+  current_emit_ops ()->emit_less_signed ();
 }
 
 static void
 emit_less_unsigned (void)
 {
-  target_emit_ops ()->emit_less_unsigned ();
+  current_emit_ops ()->emit_less_unsigned ();
 }
 
 static void
 emit_ref (int size)
 {
-  target_emit_ops ()->emit_ref (size);
+  current_emit_ops ()->emit_ref (size);
 }
 
 static void
 emit_if_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_if_goto (offset_p, size_p);
+  current_emit_ops ()->emit_if_goto (offset_p, size_p);
 }
 
 static void
 emit_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_goto (offset_p, size_p);
+  current_emit_ops ()->emit_goto (offset_p, size_p);
 }
 
 static void
 write_goto_address (CORE_ADDR from, CORE_ADDR to, int size)
 {
-  target_emit_ops ()->write_goto_address (from, to, size);
+  current_emit_ops ()->write_goto_address (from, to, size);
 }
 
 static void
 emit_const (LONGEST num)
 {
-  target_emit_ops ()->emit_const (num);
+  current_emit_ops ()->emit_const (num);
 }
 
 static void
 emit_reg (int reg)
 {
-  target_emit_ops ()->emit_reg (reg);
+  current_emit_ops ()->emit_reg (reg);
 }
 
 static void
 emit_pop (void)
 {
-  target_emit_ops ()->emit_pop ();
+  current_emit_ops ()->emit_pop ();
 }
 
 static void
 emit_stack_flush (void)
 {
-  target_emit_ops ()->emit_stack_flush ();
+  current_emit_ops ()->emit_stack_flush ();
 }
 
 static void
 emit_zero_ext (int arg)
 {
-  target_emit_ops ()->emit_zero_ext (arg);
+  current_emit_ops ()->emit_zero_ext (arg);
 }
 
 static void
 emit_swap (void)
 {
-  target_emit_ops ()->emit_swap ();
+  current_emit_ops ()->emit_swap ();
 }
 
 static void
 emit_stack_adjust (int n)
 {
-  target_emit_ops ()->emit_stack_adjust (n);
+  current_emit_ops ()->emit_stack_adjust (n);
 }
 
 /* FN's prototype is `LONGEST(*fn)(int)'.  */
@@ -325,7 +375,7 @@ emit_stack_adjust (int n)
 static void
 emit_int_call_1 (CORE_ADDR fn, int arg1)
 {
-  target_emit_ops ()->emit_int_call_1 (fn, arg1);
+  current_emit_ops ()->emit_int_call_1 (fn, arg1);
 }
 
 /* FN's prototype is `void(*fn)(int,LONGEST)'.  */
@@ -333,43 +383,43 @@ emit_int_call_1 (CORE_ADDR fn, int arg1)
 static void
 emit_void_call_2 (CORE_ADDR fn, int arg1)
 {
-  target_emit_ops ()->emit_void_call_2 (fn, arg1);
+  current_emit_ops ()->emit_void_call_2 (fn, arg1);
 }
 
 static void
 emit_eq_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_eq_goto (offset_p, size_p);
+  current_emit_ops ()->emit_eq_goto (offset_p, size_p);
 }
 
 static void
 emit_ne_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_ne_goto (offset_p, size_p);
+  current_emit_ops ()->emit_ne_goto (offset_p, size_p);
 }
 
 static void
 emit_lt_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_lt_goto (offset_p, size_p);
+  current_emit_ops ()->emit_lt_goto (offset_p, size_p);
 }
 
 static void
 emit_ge_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_ge_goto (offset_p, size_p);
+  current_emit_ops ()->emit_ge_goto (offset_p, size_p);
 }
 
 static void
 emit_gt_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_gt_goto (offset_p, size_p);
+  current_emit_ops ()->emit_gt_goto (offset_p, size_p);
 }
 
 static void
 emit_le_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_le_goto (offset_p, size_p);
+  current_emit_ops ()->emit_le_goto (offset_p, size_p);
 }
 
 /* Scan an agent expression for any evidence that the given PC is the
@@ -518,7 +568,7 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  next_op = aexpr->bytes[pc];
 	  if (next_op == gdb_agent_op_if_goto
 	      && !is_goto_target (aexpr, pc)
-	      && target_emit_ops ()->emit_eq_goto)
+	      && current_emit_ops ()->emit_eq_goto)
 	    {
 	      ax_debug ("Combining equal & if_goto");
 	      pc += 1;
@@ -531,7 +581,7 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  else if (next_op == gdb_agent_op_log_not
 		   && (aexpr->bytes[pc + 1] == gdb_agent_op_if_goto)
 		   && !is_goto_target (aexpr, pc + 1)
-		   && target_emit_ops ()->emit_ne_goto)
+		   && current_emit_ops ()->emit_ne_goto)
 	    {
 	      ax_debug ("Combining equal & log_not & if_goto");
 	      pc += 2;
@@ -718,6 +768,10 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  break;
 
 	case gdb_agent_op_getv:
+	  /* Code compiled for GDBserver itself can't call into the
+	     in-process agent, where the trace state variables live.  */
+	  if (emit_host_code)
+	    UNHANDLED;
 	  emit_stack_flush ();
 	  arg = aexpr->bytes[pc++];
 	  arg = (arg << 8) + aexpr->bytes[pc++];
@@ -726,6 +780,8 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  break;
 
 	case gdb_agent_op_setv:
+	  if (emit_host_code)
+	    UNHANDLED;
 	  arg = aexpr->bytes[pc++];
 	  arg = (arg << 8) + aexpr->bytes[pc++];
 	  emit_void_call_2 (get_set_tsv_func_addr (),
@@ -933,6 +989,38 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
   fflush (stdout);
 }
 
+/* Return the value of register REGNUM in REGCACHE, zero-extended.  */
+
+static ULONGEST
+agent_get_reg (struct regcache *regcache, int regnum)
+{
+  union
+  {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+  } cnv;
+
+  switch (register_size (regcache->tdesc, regnum))
+    {
+    case 8:
+      collect_register (regcache, regnum, &cnv.u64);
+      return cnv.u64;
+    case 4:
+      collect_register (regcache, regnum, &cnv.u32);
+      return cnv.u32;
+    case 2:
+      collect_register (regcache, regnum, &cnv.u16);
+      return cnv.u16;
+    case 1:
+      collect_register (regcache, regnum, &cnv.u8);
+      return cnv.u8;
+    default:
+      internal_error ("unhandled register size");
+    }
+}
+
 /* The agent expression evaluator, as specified by the GDB docs. It
    returns 0 if everything went OK, and a nonzero error code
    otherwise.  */
@@ -1187,32 +1275,7 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	  stack[sp++] = top;
 	  arg = aexpr->bytes[pc++];
 	  arg = (arg << 8) + aexpr->bytes[pc++];
-	  {
-	    int regnum = arg;
-	    struct regcache *regcache = ctx->regcache;
-
-	    switch (register_size (regcache->tdesc, regnum))
-	      {
-	      case 8:
-		collect_register (regcache, regnum, cnv.u64.bytes);
-		top = cnv.u64.val;
-		break;
-	      case 4:
-		collect_register (regcache, regnum, cnv.u32.bytes);
-		top = cnv.u32.val;
-		break;
-	      case 2:
-		collect_register (regcache, regnum, cnv.u16.bytes);
-		top = cnv.u16.val;
-		break;
-	      case 1:
-		collect_register (regcache, regnum, cnv.u8.bytes);
-		top = cnv.u8.val;
-		break;
-	      default:
-		internal_error ("unhandled register size");
-	      }
-	  }
+	  top = agent_get_reg (ctx->regcache, arg);
 	  break;
 
 	case gdb_agent_op_end:
@@ -1373,3 +1436,219 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 		gdb_agent_op_name (op), sp, phex_nz (top, 0));
     }
 }
+
+#ifndef IN_PROCESS_AGENT
+
+/* Native code compiled from agent expressions to run inside
+   GDBserver.  This uses the same code generator as fast tracepoint
+   conditions, through the target's host_emit_ops vector, whose
+   register and memory accesses call back into the helpers below
+   instead of reading the inferior's state directly.  */
+
+/* The first error a helper ran into while running native code, if
+   any.  */
+
+static enum eval_result_type host_code_error;
+
+/* Compiled code, indexed by the bytecode it was compiled from.  GDB
+   sends the same conditions again every time it reinserts a
+   breakpoint, so this avoids compiling them more than once.  A null
+   entry records an expression that can not be compiled.  */
+
+static std::unordered_map<std::string, host_agent_expr_fn> host_code_cache;
+
+/* See ax.h.  */
+
+ULONGEST
+host_code_get_reg (struct eval_agent_expr_context *ctx, int regnum)
+{
+  return agent_get_reg (ctx->regcache, regnum);
+}
+
+/* See ax.h.  */
+
+ULONGEST
+host_code_ref (CORE_ADDR addr, int size)
+{
+  union
+  {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+  } cnv;
+
+  if (read_inferior_memory (addr, (unsigned char *) &cnv, size) != 0)
+    {
+      if (host_code_error == expr_eval_no_error)
+	host_code_error = expr_eval_invalid_memory_access;
+      return 0;
+    }
+
+  switch (size)
+    {
+    case 1:
+      return cnv.u8;
+    case 2:
+      return cnv.u16;
+    case 4:
+      return cnv.u32;
+    default:
+      return cnv.u64;
+    }
+}
+
+/* Allocate the buffer holding code compiled for GDBserver, if not
+   done yet.  Return false if that is not possible.  */
+
+static bool
+allocate_host_code_buffer ()
+{
+#ifdef HAVE_MMAP
+  static bool failed;
+
+  if (host_code_buffer != NULL)
+    return true;
+  if (failed)
+    return false;
+
+  /* The buffer is only made executable once the code is written, see
+     set_host_code_buffer_writable.  */
+  void *buf = mmap (NULL, HOST_CODE_BUFFER_SIZE,
+		    PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buf == MAP_FAILED)
+    {
+      ax_debug ("Could not allocate native code buffer: %s",
+		safe_strerror (errno));
+      failed = true;
+      return false;
+    }
+
+  host_code_buffer = (unsigned char *) buf;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* Make the buffer holding code compiled for GDBserver writable, but
+   not executable, if WRITABLE is true, and executable, but not
+   writable, otherwise.  The buffer is never both at once.  Return
+   false on failure.  */
+
+static bool
+set_host_code_buffer_writable (bool writable)
+{
+#ifdef HAVE_MMAP
+  int prot = PROT_READ | (writable ? PROT_WRITE : PROT_EXEC);
+
+  if (mprotect (host_code_buffer, HOST_CODE_BUFFER_SIZE, prot) != 0)
+    {
+      ax_debug ("Could not change native code buffer protection: %s",
+		safe_strerror (errno));
+      return false;
+    }
+
+  if (!writable)
+    __builtin___clear_cache ((char *) host_code_buffer,
+			     (char *) host_code_buffer
+			     + HOST_CODE_BUFFER_SIZE);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* See ax.h.  */
+
+host_agent_expr_fn
+gdb_compile_agent_expr_for_host (struct agent_expr *aexpr)
+{
+  if (target_host_emit_ops () == nullptr)
+    return nullptr;
+
+  std::string key ((const char *) aexpr->bytes, aexpr->length);
+  auto it = host_code_cache.find (key);
+  if (it != host_code_cache.end ())
+    return it->second;
+
+  host_agent_expr_fn fn = nullptr;
+
+  if (allocate_host_code_buffer () && set_host_code_buffer_writable (true))
+    {
+      CORE_ADDR entry
+	= (CORE_ADDR) (uintptr_t) (host_code_buffer + host_code_used);
+      enum eval_result_type err = expr_eval_unhandled_opcode;
+
+      try
+	{
+	  /* Code compiled earlier must run even if this fails, so always
+	     make the buffer executable again.  */
+	  bool executable = false;
+	  SCOPE_EXIT
+	    {
+	      if (!executable)
+		set_host_code_buffer_writable (false);
+	    };
+	  scoped_restore restore_emit_host_code
+	    = make_scoped_restore (&emit_host_code, 1);
+
+	  current_insn_ptr = entry;
+	  emit_error = 0;
+
+	  emit_prologue ();
+	  if (emit_error)
+	    err = expr_eval_unhandled_opcode;
+	  else
+	    err = compile_bytecodes (aexpr);
+	  if (err == expr_eval_no_error)
+	    {
+	      emit_epilogue ();
+	      if (emit_error)
+		err = expr_eval_unhandled_opcode;
+	    }
+
+	  executable = true;
+	  if (!set_host_code_buffer_writable (false))
+	    err = expr_eval_unhandled_opcode;
+	}
+      catch (const gdb_exception_error &ex)
+	{
+	  ax_debug ("Could not compile agent expression: %s", ex.what ());
+	  err = expr_eval_unhandled_opcode;
+	}
+
+      if (err == expr_eval_no_error)
+	{
+	  host_code_used = align_up (current_insn_ptr
+				     - (CORE_ADDR) (uintptr_t) host_code_buffer,
+				     16);
+	  fn = (host_agent_expr_fn) (uintptr_t) entry;
+	  ax_debug ("Compiled agent expression to native code at %s",
+		    paddress (entry));
+	}
+      else
+	ax_debug ("Could not compile agent expression, error %d", err);
+    }
+
+  host_code_cache.emplace (std::move (key), fn);
+  return fn;
+}
+
+/* See ax.h.  */
+
+enum eval_result_type
+gdb_run_host_agent_expr (host_agent_expr_fn fn,
+			 struct eval_agent_expr_context *ctx,
+			 ULONGEST *rslt)
+{
+  host_code_error = expr_eval_no_error;
+
+  enum eval_result_type err = fn (ctx, rslt);
+  if (err == expr_eval_no_error)
+    err = host_code_error;
+  return err;
+}
+
+#endif
@@ -136,4 +136,41 @@ struct emit_ops
 extern CORE_ADDR current_insn_ptr;
 extern int emit_error;
 
+#ifndef IN_PROCESS_AGENT
+
+/* Nonzero while compile_bytecodes is generating code to run inside
+   GDBserver itself, rather than in the inferior.  */
+extern int emit_host_code;
+
+/* Write LEN bytes of generated code from BUF at address TO, in the
+   inferior or, if emit_host_code is set, in GDBserver's own code
+   buffer.  Sets emit_error if the code does not fit.  */
+void write_emitted_code (CORE_ADDR to, const unsigned char *buf,
+			 size_t len);
+
+/* Native code compiled from an agent expression, to run inside
+   GDBserver.  It stores the expression's value in *RSLT.  */
+typedef enum eval_result_type (*host_agent_expr_fn)
+  (struct eval_agent_expr_context *ctx, ULONGEST *rslt);
+
+/* Compile AEXPR to native code that runs inside GDBserver.  Returns
+   nullptr if the target or the expression does not support that, in
+   which case gdb_eval_agent_expr should be used instead.  Results are
+   cached by expression contents.  */
+host_agent_expr_fn gdb_compile_agent_expr_for_host (struct agent_expr *aexpr);
+
+/* Run FN, as returned by gdb_compile_agent_expr_for_host, with the
+   same conventions as gdb_eval_agent_expr.  */
+enum eval_result_type gdb_run_host_agent_expr
+  (host_agent_expr_fn fn, struct eval_agent_expr_context *ctx,
+   ULONGEST *rslt);
+
+/* Helpers called by native code compiled to run inside GDBserver, to
+   read register REGNUM, and SIZE bytes of memory at ADDR.  */
+ULONGEST host_code_get_reg (struct eval_agent_expr_context *ctx,
+			    int regnum);
+ULONGEST host_code_ref (CORE_ADDR addr, int size);
+
+#endif
+
 #endif /* GDBSERVER_AX_H */
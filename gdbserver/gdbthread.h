@@ -47,6 +47,11 @@ struct thread_info
   /* The last resume GDB requested on this thread.  */
   enum resume_kind last_resume_kind = resume_continue;
 
+  /* The generation of the last thread list reported to GDB when this
+     thread was added.  Thread list deltas since that generation, or
+     any later one, include the thread.  */
+  ULONGEST list_generation = 0;
+
   /* The last wait status reported for this thread.  */
   struct target_waitstatus last_status;
 
@@ -21,6 +21,7 @@
 #include "gdbsupport/common-inferior.h"
 #include "gdbthread.h"
 #include "dll.h"
+#include "tracepoint.h"
 
 std::list<process_info *> all_processes;
 std::list<thread_info *> all_threads;
@@ -43,6 +44,7 @@ add_thread (ptid_t thread_id, void *target_data)
   thread_info *new_thread = new thread_info (thread_id, target_data);
 
   all_threads.push_back (new_thread);
+  thread_list_note_added (new_thread);
 
   if (current_thread == NULL)
     switch_to_thread (new_thread);
@@ -101,6 +103,7 @@ remove_thread (struct thread_info *thread)
     target_disable_btrace (thread->btrace);
 
   discard_queued_stop_replies (ptid_of (thread));
+  thread_list_note_removed (ptid_of (thread));
   all_threads.remove (thread);
   if (current_thread == thread)
     switch_to_thread (nullptr);
@@ -156,6 +159,7 @@ remove_process (struct process_info *process)
 {
   clear_symbol_cache (&process->symbol_cache);
   free_all_breakpoints (process);
+  free_breakpoint_jump_pads (process);
   gdb_assert (find_thread_process (process) == NULL);
   all_processes.remove (process);
   if (current_process () == process)
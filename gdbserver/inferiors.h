@@ -61,6 +61,10 @@ struct process_info
   /* The list of installed fast tracepoints.  */
   struct fast_tracepoint_jump *fast_tracepoint_jumps = NULL;
 
+  /* The jump pads evaluating the conditions of GDB breakpoints in this
+     process.  */
+  struct breakpoint_jump_pad *breakpoint_jump_pads = NULL;
+
   /* The list of syscalls to report, or just a single element, ANY_SYSCALL,
      for unfiltered syscall reporting.  */
   std::vector<int> syscalls_to_catch;
@@ -1951,6 +1951,16 @@ handle_tracepoints (struct lwp_info *lwp)
 
   tpoint_related_event |= handle_tracepoint_bkpts (tinfo, lwp->stop_pc);
 
+  /* See if the in-process agent found the condition of a breakpoint
+     installed as a jump pad true.  If so, the thread is now back at
+     the breakpoint address, and is reported as having hit a software
+     breakpoint there.  */
+  if (breakpoint_jump_pad_hit (tinfo, &lwp->stop_pc))
+    {
+      lwp->stop_reason = TARGET_STOPPED_BY_SW_BREAKPOINT;
+      tpoint_related_event = 1;
+    }
+
   /* See if we just hit a tracepoint and do its main collect
      actions.  */
   tpoint_related_event |= tracepoint_was_hit (tinfo, lwp->stop_pc);
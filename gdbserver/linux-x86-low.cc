@@ -128,8 +128,15 @@ public:
 
   int get_min_fast_tracepoint_insn_len () override;
 
+  bool supports_breakpoint_jump_pads () override;
+
+  int fetch_jump_pad_registers (struct regcache *regcache,
+				CORE_ADDR regs) override;
+
   struct emit_ops *emit_ops () override;
 
+  struct emit_ops *host_emit_ops () override;
+
   int get_ipa_tdesc_idx () override;
 
 protected:
@@ -1046,7 +1053,7 @@ x86_target::supports_tracepoints ()
 static void
 append_insns (CORE_ADDR *to, size_t len, const unsigned char *buf)
 {
-  target_write_memory (*to, buf, len);
+  write_emitted_code (*to, buf, len);
   *to += len;
 }
 
@@ -1541,6 +1548,56 @@ x86_target::get_min_fast_tracepoint_insn_len ()
     }
 }
 
+#ifdef __x86_64__
+
+/* Offsets of the registers in the register block saved by
+   amd64_install_fast_tracepoint_jump_pad, indexed by register number.
+   This must match x86_64_ft_collect_regmap in linux-amd64-ipa.cc.  */
+
+static const int amd64_jump_pad_regmap[] =
+{
+  10 * 8, 11 * 8, 12 * 8, 13 * 8,	/* rax, rbx, rcx, rdx */
+  14 * 8, 15 * 8, 16 * 8, 17 * 8,	/* rsi, rdi, rbp, rsp */
+  2 * 8, 3 * 8, 4 * 8, 5 * 8,		/* r8 - r11 */
+  6 * 8, 7 * 8, 8 * 8, 9 * 8,		/* r12 - r15 */
+  0 * 8, 1 * 8				/* rip, eflags */
+};
+
+#endif
+
+/* Breakpoint jump pads are only supported on x86-64, where the
+   jump pad's register block is fixed.  */
+
+bool
+x86_target::supports_breakpoint_jump_pads ()
+{
+#ifdef __x86_64__
+  return is_64bit_tdesc (current_thread);
+#else
+  return false;
+#endif
+}
+
+int
+x86_target::fetch_jump_pad_registers (struct regcache *regcache,
+				      CORE_ADDR regs)
+{
+#ifdef __x86_64__
+  gdb_byte buf[ARRAY_SIZE (amd64_jump_pad_regmap) * 8];
+
+  if (read_inferior_memory (regs, buf, sizeof (buf)) != 0)
+    return 1;
+
+  for (int i = 0; i < ARRAY_SIZE (amd64_jump_pad_regmap); i++)
+    supply_register (regcache, i, buf + amd64_jump_pad_regmap[i]);
+
+  return 0;
+#else
+  gdb_assert_not_reached ("target op fetch_jump_pad_registers "
+			  "not supported");
+#endif
+}
+
 static void
 add_insns (unsigned char *start, int len)
 {
@@ -1825,7 +1882,7 @@ amd64_write_goto_address (CORE_ADDR from, CORE_ADDR to, int size)
     }
 
   memcpy (buf, &diff, sizeof (int));
-  target_write_memory (from, buf, sizeof (int));
+  write_emitted_code (from, buf, sizeof (int));
 }
 
 static void
@@ -2175,6 +2232,110 @@ static emit_ops amd64_emit_ops =
     amd64_emit_ge_goto
   };
 
+/* The code compiled by amd64_host_emit_ops runs inside GDBserver, for
+   evaluating breakpoint conditions without interpreting bytecode.
+   It has the same calling convention as code compiled for the
+   in-process agent, except that the first argument is the
+   eval_agent_expr_context instead of the raw registers block, and
+   that registers and memory are read by calling GDBserver helpers.
+   These are ordinary C functions, so the stack is realigned around
+   the calls, keeping the original stack pointer in the frame slot
+   the prologue leaves free.  */
+
+/* Emit a call to the helper FN, with its first argument already in
+   %rdi and the stack realigned, passing ARG as second argument.  The
+   caller restores the stack pointer afterwards.  */
+
+static void
+amd64_host_emit_helper_call (CORE_ADDR fn, int arg)
+{
+  unsigned char buf[16];
+  int i;
+  CORE_ADDR buildaddr;
+
+  buildaddr = current_insn_ptr;
+  i = 0;
+  buf[i++] = 0xbe; /* mov $<n>,%esi */
+  memcpy (&buf[i], &arg, sizeof (arg));
+  i += 4;
+  append_insns (&buildaddr, i, buf);
+  current_insn_ptr = buildaddr;
+  amd64_emit_call (fn);
+}
+
+static void
+amd64_host_emit_reg (int reg)
+{
+  EMIT_ASM (amd64_host_reg_a,
+	    "mov %rsp,-24(%rbp)\n\t"
+	    "and $-16,%rsp\n\t"
+	    "mov -8(%rbp),%rdi");
+  amd64_host_emit_helper_call ((CORE_ADDR) (uintptr_t) host_code_get_reg,
+			       reg);
+  EMIT_ASM (amd64_host_reg_b,
+	    "mov -24(%rbp),%rsp");
+}
+
+static void
+amd64_host_emit_ref (int size)
+{
+  EMIT_ASM (amd64_host_ref_a,
+	    "mov %rsp,-24(%rbp)\n\t"
+	    "and $-16,%rsp\n\t"
+	    "mov %rax,%rdi");
+  amd64_host_emit_helper_call ((CORE_ADDR) (uintptr_t) host_code_ref, size);
+  EMIT_ASM (amd64_host_ref_b,
+	    "mov -24(%rbp),%rsp");
+}
+
+static void
+amd64_host_emit_tsv_call (CORE_ADDR fn, int arg1)
+{
+  /* Trace state variables live in the in-process agent.  */
+  emit_error = 1;
+}
+
+static emit_ops amd64_host_emit_ops =
+  {
+    amd64_emit_prologue,
+    amd64_emit_epilogue,
+    amd64_emit_add,
+    amd64_emit_sub,
+    amd64_emit_mul,
+    amd64_emit_lsh,
+    amd64_emit_rsh_signed,
+    amd64_emit_rsh_unsigned,
+    amd64_emit_ext,
+    amd64_emit_log_not,
+    amd64_emit_bit_and,
+    amd64_emit_bit_or,
+    amd64_emit_bit_xor,
+    amd64_emit_bit_not,
+    amd64_emit_equal,
+    amd64_emit_less_signed,
+    amd64_emit_less_unsigned,
+    amd64_host_emit_ref,
+    amd64_emit_if_goto,
+    amd64_emit_goto,
+    amd64_write_goto_address,
+    amd64_emit_const,
+    amd64_emit_call,
+    amd64_host_emit_reg,
+    amd64_emit_pop,
+    amd64_emit_stack_flush,
+    amd64_emit_zero_ext,
+    amd64_emit_swap,
+    amd64_emit_stack_adjust,
+    amd64_host_emit_tsv_call,
+    amd64_host_emit_tsv_call,
+    amd64_emit_eq_goto,
+    amd64_emit_ne_goto,
+    amd64_emit_lt_goto,
+    amd64_emit_le_goto,
+    amd64_emit_gt_goto,
+    amd64_emit_ge_goto
+  };
+
 #endif /* __x86_64__ */
 
 static void
@@ -2443,7 +2604,7 @@ i386_write_goto_address (CORE_ADDR from, CORE_ADDR to, int size)
     }
 
   memcpy (buf, &diff, sizeof (int));
-  target_write_memory (from, buf, sizeof (int));
+  write_emitted_code (from, buf, sizeof (int));
 }
 
 static void
@@ -2856,6 +3017,16 @@ x86_target::emit_ops ()
     return &i386_emit_ops;
 }
 
+emit_ops *
+x86_target::host_emit_ops ()
+{
+#ifdef __x86_64__
+  if (is_64bit_tdesc (current_thread))
+    return &amd64_host_emit_ops;
+#endif
+  return nullptr;
+}
+
 /* Implementation of target ops method "sw_breakpoint_from_kind".  */
 
 const gdb_byte *
@@ -20,6 +20,7 @@
 
 #include "regcache.h"
 #include "ax.h"
+#include "tracepoint.h"
 
 #define MAX_BREAKPOINT_LEN 8
 
@@ -112,6 +113,11 @@ struct raw_breakpoint
      inferior.  Negative if it was, but we've detected that it's now
      gone.  Zero if not inserted.  */
   int inserted;
+
+  /* True if the GDB breakpoint that owns this breakpoint is installed
+     as a jump to a jump pad instead, see set_gdb_breakpoint_jump_pad.
+     The breakpoint is then left uninserted.  */
+  bool jump_pad;
 };
 
 /* The type of a breakpoint.  */
@@ -146,6 +152,12 @@ struct point_cond_list
      conditional.  */
   struct agent_expr *cond;
 
+  /* The condition compiled to native code, if possible.  This is
+     done the first time the condition is evaluated, once the thread
+     it is evaluated for is known.  */
+  host_agent_expr_fn compiled;
+  bool compile_attempted;
+
   /* Pointer to the next condition.  */
   struct point_cond_list *next;
 };
@@ -191,6 +203,14 @@ struct gdb_breakpoint
 
   /* Point to the list of commands to run when this is hit.  */
   struct point_command_list *command_list;
+
+  /* The jump to the jump pad that evaluates the condition in the
+     inferior, or NULL if the breakpoint is a breakpoint
+     instruction.  */
+  struct fast_tracepoint_jump *jump;
+
+  /* The jump pad JUMP jumps to.  */
+  struct breakpoint_jump_pad *jump_pad;
 };
 
 /* Breakpoint used by GDBserver.  */
@@ -333,7 +353,8 @@ find_enabled_raw_code_breakpoint_at (CORE_ADDR addr, enum raw_bkpt_type type)
   for (bp = proc->raw_breakpoints; bp != NULL; bp = bp->next)
     if (bp->pc == addr
 	&& bp->raw_type == type
-	&& bp->inserted >= 0)
+	&& bp->inserted >= 0
+	&& !bp->jump_pad)
       return bp;
 
   return NULL;
@@ -1049,6 +1070,7 @@ set_gdb_breakpoint (char z_type, CORE_ADDR addr, int kind, int *err)
 	      /* A different kind than previously seen.  The previous
 		 breakpoint must be gone then.  */
 	      bp->base.raw->inserted = -1;
+	      clear_breakpoint_conditions_and_commands (bp);
 	      delete_breakpoint ((struct breakpoint *) bp);
 	      bp = NULL;
 	    }
@@ -1164,13 +1186,90 @@ clear_breakpoint_commands (struct gdb_breakpoint *bp)
   bp->command_list = NULL;
 }
 
+static void uninsert_raw_breakpoint (struct raw_breakpoint *bp);
+static void reinsert_raw_breakpoint (struct raw_breakpoint *bp);
+
+/* Turn BP back into a breakpoint instruction, if it is installed as
+   a jump pad.  */
+
+static void
+clear_gdb_breakpoint_jump_pad (struct gdb_breakpoint *bp)
+{
+  struct raw_breakpoint *raw = bp->base.raw;
+
+  if (bp->jump == NULL)
+    return;
+
+  /* Insert the breakpoint instruction on top of the jump first, so
+     that there's no window where neither is inserted.  */
+  raw->jump_pad = false;
+  reinsert_raw_breakpoint (raw);
+  delete_fast_tracepoint_jump (bp->jump);
+  bp->jump = NULL;
+  release_breakpoint_jump_pad (bp->jump_pad);
+  bp->jump_pad = NULL;
+}
+
 void
 clear_breakpoint_conditions_and_commands (struct gdb_breakpoint *bp)
 {
+  clear_gdb_breakpoint_jump_pad (bp);
   clear_breakpoint_conditions (bp);
   clear_breakpoint_commands (bp);
 }
 
+/* See mem-break.h.  */
+
+void
+set_gdb_breakpoint_jump_pad (struct gdb_breakpoint *bp, ULONGEST orig_size)
+{
+  struct raw_breakpoint *raw = bp->base.raw;
+
+  /* The jump pad evaluates a single condition and doesn't run
+     commands.  Also, nothing else must need the breakpoint
+     instruction.  */
+  if (bp->base.type != gdb_breakpoint_Z0
+      || bp->jump != NULL
+      || bp->cond_list == NULL
+      || bp->cond_list->next != NULL
+      || bp->command_list != NULL
+      || raw->refcount != 1
+      || raw->inserted <= 0)
+    return;
+
+  bp->jump = install_breakpoint_jump_pad (raw->pc, orig_size,
+					  bp->cond_list->cond, &bp->jump_pad);
+  if (bp->jump == NULL)
+    return;
+
+  /* The jump was written underneath the breakpoint instruction.
+     Uncover it.  */
+  uninsert_raw_breakpoint (raw);
+  if (raw->inserted != 0)
+    {
+      delete_fast_tracepoint_jump (bp->jump);
+      bp->jump = NULL;
+      release_breakpoint_jump_pad (bp->jump_pad);
+      bp->jump_pad = NULL;
+      return;
+    }
+
+  raw->jump_pad = true;
+}
+
+/* See mem-break.h.  */
+
+void
+remove_gdb_breakpoint_jump_pads_at (CORE_ADDR addr)
+{
+  struct process_info *proc = current_process ();
+  struct breakpoint *bp;
+
+  for (bp = proc->breakpoints; bp != NULL; bp = bp->next)
+    if (bp->type == gdb_breakpoint_Z0 && bp->raw->pc == addr)
+      clear_gdb_breakpoint_jump_pad ((struct gdb_breakpoint *) bp);
+}
+
 /* Add condition CONDITION to GDBserver's breakpoint BP.  */
 
 static void
@@ -1250,8 +1349,17 @@ gdb_condition_true_at_breakpoint_z_type (char z_type, CORE_ADDR addr)
   for (cl = bp->cond_list;
        cl && !value && !err; cl = cl->next)
     {
+      if (!cl->compile_attempted)
+	{
+	  cl->compiled = gdb_compile_agent_expr_for_host (cl->cond);
+	  cl->compile_attempted = true;
+	}
+
       /* Evaluate the condition.  */
-      err = gdb_eval_agent_expr (&ctx, cl->cond, &value);
+      if (cl->compiled != NULL)
+	err = gdb_run_host_agent_expr (cl->compiled, &ctx, &value);
+      else
+	err = gdb_eval_agent_expr (&ctx, cl->cond, &value);
     }
 
   if (err)
@@ -1535,7 +1643,7 @@ reinsert_raw_breakpoint (struct raw_breakpoint *bp)
 {
   int err;
 
-  if (bp->inserted)
+  if (bp->inserted || bp->jump_pad)
     return;
 
   err = the_target->insert_point (bp->raw_type, bp->pc, bp->kind, bp);
@@ -125,6 +125,20 @@ int add_breakpoint_condition (struct gdb_breakpoint *bp,
 int add_breakpoint_commands (struct gdb_breakpoint *bp, const char **commands,
 			     int persist);
 
+/* Install the software breakpoint BP as a jump to a jump pad that
+   evaluates its condition in the inferior, if possible.  ORIG_SIZE
+   is the length of the instruction at BP's address, as sent by GDB.
+   Otherwise, BP remains a breakpoint instruction.  The jump pad is
+   removed again when BP's conditions are cleared.  */
+
+void set_gdb_breakpoint_jump_pad (struct gdb_breakpoint *bp,
+				  ULONGEST orig_size);
+
+/* Turn the GDB breakpoints at ADDR that are installed as jump pads
+   back into breakpoint instructions.  */
+
+void remove_gdb_breakpoint_jump_pads_at (CORE_ADDR addr);
+
 /* Return true if PROC has any persistent command.  */
 bool any_persistent_commands (process_info *proc);
 
@@ -62,6 +62,9 @@
 #include <arpa/inet.h>
 #endif
 #include <sys/stat.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
 
 #if USE_WIN32API
 #include <ws2tcpip.h>
@@ -98,6 +101,11 @@ struct sym_cache
 static int remote_is_stdio = 0;
 
 static int remote_desc = -1;
+#ifdef HAVE_LIBZ
+/* If non-NULL, the data sent to GDB is compressed with this
+   stream.  */
+static z_stream *output_deflate;
+#endif
 static int listen_desc = -1;
 
 #ifdef USE_WIN32API
@@ -420,6 +428,15 @@ remote_close (void)
 #endif
   remote_desc = -1;
 
+#ifdef HAVE_LIBZ
+  if (output_deflate != nullptr)
+    {
+      deflateEnd (output_deflate);
+      delete output_deflate;
+      output_deflate = nullptr;
+    }
+#endif
+
   reset_readchar ();
 }
 
@@ -599,7 +616,7 @@ read_ptid (const char *buf, const char **obuf)
    This may return less than COUNT.  */
 
 static int
-write_prim (const void *buf, int count)
+write_prim_1 (const void *buf, int count)
 {
   if (remote_connection_is_stdio ())
     return write (fileno (stdout), buf, count);
@@ -607,6 +624,73 @@ write_prim (const void *buf, int count)
     return write (remote_desc, buf, count);
 }
 
+/* Write COUNT bytes in BUF to the client, compressing them if
+   remote_compress_output was called.
+   The result is the number of bytes written or -1 if error.
+   This may return less than COUNT.  */
+
+static int
+write_prim (const void *buf, int count)
+{
+#ifdef HAVE_LIBZ
+  if (output_deflate != nullptr)
+    {
+      unsigned char out[BUFSIZ];
+
+      output_deflate->next_in = (Bytef *) buf;
+      output_deflate->avail_in = count;
+
+      /* Flush after each write, so that GDB can decompress everything
+	 it reads right away.  */
+      do
+	{
+	  output_deflate->next_out = out;
+	  output_deflate->avail_out = sizeof (out);
+	  if (deflate (output_deflate, Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+	    return -1;
+
+	  const unsigned char *p = out;
+	  int len = sizeof (out) - output_deflate->avail_out;
+	  while (len > 0)
+	    {
+	      int written = write_prim_1 (p, len);
+	      if (written <= 0)
+		return -1;
+	      p += written;
+	      len -= written;
+	    }
+	}
+      while (output_deflate->avail_out == 0);
+
+      return count;
+    }
+#endif
+
+  return write_prim_1 (buf, count);
+}
+
+/* See remote-utils.h.  */
+
+bool
+remote_compress_output ()
+{
+#ifdef HAVE_LIBZ
+  gdb_assert (output_deflate == nullptr);
+
+  z_stream *stream = new z_stream {};
+  if (deflateInit (stream, Z_BEST_SPEED) != Z_OK)
+    {
+      delete stream;
+      return false;
+    }
+
+  output_deflate = stream;
+  return true;
+#else
+  return false;
+#endif
+}
+
 /* Read COUNT bytes from the client and store in BUF.
    The result is the number of bytes read or -1 if error.
    This may return less than COUNT.  */
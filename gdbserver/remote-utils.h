@@ -34,6 +34,12 @@ int getpkt (char *buf);
 void remote_prepare (const char *name);
 void remote_open (const char *name);
 void remote_close (void);
+
+/* Compress the data sent to GDB from now on with zlib, flushing the
+   stream after each write.  Return false if that is not possible.  */
+
+bool remote_compress_output ();
+
 void write_ok (char *buf);
 void write_enn (char *buf);
 void initialize_async_io (void);
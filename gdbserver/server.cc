@@ -80,6 +80,11 @@ static bool extended_protocol;
 static bool response_needed;
 static bool exit_requested;
 
+/* True if GDB requested compression with QCompress.  The reply to
+   QCompress itself is sent uncompressed, so this only takes effect
+   once it is sent.  */
+static bool compress_output_requested;
+
 /* --once: Exit after the first connection has closed.  */
 bool run_once;
 
@@ -788,6 +793,26 @@ handle_general_set (char *own_buf)
       return;
     }
 
+  if (startswith (own_buf, "QCompress:"))
+    {
+      const char *algorithm = own_buf + strlen ("QCompress:");
+
+#ifdef HAVE_LIBZ
+      if (strcmp (algorithm, "zlib") == 0)
+	{
+	  remote_debug_printf ("[output compression enabled]");
+
+	  compress_output_requested = true;
+	  write_ok (own_buf);
+	  return;
+	}
+#endif
+
+      remote_debug_printf ("unsupported compression: %s", algorithm);
+      write_enn (own_buf);
+      return;
+    }
+
   if (strcmp (own_buf, "QStartNoAckMode") == 0)
     {
       remote_debug_printf ("[noack mode enabled]");
@@ -1986,27 +2011,20 @@ handle_qxfer_statictrace (const char *annex,
 }
 
 /* Helper for handle_qxfer_threads_proper.
-   Emit the XML to describe the thread of INF.  */
+   Emit the XML to describe THREAD, whose core is CORE and whose name
+   is NAME, or NULL if it has no name.  */
 
 static void
-handle_qxfer_threads_worker (thread_info *thread, std::string *buffer)
+handle_qxfer_threads_worker (thread_info *thread, int core, const char *name,
+			     std::string *buffer)
 {
   ptid_t ptid = ptid_of (thread);
   char ptid_s[100];
-  int core = target_core_of_thread (ptid);
   char core_s[21];
-  const char *name = target_thread_name (ptid);
   int handle_len;
   gdb_byte *handle;
   bool handle_status = target_thread_handle (ptid, &handle, &handle_len);
 
-  /* If this is a (v)fork/clone child (has a (v)fork/clone parent),
-     GDB does not yet know about this thread, and must not know about
-     it until it gets the corresponding (v)fork/clone event.  Exclude
-     this thread from the list.  */
-  if (target_thread_pending_parent (thread) != nullptr)
-    return;
-
   write_ptid (ptid_s, ptid);
 
   string_xml_appendf (*buffer, "<thread id=\"%s\"", ptid_s);
@@ -2030,13 +2048,49 @@ handle_qxfer_threads_worker (thread_info *thread, std::string *buffer)
   string_xml_appendf (*buffer, "/>\n");
 }
 
-/* Helper for handle_qxfer_threads.  Return true on success, false
-   otherwise.  */
+/* See server.h.  */
+
+void
+thread_list_note_added (thread_info *thread)
+{
+  thread->list_generation = get_client_state ().thread_list_generation;
+}
+
+/* See server.h.  */
+
+void
+thread_list_note_removed (ptid_t ptid)
+{
+  client_state &cs = get_client_state ();
+
+  /* Only a thread list delta needs to know, and there can only be one
+     once a list was reported.  */
+  if (cs.thread_list_generation != 0)
+    cs.threads_removed_since_list.push_back (ptid);
+}
+
+/* Helper for handle_qxfer_threads.  If SINCE is the generation of the
+   last thread list reported, emit only the threads added and removed
+   since; otherwise emit the whole list.  The attributes of a thread,
+   its core and name, are only sent with the thread when it is new, so
+   that a delta costs nothing for the threads that remain.  Return true
+   on success, false otherwise.  */
 
 static bool
-handle_qxfer_threads_proper (std::string *buffer)
+handle_qxfer_threads_proper (std::string *buffer,
+			     std::optional<ULONGEST> since)
 {
-  *buffer += "<threads>\n";
+  client_state &cs = get_client_state ();
+  bool delta = (since.has_value ()
+		&& cs.thread_list_generation != 0
+		&& *since == cs.thread_list_generation);
+
+  ULONGEST generation = cs.thread_list_generation + 1;
+  string_xml_appendf (*buffer, "<threads generation=\"%s\"",
+		      pulongest (generation));
+  if (delta)
+    string_xml_appendf (*buffer, " since=\"%s\"", pulongest (*since));
+  *buffer += ">\n";
 
   /* The target may need to access memory and registers (e.g. via
      libthread_db) to fetch thread properties.  Even if don't need to
@@ -2050,17 +2104,49 @@ handle_qxfer_threads_proper (std::string *buffer)
 
   for_each_thread ([&] (thread_info *thread)
     {
-      handle_qxfer_threads_worker (thread, buffer);
+      /* If this is a (v)fork/clone child (has a (v)fork/clone parent),
+	 GDB does not yet know about this thread, and must not know
+	 about it until it gets the corresponding (v)fork/clone event.
+	 Exclude this thread from the list, and report it as new in the
+	 next delta.  */
+      if (target_thread_pending_parent (thread) != nullptr)
+	{
+	  thread->list_generation = generation;
+	  return;
+	}
+
+      if (delta && thread->list_generation < *since)
+	return;
+
+      ptid_t ptid = ptid_of (thread);
+      handle_qxfer_threads_worker (thread, target_core_of_thread (ptid),
+				   target_thread_name (ptid), buffer);
     });
 
   if (non_stop)
     target_unpause_all (true);
 
+  /* A thread added and removed since the last list is reported as
+     removed too, in case GDB learned about it from an event.  */
+  if (delta)
+    for (ptid_t ptid : cs.threads_removed_since_list)
+      {
+	char ptid_s[100];
+
+	write_ptid (ptid_s, ptid);
+	string_xml_appendf (*buffer, "<removed id=\"%s\"/>\n", ptid_s);
+      }
+
+  cs.threads_removed_since_list.clear ();
+  cs.thread_list_generation = generation;
+
   *buffer += "</threads>\n";
   return true;
 }
 
-/* Handle qXfer:threads:read.  */
+/* Handle qXfer:threads:read.  The annex is either empty, to read the
+   whole thread list, or the hex generation of a thread list GDB read
+   earlier, to read only the changes since.  */
 
 static int
 handle_qxfer_threads (const char *annex,
@@ -2068,12 +2154,22 @@ handle_qxfer_threads (const char *annex,
 		      ULONGEST offset, LONGEST len)
 {
   static std::string result;
+  std::optional<ULONGEST> since;
 
   if (writebuf != NULL)
     return -2;
 
   if (annex[0] != '\0')
-    return -1;
+    {
+      ULONGEST generation;
+
+      /* The annex is the generation of an earlier thread list.  Any
+	 other annex is an error.  */
+      annex = unpack_varlen_hex (annex, &generation);
+      if (annex[0] != '\0')
+	return -1;
+      since = generation;
+    }
 
   if (offset == 0)
     {
@@ -2081,7 +2177,7 @@ handle_qxfer_threads (const char *annex,
 	 'result'.  Successive reads will be served off 'result'.  */
       result.clear ();
 
-      bool res = handle_qxfer_threads_proper (&result);
+      bool res = handle_qxfer_threads_proper (&result, since);
 
       if (!res)
 	return -1;
@@ -2787,6 +2883,7 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	strcat (own_buf, ";QDisableRandomization+");
 
       strcat (own_buf, ";qXfer:threads:read+");
+      strcat (own_buf, ";ThreadListDelta+");
 
       if (target_supports_tracepoints ())
 	{
@@ -2809,6 +2906,9 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	  || target_supports_software_single_step () )
 	{
 	  strcat (own_buf, ";ConditionalBreakpoints+");
+	  if (gdb_supports_qRelocInsn && target_supports_tracepoints ()
+	      && target_supports_fast_tracepoints ())
+	    strcat (own_buf, ";FastConditionalBreakpoints+");
 	}
       strcat (own_buf, ";BreakpointCommands+");
 
@@ -2841,6 +2941,17 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 
       strcat (own_buf, ";no-resumed+");
 
+      strcat (own_buf, ";binary-upload+;vReadMemory+;vReadRegisters+");
+
+#ifdef HAVE_LIBZ
+      strcat (own_buf, ";QCompress+");
+#endif
+
+      /* GDBserver handles packets one at a time, in the order they
+	 arrive, so GDB may send several vFile:pread requests before
+	 reading the replies.  */
+      strcat (own_buf, ";vFile:pread-window=8");
+
       if (target_supports_memory_tagging ())
 	strcat (own_buf, ";memory-tagging+");
 
@@ -3491,6 +3602,162 @@ handle_v_kill (char *own_buf)
     write_enn (own_buf);
 }
 
+/* Handle a "vReadMemory:ADDR,LENGTH;ADDR,LENGTH..." request.  Reply
+   with 'b', the number of bytes read from the start of each range,
+   separated by commas, then ';' and the data of all the ranges in
+   binary.  If the data doesn't all fit in the reply, the last range
+   reported may be short and the ranges after it left out.  */
+
+static void
+handle_v_read_memory (char *own_buf, int *new_packet_len)
+{
+  const char *p = own_buf + strlen ("vReadMemory:");
+  std::vector<std::pair<CORE_ADDR, ULONGEST>> ranges;
+
+  while (*p != '\0')
+    {
+      ULONGEST addr, len;
+
+      p = unpack_varlen_hex (p, &addr);
+      if (*p != ',')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      p = unpack_varlen_hex (p + 1, &len);
+      if (*p == ';')
+	p++;
+      else if (*p != '\0')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      ranges.emplace_back (addr, len);
+    }
+
+  /* Leave room for the 'b', the ';' and the longest possible length
+     and separator for each range.  */
+  const size_t overhead = 2 + 2;
+  const size_t per_range = 2 * sizeof (ULONGEST) + 1;
+  if (ranges.empty ()
+      || ranges.size () >= (PBUFSIZ - overhead) / per_range)
+    {
+      write_enn (own_buf);
+      return;
+    }
+  size_t room = PBUFSIZ - overhead - ranges.size () * per_range;
+
+  gdb::byte_vector data (room);
+  gdb::byte_vector raw;
+  std::string header = "b";
+  size_t data_len = 0;
+
+  for (const auto &[addr, len] : ranges)
+    {
+      if (data_len >= room)
+	break;
+
+      /* ROOM is below PBUFSIZ, so all the sizes below fit in an int.  */
+      raw.resize (std::min (len, (ULONGEST) (room - data_len)));
+      int res = gdb_read_memory (addr, raw.data (), raw.size ());
+      if (res < 0)
+	res = 0;
+
+      int out_len;
+      data_len += remote_escape_output (raw.data (), res, 1,
+					data.data () + data_len, &out_len,
+					room - data_len);
+
+      if (header.size () > 1)
+	header += ',';
+      header += phex_nz (out_len, sizeof (out_len));
+
+      /* Stop if the escaped data filled the reply.  */
+      if (out_len < res)
+	break;
+    }
+
+  header += ';';
+  memcpy (own_buf, header.data (), header.size ());
+  memcpy (own_buf + header.size (), data.data (), data_len);
+  *new_packet_len = header.size () + data_len;
+}
+
+/* Handle a "vReadRegisters:THREAD-ID;THREAD-ID..." request.  Reply
+   with the registers of each thread in 'g' packet format, separated
+   by ';'.  The registers of a thread that doesn't exist or isn't
+   stopped are left empty.  If the registers don't all fit in the
+   reply, the threads after the last one that fits are left out.  */
+
+static void
+handle_v_read_registers (char *own_buf)
+{
+  client_state &cs = get_client_state ();
+  const char *p = own_buf + strlen ("vReadRegisters:");
+  std::vector<ptid_t> ptids;
+
+  while (*p != '\0')
+    {
+      ptids.push_back (read_ptid (p, &p));
+      if (*p == ';')
+	p++;
+      else if (*p != '\0')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+    }
+
+  if (ptids.empty () || cs.current_traceframe >= 0)
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  std::string reply;
+  std::vector<char> regs;
+  bool first = true;
+
+  for (ptid_t ptid : ptids)
+    {
+      thread_info *thread = find_thread_ptid (ptid);
+      const char *thread_regs = "";
+
+      if (thread != nullptr
+	  && (!the_target->supports_thread_stopped ()
+	      || target_thread_stopped (thread)))
+	{
+	  try
+	    {
+	      struct regcache *regcache = get_thread_regcache (thread, 1);
+
+	      regs.resize (regcache->tdesc->registers_size * 2 + 1);
+	      registers_to_string (regcache, regs.data ());
+	      thread_regs = regs.data ();
+	    }
+	  catch (const gdb_exception_error &exception)
+	    {
+	    }
+	}
+
+      size_t len = (first ? 0 : 1) + strlen (thread_regs);
+      if (reply.size () + len >= PBUFSIZ)
+	break;
+
+      if (!first)
+	reply += ';';
+      reply += thread_regs;
+      first = false;
+    }
+
+  /* An empty reply would mean the packet isn't supported.  */
+  if (reply.empty ())
+    write_enn (own_buf);
+  else
+    strcpy (own_buf, reply.c_str ());
+}
+
 /* Handle all of the extended 'v' packets.  */
 void
 handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
@@ -3537,6 +3804,20 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
 	}
     }
 
+  if (startswith (own_buf, "vReadMemory:"))
+    {
+      require_running_or_return (own_buf);
+      handle_v_read_memory (own_buf, new_packet_len);
+      return;
+    }
+
+  if (startswith (own_buf, "vReadRegisters:"))
+    {
+      require_running_or_return (own_buf);
+      handle_v_read_registers (own_buf);
+      return;
+    }
+
   if (startswith (own_buf, "vFile:")
       && handle_vFile (own_buf, packet_len, new_packet_len))
     return;
@@ -4506,6 +4787,7 @@ process_point_options (struct gdb_breakpoint *bp, const char **packet)
 {
   const char *dataptr = *packet;
   int persist;
+  ULONGEST orig_size = 0;
 
   /* Check if data has the correct format.  */
   if (*dataptr != ';')
@@ -4534,6 +4816,14 @@ process_point_options (struct gdb_breakpoint *bp, const char **packet)
 	  if (add_breakpoint_commands (bp, &dataptr, persist))
 	    dataptr = strchrnul (dataptr, ';');
 	}
+      else if (*dataptr == 'F')
+	{
+	  /* Length of the instruction at the breakpoint address, for
+	     installing the breakpoint as a jump pad.  */
+	  dataptr = unpack_varlen_hex (dataptr + 1, &orig_size);
+	  threads_debug_printf ("Found breakpoint instruction length %s.",
+				pulongest (orig_size));
+	}
       else
 	{
 	  fprintf (stderr, "Unknown token %c, ignoring.\n",
@@ -4542,6 +4832,10 @@ process_point_options (struct gdb_breakpoint *bp, const char **packet)
 	  dataptr = strchrnul (dataptr, ';');
 	}
     }
+
+  if (orig_size != 0)
+    set_gdb_breakpoint_jump_pad (bp, orig_size);
+
   *packet = dataptr;
 }
 
@@ -4709,6 +5003,30 @@ process_serial_event (void)
 	  bin2hex (mem_buf, cs.own_buf, res);
       }
       break;
+    case 'x':
+      {
+	require_running_or_break (cs.own_buf);
+	decode_m_packet (&cs.own_buf[1], &mem_addr, &len);
+	/* MEM_BUF is PBUFSIZ bytes; the escaped reply can never carry
+	   more than that anyway.  */
+	len = std::min (len, (unsigned int) PBUFSIZ - 2);
+	int res = gdb_read_memory (mem_addr, mem_buf, len);
+	if (res < 0)
+	  write_enn (cs.own_buf);
+	else
+	  {
+	    int out_len_units;
+
+	    /* Send as much of the data as fits after escaping; GDB
+	       handles the short read.  */
+	    cs.own_buf[0] = 'b';
+	    new_packet_len
+	      = remote_escape_output (mem_buf, res, 1,
+				      (gdb_byte *) cs.own_buf + 1,
+				      &out_len_units, PBUFSIZ - 2) + 1;
+	  }
+      }
+      break;
     case 'M':
       require_running_or_break (cs.own_buf);
       decode_M_packet (&cs.own_buf[1], &mem_addr, &len, &mem_buf);
@@ -4901,6 +5219,13 @@ process_serial_event (void)
 
   response_needed = false;
 
+  if (compress_output_requested)
+    {
+      compress_output_requested = false;
+      if (!remote_compress_output ())
+	error ("Could not initialize output compression");
+    }
+
   if (exit_requested)
     return -1;
 
@@ -87,6 +87,12 @@ extern void handle_target_event (int err, gdb_client_data client_data);
 /* Get rid of the currently pending stop replies that match PTID.  */
 extern void discard_queued_stop_replies (ptid_t ptid);
 
+/* Record that THREAD was just added, or that the thread PTID was just
+   removed, so that the next thread list delta reports it.  */
+struct thread_info;
+extern void thread_list_note_added (thread_info *thread);
+extern void thread_list_note_removed (ptid_t ptid);
+
 /* Returns true if there's a pending stop reply that matches PTID in
    the vStopped notifications queue.  */
 extern int in_queued_stop_replies (ptid_t ptid);
@@ -197,6 +203,14 @@ struct client_state
      are not supported with qRcmd and m packets, but are still supported
      everywhere else.  This is for backward compatibility reasons.  */
   bool error_message_supported = false;
+
+  /* The generation of the last thread list reported with
+     qXfer:threads:read, or 0 if none was.  GDB passes it in the annex
+     of the next request to get only the changes since.  */
+  ULONGEST thread_list_generation = 0;
+
+  /* The threads removed since the last thread list was reported.  */
+  std::vector<ptid_t> threads_removed_since_list;
 };
 
 client_state &get_client_state ();
@@ -674,12 +674,32 @@ process_stratum_target::get_min_fast_tracepoint_insn_len ()
   return 0;
 }
 
+bool
+process_stratum_target::supports_breakpoint_jump_pads ()
+{
+  return false;
+}
+
+int
+process_stratum_target::fetch_jump_pad_registers (struct regcache *regcache,
+						  CORE_ADDR regs)
+{
+  gdb_assert_not_reached ("target op fetch_jump_pad_registers "
+			  "not supported");
+}
+
 struct emit_ops *
 process_stratum_target::emit_ops ()
 {
   return nullptr;
 }
 
+struct emit_ops *
+process_stratum_target::host_emit_ops ()
+{
+  return nullptr;
+}
+
 bool
 process_stratum_target::supports_disable_randomization ()
 {
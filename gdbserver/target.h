@@ -374,10 +374,27 @@ class process_stratum_target
      overwritten for use as a fast tracepoint.  */
   virtual int get_min_fast_tracepoint_insn_len ();
 
+  /* Return true if the fetch_jump_pad_registers op is supported, in
+     which case GDB breakpoints may be installed as fast tracepoint
+     jump pads that evaluate their conditions in the inferior.  */
+  virtual bool supports_breakpoint_jump_pads ();
+
+  /* Supply REGCACHE with the registers that a fast tracepoint jump
+     pad saved in the register block at REGS, in the inferior.  This
+     recovers the registers the thread had when it entered the jump
+     pad.  Returns 0 on success, non-zero on failure.  */
+  virtual int fetch_jump_pad_registers (struct regcache *regcache,
+					CORE_ADDR regs);
+
   /* Return the bytecode operations vector for the current inferior.
      Returns nullptr if bytecode compilation is not supported.  */
   virtual struct emit_ops *emit_ops ();
 
+  /* Return the bytecode operations vector producing code that runs
+     inside GDBserver itself, for evaluating agent expressions against
+     the current inferior.  Returns nullptr if not supported.  */
+  virtual struct emit_ops *host_emit_ops ();
+
   /* Returns true if the target supports disabling randomization.  */
   virtual bool supports_disable_randomization ();
 
@@ -590,6 +607,12 @@ int kill_inferior (process_info *proc);
 #define target_get_min_fast_tracepoint_insn_len()	\
   the_target->get_min_fast_tracepoint_insn_len ()
 
+#define target_supports_breakpoint_jump_pads()		\
+  the_target->supports_breakpoint_jump_pads ()
+
+#define target_fetch_jump_pad_registers(regcache, regs)	\
+  the_target->fetch_jump_pad_registers (regcache, regs)
+
 #define target_thread_stopped(thread) \
   the_target->thread_stopped (thread)
 
@@ -626,6 +649,9 @@ int kill_inferior (process_info *proc);
 #define target_emit_ops() \
   the_target->emit_ops ()
 
+#define target_host_emit_ops() \
+  the_target->host_emit_ops ()
+
 #define target_supports_disable_randomization() \
   the_target->supports_disable_randomization ()
 
@@ -129,6 +129,12 @@ trace_vdebug (const char *fmt, ...)
 # define helper_thread_id IPA_SYM_EXPORTED_NAME (helper_thread_id)
 # define cmd_buf IPA_SYM_EXPORTED_NAME (cmd_buf)
 # define ipa_tdesc_idx IPA_SYM_EXPORTED_NAME (ipa_tdesc_idx)
+# define gdb_check_breakpoint_condition_ptr \
+  IPA_SYM_EXPORTED_NAME (gdb_check_breakpoint_condition_ptr)
+# define breakpoint_condition_true \
+  IPA_SYM_EXPORTED_NAME (breakpoint_condition_true)
+# define breakpoint_condition_regs \
+  IPA_SYM_EXPORTED_NAME (breakpoint_condition_regs)
 #endif
 
 #ifndef IN_PROCESS_AGENT
@@ -167,6 +173,9 @@ struct ipa_sym_addresses
   CORE_ADDR addr_set_trace_state_variable_value_ptr;
   CORE_ADDR addr_ust_loaded;
   CORE_ADDR addr_ipa_tdesc_idx;
+  CORE_ADDR addr_gdb_check_breakpoint_condition_ptr;
+  CORE_ADDR addr_breakpoint_condition_true;
+  CORE_ADDR addr_breakpoint_condition_regs;
 };
 
 static struct
@@ -204,6 +213,9 @@ static struct
   IPA_SYM(set_trace_state_variable_value_ptr),
   IPA_SYM(ust_loaded),
   IPA_SYM(ipa_tdesc_idx),
+  IPA_SYM(gdb_check_breakpoint_condition_ptr),
+  IPA_SYM(breakpoint_condition_true),
+  IPA_SYM(breakpoint_condition_regs),
 };
 
 static struct ipa_sym_addresses ipa_sym_addrs;
@@ -383,6 +395,16 @@ flush_trace_buffer (void)
   UNKNOWN_SIDE_EFFECTS();
 }
 
+/* This is needed for -Wmissing-declarations.  */
+IP_AGENT_EXPORT_FUNC void breakpoint_condition_true (void);
+
+IP_AGENT_EXPORT_FUNC void
+breakpoint_condition_true (void)
+{
+  /* GDBserver places breakpoint here.  */
+  UNKNOWN_SIDE_EFFECTS();
+}
+
 #endif
 
 #ifndef IN_PROCESS_AGENT
@@ -462,6 +484,7 @@ write_inferior_uinteger (CORE_ADDR symaddr, unsigned int val)
 }
 
 static CORE_ADDR target_malloc (ULONGEST size);
+static void reset_target_heap (void);
 
 #define COPY_FIELD_TO_BUF(BUF, OBJ, FIELD)	\
   do {							\
@@ -3076,6 +3099,10 @@ install_fast_tracepoint (struct tracepoint *tpoint, char *errbuf)
       return 0;
     }
 
+  /* The fast tracepoint's jump can't share the address with a
+     breakpoint's.  */
+  remove_gdb_breakpoint_jump_pads_at (tpoint->address);
+
   if (read_inferior_data_pointer (ipa_sym_addrs.addr_gdb_collect_ptr,
 				  &collect))
     {
@@ -3117,6 +3144,288 @@ install_fast_tracepoint (struct tracepoint *tpoint, char *errbuf)
   return 0;
 }
 
+static void download_tracepoint_1 (struct tracepoint *tpoint);
+
+/* A jump pad that evaluates the condition of a GDB breakpoint in the
+   inferior, so that the thread only traps when the condition is
+   true.  Jump pads are built like those of fast tracepoints, but call
+   gdb_check_breakpoint_condition instead of gdb_collect.  Each process
+   has its own list of jump pads.
+
+   Removing a breakpoint releases its jump pad.  GDB removes and
+   reinserts its breakpoints around every stop in all-stop mode, so the
+   last MAX_UNUSED_BREAKPOINT_JUMP_PADS released jump pads are kept,
+   and a breakpoint with the same condition at the same address reuses
+   its jump pad.  The space a jump pad takes in the in-process agent's
+   buffers is not reclaimed when it is freed.  */
+
+#define MAX_UNUSED_BREAKPOINT_JUMP_PADS 16
+
+struct breakpoint_jump_pad
+{
+  /* The fast tracepoint that describes the jump pad to the in-process
+     agent, and to fast_tracepoint_collecting.  It is never part of
+     the tracepoints list.  */
+  struct tracepoint tpoint;
+
+  /* True if the jump pad was built.  False if the condition could not
+     be compiled or the jump pad could not be built, in which case the
+     breakpoint remains a breakpoint instruction.  */
+  bool usable;
+
+  /* The jump to the jump pad, to write at the breakpoint address.  */
+  unsigned char jump_insn[MAX_JUMP_SIZE];
+  ULONGEST jump_insn_size;
+
+  /* The number of GDB breakpoints installed as a jump to this jump
+     pad.  */
+  int refcount;
+
+  struct breakpoint_jump_pad *next;
+};
+
+/* Free the GDBserver side of jump pad JP.  */
+
+static void
+free_breakpoint_jump_pad (struct breakpoint_jump_pad *jp)
+{
+  gdb_free_agent_expr (jp->tpoint.cond);
+  free (jp);
+}
+
+/* Free the oldest jump pads of PROC no breakpoint uses, keeping at most
+   MAX_UNUSED_BREAKPOINT_JUMP_PADS of them.  */
+
+static void
+trim_breakpoint_jump_pads (struct process_info *proc)
+{
+  struct breakpoint_jump_pad **link = &proc->breakpoint_jump_pads;
+  int unused = 0;
+
+  while (*link != NULL)
+    {
+      struct breakpoint_jump_pad *jp = *link;
+
+      if (jp->refcount == 0 && ++unused > MAX_UNUSED_BREAKPOINT_JUMP_PADS)
+	{
+	  *link = jp->next;
+	  free_breakpoint_jump_pad (jp);
+	}
+      else
+	link = &jp->next;
+    }
+}
+
+/* Build a jump pad at ADDRESS evaluating COND, and add it to the jump
+   pads of PROC.  */
+
+static struct breakpoint_jump_pad *
+build_breakpoint_jump_pad (struct process_info *proc, CORE_ADDR address,
+			   ULONGEST orig_size, struct agent_expr *cond)
+{
+  struct breakpoint_jump_pad *jp = XCNEW (struct breakpoint_jump_pad);
+  CORE_ADDR jentry, jump_entry;
+  CORE_ADDR trampoline = 0;
+  ULONGEST trampoline_size = 0;
+  CORE_ADDR check;
+  char errbuf[IPA_BUFSIZ];
+
+  jp->tpoint.address = address;
+  jp->tpoint.type = fast_tracepoint;
+  jp->tpoint.enabled = 1;
+  jp->tpoint.orig_size = orig_size;
+  jp->tpoint.cond = XNEW (struct agent_expr);
+  jp->tpoint.cond->length = cond->length;
+  jp->tpoint.cond->bytes = (unsigned char *) xmalloc (cond->length);
+  memcpy (jp->tpoint.cond->bytes, cond->bytes, cond->length);
+
+  jp->next = proc->breakpoint_jump_pads;
+  proc->breakpoint_jump_pads = jp;
+
+  /* This compiles the condition into the jump pad buffer.  */
+  download_tracepoint_1 (&jp->tpoint);
+  if (jp->tpoint.compiled_cond == 0)
+    {
+      trace_debug ("Could not compile the condition of the breakpoint "
+		   "at %s", paddress (address));
+      return jp;
+    }
+
+  if (read_inferior_data_pointer
+	(ipa_sym_addrs.addr_gdb_check_breakpoint_condition_ptr, &check))
+    {
+      warning ("error extracting gdb_check_breakpoint_condition_ptr");
+      return jp;
+    }
+
+  if (!breakpoint_here (ipa_sym_addrs.addr_breakpoint_condition_true)
+      && set_breakpoint_at (ipa_sym_addrs.addr_breakpoint_condition_true,
+			    NULL) == NULL)
+    {
+      warning ("Could not set breakpoint at breakpoint_condition_true");
+      return jp;
+    }
+
+  jentry = jump_entry = get_jump_space_head ();
+
+  errbuf[0] = '\0';
+  if (target_install_fast_tracepoint_jump_pad
+	(jp->tpoint.obj_addr_on_target, address, check,
+	 ipa_sym_addrs.addr_collecting, orig_size, &jentry,
+	 &trampoline, &trampoline_size, jp->jump_insn, &jp->jump_insn_size,
+	 &jp->tpoint.adjusted_insn_addr, &jp->tpoint.adjusted_insn_addr_end,
+	 errbuf))
+    {
+      trace_debug ("Could not build a jump pad for the breakpoint at %s: %s",
+		   paddress (address), errbuf);
+      return jp;
+    }
+
+  jp->tpoint.jump_pad = jump_entry;
+  jp->tpoint.jump_pad_end = jentry;
+  jp->tpoint.trampoline = trampoline;
+  jp->tpoint.trampoline_end = trampoline + trampoline_size;
+  jp->usable = true;
+
+  /* Pad to 8-byte alignment.  */
+  jentry = ((jentry + 7) & ~0x7);
+  claim_jump_space (jentry - jump_entry);
+
+  return jp;
+}
+
+/* See tracepoint.h.  */
+
+struct fast_tracepoint_jump *
+install_breakpoint_jump_pad (CORE_ADDR address, ULONGEST orig_size,
+			     struct agent_expr *cond,
+			     struct breakpoint_jump_pad **pad)
+{
+  struct process_info *proc = current_process ();
+  struct breakpoint_jump_pad *jp, **link;
+  struct fast_tracepoint_jump *jump;
+
+  /* A fast tracepoint's jump at the same address would take over
+     ours.  */
+  if (!agent_loaded_p ()
+      || !target_supports_breakpoint_jump_pads ()
+      || target_emit_ops () == NULL
+      || orig_size < target_get_min_fast_tracepoint_insn_len ()
+      || fast_tracepoint_jump_here (address))
+    return NULL;
+
+  for (link = &proc->breakpoint_jump_pads; *link != NULL;
+       link = &(*link)->next)
+    {
+      jp = *link;
+      if (jp->tpoint.address == address
+	  && jp->tpoint.orig_size == orig_size
+	  && jp->tpoint.cond->length == cond->length
+	  && memcmp (jp->tpoint.cond->bytes, cond->bytes, cond->length) == 0)
+	break;
+    }
+
+  if (*link != NULL)
+    {
+      /* Move it to the front, so that the jump pads freed first are
+	 those unused for the longest time.  */
+      jp = *link;
+      *link = jp->next;
+      jp->next = proc->breakpoint_jump_pads;
+      proc->breakpoint_jump_pads = jp;
+    }
+  else
+    {
+      jp = build_breakpoint_jump_pad (proc, address, orig_size, cond);
+      trim_breakpoint_jump_pads (proc);
+    }
+
+  if (!jp->usable)
+    return NULL;
+
+  trace_debug ("Installing the jump pad of the breakpoint at %s",
+	       paddress (address));
+  jump = set_fast_tracepoint_jump (address, jp->jump_insn,
+				   jp->jump_insn_size);
+  if (jump == NULL)
+    return NULL;
+
+  jp->refcount++;
+  *pad = jp;
+  return jump;
+}
+
+/* See tracepoint.h.  */
+
+void
+release_breakpoint_jump_pad (struct breakpoint_jump_pad *pad)
+{
+  gdb_assert (pad->refcount > 0);
+  pad->refcount--;
+  trim_breakpoint_jump_pads (current_process ());
+}
+
+/* See tracepoint.h.  */
+
+void
+free_breakpoint_jump_pads (struct process_info *proc)
+{
+  while (proc->breakpoint_jump_pads != NULL)
+    {
+      struct breakpoint_jump_pad *jp = proc->breakpoint_jump_pads;
+
+      proc->breakpoint_jump_pads = jp->next;
+      free_breakpoint_jump_pad (jp);
+    }
+
+  /* The in-process agent and its buffers will be at other addresses
+     in the next process, if it is loaded there at all.  Look it up
+     again when GDB tells us about new symbols.  */
+  if (all_processes.size () == 1 && all_processes.front () == proc)
+    {
+      gdb_jump_pad_head = 0;
+      trampoline_buffer_head = 0;
+      reset_target_heap ();
+      agent_forget_symbols ();
+    }
+}
+
+/* See tracepoint.h.  */
+
+int
+breakpoint_jump_pad_hit (struct thread_info *tinfo, CORE_ADDR *stop_pc)
+{
+  struct regcache *regcache;
+  CORE_ADDR regs;
+
+  if (!agent_loaded_p ()
+      || *stop_pc != ipa_sym_addrs.addr_breakpoint_condition_true)
+    return 0;
+
+  if (read_inferior_data_pointer (ipa_sym_addrs.addr_breakpoint_condition_regs,
+				  &regs))
+    {
+      warning ("error extracting breakpoint_condition_regs");
+      return 0;
+    }
+
+  /* Recover the registers the thread had at the breakpoint address,
+     and leave the jump pad for good.  */
+  regcache = get_thread_regcache (tinfo, 1);
+  if (target_fetch_jump_pad_registers (regcache, regs) != 0)
+    {
+      warning ("Could not read the registers saved by a breakpoint "
+	       "jump pad");
+      return 0;
+    }
+  force_unlock_trace_buffer ();
+
+  *stop_pc = regcache_read_pc (regcache);
+  trace_debug ("Condition of the breakpoint at %s is true",
+	       paddress (*stop_pc));
+  return 1;
+}
+
 
 /* Install tracepoint TPOINT, and write reply message in OWN_BUF.  */
 
@@ -3175,8 +3484,6 @@ install_tracepoint (struct tracepoint *tpoint, char *own_buf)
     write_ok (own_buf);
 }
 
-static void download_tracepoint_1 (struct tracepoint *tpoint);
-
 static void
 cmd_qtstart (char *packet)
 {
@@ -5459,12 +5766,18 @@ static struct tracepoint *
 fast_tracepoint_from_jump_pad_address (CORE_ADDR pc)
 {
   struct tracepoint *tpoint;
+  struct breakpoint_jump_pad *jp;
 
   for (tpoint = tracepoints; tpoint; tpoint = tpoint->next)
     if (tpoint->type == fast_tracepoint)
       if (tpoint->jump_pad <= pc && pc < tpoint->jump_pad_end)
 	return tpoint;
 
+  for (jp = current_process ()->breakpoint_jump_pads; jp != NULL;
+       jp = jp->next)
+    if (jp->tpoint.jump_pad <= pc && pc < jp->tpoint.jump_pad_end)
+      return &jp->tpoint;
+
   return NULL;
 }
 
@@ -5474,6 +5787,7 @@ static struct tracepoint *
 fast_tracepoint_from_trampoline_address (CORE_ADDR pc)
 {
   struct tracepoint *tpoint;
+  struct breakpoint_jump_pad *jp;
 
   for (tpoint = tracepoints; tpoint; tpoint = tpoint->next)
     {
@@ -5482,6 +5796,11 @@ fast_tracepoint_from_trampoline_address (CORE_ADDR pc)
 	return tpoint;
     }
 
+  for (jp = current_process ()->breakpoint_jump_pads; jp != NULL;
+       jp = jp->next)
+    if (jp->tpoint.trampoline <= pc && pc < jp->tpoint.trampoline_end)
+      return &jp->tpoint;
+
   return NULL;
 }
 
@@ -5493,12 +5812,18 @@ static struct tracepoint *
 fast_tracepoint_from_ipa_tpoint_address (CORE_ADDR ipa_tpoint_obj)
 {
   struct tracepoint *tpoint;
+  struct breakpoint_jump_pad *jp;
 
   for (tpoint = tracepoints; tpoint; tpoint = tpoint->next)
     if (tpoint->type == fast_tracepoint)
       if (tpoint->obj_addr_on_target == ipa_tpoint_obj)
 	return tpoint;
 
+  for (jp = current_process ()->breakpoint_jump_pads; jp != NULL;
+       jp = jp->next)
+    if (jp->tpoint.obj_addr_on_target == ipa_tpoint_obj)
+      return &jp->tpoint;
+
   return NULL;
 }
 
@@ -5829,18 +6154,58 @@ gdb_collect (struct tracepoint *tpoint, unsigned char *regs)
     }
 }
 
+extern "C" {
+/* The register block saved by the jump pad of the breakpoint whose
+   condition was last found true.  GDBserver reads it when it handles
+   the breakpoint at breakpoint_condition_true.  The thread that set
+   it holds the collect lock until then.  */
+IP_AGENT_EXPORT_VAR unsigned char *breakpoint_condition_regs;
+}
+
+/* This is needed for -Wmissing-declarations.  */
+IP_AGENT_EXPORT_FUNC void gdb_check_breakpoint_condition
+  (struct tracepoint *tpoint, unsigned char *regs);
+
+/* This routine is called from the jump pads that GDBserver installs
+   for GDB breakpoints whose condition it could compile (see
+   install_breakpoint_jump_pad).  TPOINT describes the breakpoint.
+   If the condition is true, or can't be evaluated, report the hit to
+   GDBserver, which moves the thread back to the breakpoint address,
+   as if it had executed a breakpoint instruction there.  Otherwise,
+   return to the jump pad, which executes the relocated instruction
+   and jumps back to the program.  */
+
+IP_AGENT_EXPORT_FUNC void
+gdb_check_breakpoint_condition (struct tracepoint *tpoint,
+				unsigned char *regs)
+{
+  ULONGEST value = 0;
+  enum eval_result_type err;
+
+  err = ((condfn) (uintptr_t) (tpoint->compiled_cond)) (regs, &value);
+  if (err != expr_eval_no_error || value != 0)
+    {
+      breakpoint_condition_regs = regs;
+      breakpoint_condition_true ();
+    }
+}
+
 /* These global variables points to the corresponding functions.  This is
    necessary on powerpc64, where asking for function symbol address from gdb
    results in returning the actual code pointer, instead of the descriptor
    pointer.  */
 
 typedef void (*gdb_collect_ptr_type) (struct tracepoint *, unsigned char *);
+typedef void (*gdb_check_breakpoint_condition_ptr_type) (struct tracepoint *,
+							 unsigned char *);
 typedef ULONGEST (*get_raw_reg_ptr_type) (const unsigned char *, int);
 typedef LONGEST (*get_trace_state_variable_value_ptr_type) (int);
 typedef void (*set_trace_state_variable_value_ptr_type) (int, LONGEST);
 
 extern "C" {
 IP_AGENT_EXPORT_VAR gdb_collect_ptr_type gdb_collect_ptr = gdb_collect;
+IP_AGENT_EXPORT_VAR gdb_check_breakpoint_condition_ptr_type
+  gdb_check_breakpoint_condition_ptr = gdb_check_breakpoint_condition;
 IP_AGENT_EXPORT_VAR get_raw_reg_ptr_type get_raw_reg_ptr = get_raw_reg;
 IP_AGENT_EXPORT_VAR get_trace_state_variable_value_ptr_type
   get_trace_state_variable_value_ptr = get_trace_state_variable_value;
@@ -5971,6 +6336,15 @@ target_malloc (ULONGEST size)
   return ptr;
 }
 
+/* Forget the IPA heap pointer, so that it is read again from the
+   inferior the next time target_malloc is called.  */
+
+static void
+reset_target_heap (void)
+{
+  target_tp_heap = 0;
+}
+
 static CORE_ADDR
 download_agent_expr (struct agent_expr *expr)
 {
@@ -6085,6 +6459,11 @@ tracepoint_send_agent (struct tracepoint *tpoint)
   char *p;
   int i, ret;
 
+  /* The agent relocates the original instruction, which must not be
+     hidden by a breakpoint's jump.  */
+  if (tpoint->type == fast_tracepoint)
+    remove_gdb_breakpoint_jump_pads_at (tpoint->address);
+
   p = buf;
   strcpy (p, "FastTrace:");
   p += 10;
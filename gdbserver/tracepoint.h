@@ -132,6 +132,37 @@ void force_unlock_trace_buffer (void);
 
 int handle_tracepoint_bkpts (struct thread_info *tinfo, CORE_ADDR stop_pc);
 
+struct agent_expr;
+struct fast_tracepoint_jump;
+struct breakpoint_jump_pad;
+
+/* Try to install the GDB breakpoint at ADDRESS, whose only condition
+   is COND, as a jump to a jump pad that evaluates COND in the
+   inferior, using the in-process agent.  ORIG_SIZE is the length of
+   the instruction at ADDRESS.  Returns the jump and stores the jump
+   pad in *PAD, or returns NULL if the breakpoint must remain a
+   breakpoint instruction.  */
+
+struct fast_tracepoint_jump *install_breakpoint_jump_pad
+  (CORE_ADDR address, ULONGEST orig_size, struct agent_expr *cond,
+   struct breakpoint_jump_pad **pad);
+
+/* Release PAD, returned by install_breakpoint_jump_pad, once the
+   breakpoint no longer jumps to it.  */
+
+void release_breakpoint_jump_pad (struct breakpoint_jump_pad *pad);
+
+/* Free all the breakpoint jump pads of PROC, which is going away.  */
+
+void free_breakpoint_jump_pads (struct process_info *proc);
+
+/* Check if the thread TINFO, stopped at *STOP_PC, trapped because a
+   breakpoint jump pad found its condition true.  If so, move the
+   thread back to the breakpoint address, store that address in
+   *STOP_PC, and return true.  */
+
+int breakpoint_jump_pad_hit (struct thread_info *tinfo, CORE_ADDR *stop_pc);
+
 #ifdef IN_PROCESS_AGENT
 void initialize_low_tracepoint (void);
 const struct target_desc *get_ipa_tdesc (int idx);
@@ -106,6 +106,16 @@ agent_look_up_symbols (void *arg)
   return 0;
 }
 
+/* See agent.h.  */
+
+void
+agent_forget_symbols (void)
+{
+  all_agent_symbols_looked_up = false;
+  helper_thread_id = 0;
+  agent_capability_invalidate ();
+}
+
 static unsigned int
 agent_get_helper_thread_id (void)
 {
@@ -26,6 +26,11 @@ int agent_run_command (int pid, char *cmd, int len);
 
 int agent_look_up_symbols (void *);
 
+/* Forget the symbols looked up by agent_look_up_symbols, because the
+   process that has the agent loaded is gone.  */
+
+void agent_forget_symbols (void);
+
 #define IPA_SYM_EXPORTED_NAME(SYM) gdb_agent_ ## SYM
 
 /* Define an entry in an IPA symbol list array.  If IPA_SYM is used, the macro
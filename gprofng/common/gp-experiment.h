@@ -41,6 +41,7 @@
 
 /* File name definitions */
 #define SP_ARCHIVES_DIR         "archives"
+#define SP_CACHE_DIR            "cache"
 #define SP_ARCHIVE_LOG_FILE     "archive.log"
 #define SP_LOG_FILE             "log.xml"
 #define SP_NOTES_FILE           "notes"
@@ -19,6 +19,7 @@
    MA 02110-1301, USA.  */
 
 #include <errno.h>
+#include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -37,7 +38,9 @@
 static hdrv_pcbe_api_t *pcbe_driver = NULL;
 static hdrv_pcbe_api_t hdrv_pcbe_core_api;
 static hdrv_pcbe_api_t hdrv_pcbe_opteron_api;
+static hdrv_pcbe_api_t hdrv_pcbe_sw_api;
 static hdrv_pcbe_api_t *hdrv_pcbe_drivers[] = {
+  &hdrv_pcbe_sw_api,
   &hdrv_pcbe_core_api,
   &hdrv_pcbe_opteron_api,
   NULL
@@ -321,6 +324,15 @@ hwcdrv_gettid (void)
 
 #define NPAGES_PER_BUF  1 // number of pages to be used for perf_event samples
 // must be a power of 2
+#define BATCH_SAMPLE_SZ 1024 // typical size of a sample in batch mode
+#define MAX_BATCH_PCS   256 // maximum depth of the call stack of a sample
+
+/* The clock of the sample times in batch mode, as in __collector_gethrtime */
+#ifdef CLOCK_MONOTONIC_RAW
+#define HWCDRV_CLOCKID  CLOCK_MONOTONIC_RAW
+#else
+#define HWCDRV_CLOCKID  CLOCK_MONOTONIC
+#endif
 
 /*---------------------------------------------------------------------------*/
 
@@ -341,6 +353,7 @@ typedef struct
 { // runtime state of perf_event buffer
   void *buf;                    // pointer to mmapped buffer
   size_t pagesz;                // size of pages
+  size_t npages;                // number of data pages
 } buffer_state_t;
 
 typedef struct
@@ -366,6 +379,7 @@ typedef struct
   counter_state_t *ctr_list;
   int signal_fd;                // fd that caused the most recent signal
   pid_t tid;			// for debugging signal delivery problems
+  volatile int draining;        // batch mode: buffers are being read
 } hdrv_pcl_ctx_t;
 
 /*---------------------------------------------------------------------------*/
@@ -377,6 +391,9 @@ static struct
   int internal_open_called;
   hwcfuncs_tsd_get_fn_t find_vpc_ctx;
   unsigned hwcdef_cnt;      /* number of *active* hardware counters */
+  int sw_only;              /* only software events can be counted */
+  unsigned batch;           /* samples per signal; 0 for one per signal */
+  hwcdrv_sample_fn_t *sample_ftn; /* batch mode: records the samples */
 } hdrv_pcl_state;
 
 static hwcdrv_about_t hdrv_pcl_about = {.cpcN_cpuver = CPUVER_UNDEFINED};
@@ -403,7 +420,7 @@ skip_buf (buffer_state_t *bufstate, size_t sz)
   if (metadata == NULL)
     return -1;
   size_t pgsz = bufstate->pagesz;
-  size_t bufsz = NPAGES_PER_BUF*pgsz;
+  size_t bufsz = bufstate->npages * pgsz;
   uint64_t d_tail = metadata->data_tail;
   uint64_t d_head = metadata->data_head;
 
@@ -424,7 +441,7 @@ read_buf (buffer_state_t *bufstate, void *buf, size_t sz)
   if (metadata == NULL)
     return -1;
   size_t pgsz = bufstate->pagesz;
-  size_t bufsz = NPAGES_PER_BUF*pgsz;
+  size_t bufsz = bufstate->npages * pgsz;
   uint64_t d_tail = metadata->data_tail;
   uint64_t d_head = metadata->data_head;
 
@@ -459,9 +476,10 @@ read_u64 (buffer_state_t *bufstate, uint64_t *value)
 
 static int
 read_sample (counter_state_t *ctr_state, int msgsz, uint64_t *rvalue,
-	     uint64_t *rlost)
+	     uint64_t *rlost, hrtime_t *rtime, uint64_t *pcs, int *rnpcs)
 {
   // returns count of bytes read
+  // rtime, pcs and rnpcs are only set in batch mode
   buffer_state_t *bufstate = &ctr_state->buf_state;
   counter_value_state_t *cntstate = &ctr_state->value_state;
   int readsz = 0;
@@ -473,6 +491,16 @@ read_sample (counter_state_t *ctr_state, int msgsz, uint64_t *rvalue,
     return -1;
   readsz += sizeof (uint64_t);
 
+  // PERF_SAMPLE_TIME
+  if (hdrv_pcl_state.batch)
+    {
+      uint64_t time = 0;
+      if (read_u64 (bufstate, &time))
+	return -6;
+      readsz += sizeof (uint64_t);
+      *rtime = time;
+    }
+
   // PERF_SAMPLE_READ: value
   uint64_t value = 0;
   rc = read_u64 (bufstate, &value);
@@ -503,6 +531,26 @@ read_sample (counter_state_t *ctr_state, int msgsz, uint64_t *rvalue,
     return -4;
   readsz += sizeof (uint64_t);
 
+  // PERF_SAMPLE_CALLCHAIN: user frames, preceded by a PERF_CONTEXT_USER mark
+  if (hdrv_pcl_state.batch)
+    {
+      uint64_t nr = 0;
+      if (read_u64 (bufstate, &nr))
+	return -7;
+      readsz += sizeof (uint64_t);
+      int npcs = 0;
+      for (uint64_t i = 0; i < nr; i++)
+	{
+	  uint64_t pc;
+	  if (read_u64 (bufstate, &pc))
+	    return -8;
+	  readsz += sizeof (uint64_t);
+	  if (pc < PERF_CONTEXT_MAX && npcs < MAX_BATCH_PCS)
+	    pcs[npcs++] = pc;
+	}
+      *rnpcs = npcs;
+    }
+
   uint64_t value_delta = value - cntstate->prev_value;
   uint64_t enabled_delta = enabled_time - cntstate->prev_ena_ts;
   uint64_t running_delta = running_time - cntstate->prev_run_ts;
@@ -641,6 +689,16 @@ init_perf_event (struct perf_event_attr *hw, uint64_t event, uint64_t period,
 	  // PERF_FORMAT_GROUP		|
 	  0;
 
+  if (hdrv_pcl_state.batch)
+    {
+      // The samples are read long after they are taken
+      hw->sample_type |= PERF_SAMPLE_TIME | PERF_SAMPLE_CALLCHAIN;
+      hw->exclude_callchain_kernel = 1;
+      hw->use_clockid = 1;
+      hw->clockid = HWCDRV_CLOCKID;
+      hw->wakeup_events = hdrv_pcl_state.batch;
+    }
+
   // Note: the following override config.priv bits!
   hw->exclude_user = (event & (1 << 16)) == 0;      /* don't count user */
   hw->exclude_kernel = (event & (1 << 17)) == 0;    /* ditto kernel */
@@ -665,7 +723,11 @@ start_one_ctr (int ii, size_t pgsz, hdrv_pcl_ctx_t * pctx, char *error_string)
       return 1;
     }
 
-  size_t buffer_area_sz = (NPAGES_PER_BUF + 1) * pgsz; // add a page for metadata
+  size_t npages = NPAGES_PER_BUF;
+  if (hdrv_pcl_state.batch) // room for two batches
+    while (npages * pgsz < 2 * hdrv_pcl_state.batch * BATCH_SAMPLE_SZ)
+      npages *= 2;
+  size_t buffer_area_sz = (npages + 1) * pgsz; // add a page for metadata
   void * buf = mmap (NULL, buffer_area_sz, //YXXX is this a safe call?
 		     PROT_READ | PROT_WRITE, MAP_SHARED, hwc_fd, 0);
   if (buf == MAP_FAILED)
@@ -678,6 +740,7 @@ start_one_ctr (int ii, size_t pgsz, hdrv_pcl_ctx_t * pctx, char *error_string)
   pctx->ctr_list[ii].fd = hwc_fd;
   pctx->ctr_list[ii].buf_state.buf = buf;
   pctx->ctr_list[ii].buf_state.pagesz = pgsz;
+  pctx->ctr_list[ii].buf_state.npages = npages;
   pctx->ctr_list[ii].value_state.prev_ena_ts = 0;
   pctx->ctr_list[ii].value_state.prev_run_ts = 0;
   pctx->ctr_list[ii].value_state.prev_value = 0;
@@ -725,6 +788,75 @@ start_one_ctr (int ii, size_t pgsz, hdrv_pcl_ctx_t * pctx, char *error_string)
   return 0;
 }
 
+/* Batch mode: pass the samples in the buffer of counter IDX to
+   hdrv_pcl_state.sample_ftn.  Return the number of samples, and the time
+   of the last one in *LAST_TS.  */
+static int
+drain_samples (int idx, counter_state_t *ctr_state, hrtime_t *last_ts)
+{
+  buffer_state_t *bufstate = &ctr_state->buf_state;
+  uint64_t pcs[MAX_BATCH_PCS];
+  int nsamples = 0;
+  for (;;)
+    {
+      struct perf_event_mmap_page *metadata = bufstate->buf;
+      if (metadata == NULL || metadata->data_tail == metadata->data_head)
+	break;
+      __sync_synchronize (); // read data_head before the records
+
+      struct perf_event_header sheader;
+      if (read_buf (bufstate, &sheader, sizeof (sheader)))
+	break;
+      size_t datasz = sheader.size - sizeof (struct perf_event_header);
+      if (sheader.type == PERF_RECORD_SAMPLE)
+	{
+	  uint64_t value, lost;
+	  hrtime_t ts;
+	  int npcs;
+	  if (read_sample (ctr_state, datasz, &value, &lost, &ts, pcs, &npcs))
+	    {
+	      TprintfT (DBG_LT0, "hwcdrv: ERROR: drain_samples:"
+			" read_sample() failed\n");
+	      reset_buf (bufstate);
+	      break;
+	    }
+	  nsamples++;
+	  *last_ts = ts;
+	  hdrv_pcl_state.sample_ftn (idx, ts, value, lost, pcs, npcs);
+	}
+      else if (sheader.type == PERF_RECORD_LOST)
+	{
+	  // the buffer was full: record the counts of the lost samples
+	  struct
+	  {
+	    uint64_t id;
+	    uint64_t lost;
+	  } rec;
+	  if (datasz < sizeof (rec) || read_buf (bufstate, &rec, sizeof (rec))
+	      || (datasz > sizeof (rec)
+		  && skip_buf (bufstate, datasz - sizeof (rec))))
+	    break;
+	  hdrv_pcl_state.sample_ftn (idx, gethrtime (), 0,
+				     rec.lost * ctr_state->last_overflow_period,
+				     NULL, 0);
+	}
+      else if (skip_buf (bufstate, datasz))
+	break;
+    }
+  return nsamples;
+}
+
+/* Batch mode: stop counter II and pass the samples left in its buffer.  */
+static void
+flush_one_ctr (int ii, counter_state_t *ctr_list)
+{
+  hrtime_t last_ts;
+  if (ctr_list[ii].buf_state.buf == NULL)
+    return;
+  ioctl (ctr_list[ii].fd, PERF_EVENT_IOC_DISABLE, 1);
+  drain_samples (ii, &ctr_list[ii], &last_ts);
+}
+
 static int
 stop_one_ctr (int ii, counter_state_t *ctr_list)
 {
@@ -737,7 +869,8 @@ stop_one_ctr (int ii, counter_state_t *ctr_list)
   void *buf = ctr_list[ii].buf_state.buf;
   if (buf)
     {
-      size_t bufsz = (NPAGES_PER_BUF + 1) * ctr_list[ii].buf_state.pagesz;
+      size_t bufsz = (ctr_list[ii].buf_state.npages + 1)
+		       * ctr_list[ii].buf_state.pagesz;
       ctr_list[ii].buf_state.buf = NULL;
       int tmprc = munmap (buf, bufsz);
       if (tmprc)
@@ -767,6 +900,66 @@ hwcdrv_lwp_fini (void)
   hwcdrv_free_counters ();  /* also sets pctx->ctr_list=NULL; */
 }
 
+/* hdrv_pcbe api when perf_event cannot use the PMU, as in most virtual
+   machines and containers: only the software events are counted.  */
+static int
+sw_pcbe_init (void)
+{
+  return hdrv_pcl_state.sw_only ? 0 : -1;
+}
+
+static uint_t
+sw_pcbe_ncounters (void)
+{
+  return MAX_PICS; // software events do not use registers
+}
+
+static const char *
+sw_pcbe_impl_name (void)
+{
+  return "Generic (software events only)";
+}
+
+static const char *
+sw_pcbe_cpuref (void)
+{
+  return GTXT ("See the Linux perf_event_open(2) man page for the software events.\n");
+}
+
+static int
+sw_pcbe_get_events (hwcf_hwc_cb_t *hwc_cb, Hwcentry *raw_hwc_tbl)
+{
+  int count = 0;
+  if (raw_hwc_tbl)
+    for (Hwcentry *h = raw_hwc_tbl; h->name; h++)
+      if (h->use_perf_event_type && h->type == PERF_TYPE_SOFTWARE)
+	for (uint_t jj = 0; jj < MAX_PICS; jj++)
+	  {
+	    hwc_cb (jj, h->name);
+	    count++;
+	  }
+  return count;
+}
+
+static int
+sw_pcbe_get_eventnum (const char *eventname, uint_t pmc, eventsel_t *eventnum,
+		      eventsel_t *valid_umask, uint_t *pmc_sel)
+{
+  /* *eventnum is already the perf_event config of the event */
+  *valid_umask = 0x0;
+  *pmc_sel = pmc;
+  return 0;
+}
+
+static hdrv_pcbe_api_t hdrv_pcbe_sw_api = {
+  sw_pcbe_init,
+  sw_pcbe_ncounters,
+  sw_pcbe_impl_name,
+  sw_pcbe_cpuref,
+  sw_pcbe_get_events,
+  sw_pcbe_get_eventnum
+};
+
 /* open */
 static int
 hdrv_pcl_internal_open ()
@@ -788,6 +981,19 @@ hdrv_pcl_internal_open ()
 				-1, // cpu, -1 is per-thread mode
 				-1, // group_fd, -1 is root
 				0); // flags
+  if (hwc_fd == -1)
+    {
+      // no access to the PMU; software events may still be counted
+      pe_attr->type = PERF_TYPE_SOFTWARE;
+      pe_attr->config = PERF_COUNT_SW_CPU_CLOCK;
+      hwc_fd = perf_event_open (pe_attr, 0, -1, -1, 0);
+      if (hwc_fd != -1)
+	{
+	  hdrv_pcl_state.sw_only = 1;
+	  TprintfT (DBG_LT1, "hwcdrv: WARNING: hdrv_pcl_internal_open:"
+		    " only software events are available\n");
+	}
+    }
   if (hwc_fd == -1)
     {
       TprintfT (DBG_LT1, "hwcdrv: WARNING: hdrv_pcl_internal_open:"
@@ -880,7 +1086,11 @@ hwcdrv_get_info (int *cpuver, const char **cciname, uint_t *npics,
   if (docref)
     *docref = hdrv_pcl_about.cpcN_docref;
   if (support)
-    *support = HWCFUNCS_SUPPORT_OVERFLOW_PROFILING | HWCFUNCS_SUPPORT_OVERFLOW_CTR_ID;
+    {
+      *support = HWCFUNCS_SUPPORT_OVERFLOW_PROFILING | HWCFUNCS_SUPPORT_OVERFLOW_CTR_ID;
+      if (hdrv_pcl_state.sw_only)
+	*support |= HWCFUNCS_SUPPORT_SW_EVENTS_ONLY;
+    }
 }
 
 HWCDRV_API int
@@ -896,6 +1106,32 @@ hwcdrv_enable_mt (hwcfuncs_tsd_get_fn_t tsd_ftn)
   return 0;
 }
 
+HWCDRV_API int
+hwcdrv_enable_batch (unsigned nsamples, hwcdrv_sample_fn_t *sample_ftn)
+{
+  if (!hdrv_pcl_state.library_ok || nsamples == 0 || sample_ftn == NULL)
+    return HWCFUNCS_ERROR_NOT_SUPPORTED;
+
+  /* check that the kernel can time the samples with our clock */
+  hdrv_pcl_state.batch = nsamples;
+  struct perf_event_attr pe_attr;
+  init_perf_event (&pe_attr, 0, 0, NULL);
+  pe_attr.type = PERF_TYPE_SOFTWARE;
+  pe_attr.config = PERF_COUNT_SW_TASK_CLOCK;
+  int hwc_fd = perf_event_open (&pe_attr, 0, -1, -1, 0);
+  if (hwc_fd == -1)
+    {
+      TprintfT (DBG_LT0, "hwcdrv: WARNING: hwcdrv_enable_batch:"
+		" perf_event_open() failed, errno=%d\n", errno);
+      hdrv_pcl_state.batch = 0;
+      return HWCFUNCS_ERROR_NOT_SUPPORTED;
+    }
+  close (hwc_fd);
+  hdrv_pcl_state.sample_ftn = sample_ftn;
+  TprintfT (DBG_LT1, "hwcdrv: hwcdrv_enable_batch(%u)\n", nsamples);
+  return 0;
+}
+
 HWCDRV_API int
 hwcdrv_get_descriptions (hwcf_hwc_cb_t *hwc_cb, hwcf_attr_cb_t *attr_cb,
 			 Hwcentry *raw_hwc_tbl)
@@ -920,11 +1156,18 @@ hwcdrv_assign_regnos (Hwcentry* entries[], unsigned numctrs)
 static int
 internal_hwc_start (int fd)
 {
-  int rc = ioctl (fd, PERF_EVENT_IOC_REFRESH, 1);
+  /* In batch mode, the counter keeps running, otherwise it stops at
+     the next overflow */
+  int rc;
+  if (hdrv_pcl_state.batch)
+    rc = ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+  else
+    rc = ioctl (fd, PERF_EVENT_IOC_REFRESH, 1);
   if (rc == -1)
     {
       TprintfT (DBG_LT0, "hwcdrv: ERROR: internal_hwc_start:"
-		" PERF_EVENT_IOC_REFRESH(fd=%d) failed: errno=%d\n", fd, errno);
+		" %s(fd=%d) failed: errno=%d\n", hdrv_pcl_state.batch
+		? "PERF_EVENT_IOC_ENABLE" : "PERF_EVENT_IOC_REFRESH", fd, errno);
       return HWCFUNCS_ERROR_UNAVAIL;
     }
   TprintfT (DBG_LT3, "hwcdrv: internal_hwc_start(fd=%d)\n", fd);
@@ -967,6 +1210,13 @@ hwcdrv_overflow (siginfo_t *si, hwc_event_t *eventp, hwc_event_t *lost_events)
       TprintfT (DBG_LT0, "hwcdrv: sig_ts=%llu: WARNING: hwcdrv_overflow:"
 		" SI_TKILL detected\n", sig_ts);
       break;
+    case POLL_IN: /* expected in batch mode, where the counters keep running */
+      if (hdrv_pcl_state.batch)
+	{
+	  signal_fd = si->si_fd;
+	  break;
+	}
+      /* FALLTHROUGH */
     default:
       // "sometimes we see a POLL_IN (1) with very high event rates,"
       // according to eranian(?)
@@ -990,6 +1240,50 @@ hwcdrv_overflow (siginfo_t *si, hwc_event_t *eventp, hwc_event_t *lost_events)
       return HWCFUNCS_ERROR_UNEXPECTED;
     }
 
+  if (hdrv_pcl_state.batch)
+    {
+      /* pass the samples of all the counters to sample_ftn */
+      if (pctx->draining)
+	return 0; // the interrupted code reads the buffers
+      pctx->draining = 1;
+      /* Stop the counters while we read the buffers, or they would
+	 count, and sample, the collector itself.  */
+      for (ii = 0; ii < hdrv_pcl_state.hwcdef_cnt; ii++)
+	ctr_list[ii].needs_restart
+		= ioctl (ctr_list[ii].fd, PERF_EVENT_IOC_DISABLE, 0) == 0;
+      for (ii = 0; ii < hdrv_pcl_state.hwcdef_cnt; ii++)
+	{
+	  hrtime_t last_ts = 0;
+	  int nsamples = drain_samples (ii, &ctr_list[ii], &last_ts);
+	  if (nsamples == 0)
+	    continue;
+
+	  /* adapt the overflow interval as below */
+	  hrtime_t min_time = global_perf_event_def[ii].min_time;
+	  if (min_time > 0
+	      && (last_ts - ctr_list[ii].last_overflow_time) / nsamples < min_time)
+	    {
+	      uint64_t new_period = 2 * ctr_list[ii].last_overflow_period + 37;
+	      flush_one_ctr (ii, ctr_list);
+	      stop_one_ctr (ii, ctr_list);
+	      ctr_list[ii].last_overflow_period = new_period;
+	      ctr_list[ii].needs_restart
+		      = start_one_ctr (ii, ctr_list[ii].buf_state.pagesz, pctx,
+				       "hwcdrv: ERROR: hwcdrv_overflow (readjust overflow):") == 0;
+	    }
+	  else
+	    ctr_list[ii].last_overflow_time = last_ts;
+	}
+      for (ii = 0; ii < hdrv_pcl_state.hwcdef_cnt; ii++)
+	{
+	  if (ctr_list[ii].needs_restart)
+	    internal_hwc_start (ctr_list[ii].fd);
+	  ctr_list[ii].needs_restart = 0;
+	}
+      pctx->draining = 0;
+      return 0;
+    }
+
   /* clear needs_restart flag */
   for (ii = 0; ii < hdrv_pcl_state.hwcdef_cnt; ii++)
     ctr_list[ii].needs_restart = 0;
@@ -1057,7 +1351,8 @@ hwcdrv_overflow (siginfo_t *si, hwc_event_t *eventp, hwc_event_t *lost_events)
 
 	  /* type is PERF_RECORD_SAMPLE */
 	  uint64_t value, lostv;
-	  if (read_sample (&ctr_list[idx], datasz, &value, &lostv))
+	  if (read_sample (&ctr_list[idx], datasz, &value, &lostv,
+			   NULL, NULL, NULL))
 	    {
 	      TprintfT (DBG_LT0, "hwcdrv: sig_ts=%llu: ERROR: hwcdrv_overflow:"
 			" read_sample() failed\n", sig_ts);
@@ -1238,6 +1533,13 @@ hwcdrv_free_counters () // note: only performs shutdown for this thread
       TprintfT (DBG_LT1, "hwcdrv: WARNING: hwcdrv_free_counters: ctr_list is already NULL\n");
       return 0;
     }
+  if (hdrv_pcl_state.batch)
+    {
+      pctx->draining = 1;
+      for (int ii = 0; ii < hdrv_pcl_state.hwcdef_cnt; ii++)
+	flush_one_ctr (ii, ctr_list);
+      pctx->draining = 0;
+    }
   int hwc_rc = 0;
   for (int ii = 0; ii < hdrv_pcl_state.hwcdef_cnt; ii++)
     if (stop_one_ctr (ii, ctr_list))
@@ -1359,6 +1661,7 @@ hwcdrv_api_t hwcdrv_pcl_api = {
   hwcdrv_init,
   hwcdrv_get_info,
   hwcdrv_enable_mt,
+  hwcdrv_enable_batch,
   hwcdrv_get_descriptions,
   hwcdrv_assign_regnos,
   hwcdrv_create_counters,
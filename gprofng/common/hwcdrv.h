@@ -89,6 +89,17 @@ extern "C"
 {
 #endif
 
+  /* Called for each sample read in batch mode (see hwcdrv_enable_batch):
+       <idx>: index of the counter
+       <ts>: time of the sample
+       <value>: counts since the previous sample of the counter
+       <lost>: counts which could not be attributed to a sample
+       <pcs>, <npcs>: user call stack of the sample, leaf first; NULL
+		      and 0 when the sample only reports lost counts
+   */
+  typedef void (hwcdrv_sample_fn_t)(unsigned idx, hrtime_t ts, uint64_t value,
+				    uint64_t lost, uint64_t *pcs, int npcs);
+
   /* hwcdrv api */
   typedef struct
   {
@@ -125,6 +136,18 @@ extern "C"
        Return: none
      */
 
+    int (*hwcdrv_enable_batch)(unsigned nsamples, hwcdrv_sample_fn_t *sample_ftn);
+    /* Linux only.  Read the samples in batches (call before
+	 hwcdrv_create_counters).  The kernel keeps the samples, with their
+	 time and user call stack, in a ring buffer per counter and thread,
+	 and signals every <nsamples> samples only.  hwcdrv_overflow() then
+	 passes each sample to <sample_ftn> rather than returning it, and
+	 the counters need no restart.  The samples left in the buffers are
+	 passed to <sample_ftn> when the counters of a thread are stopped.
+       Return: 0 if successful
+	  HWCFUNCS_ERROR_NOT_SUPPORTED if the kernel cannot do it
+     */
+
     int (*hwcdrv_get_descriptions)(hwcf_hwc_cb_t *hwc_find_action,
 				   hwcf_attr_cb_t *attr_find_action,
 				   Hwcentry *raw_hwc_tbl);
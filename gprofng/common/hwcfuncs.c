@@ -61,6 +61,12 @@ hwcdrv_enable_mt (hwcfuncs_tsd_get_fn_t tsd_ftn)
   return -1;
 }
 
+HWCDRV_API int
+hwcdrv_enable_batch (unsigned nsamples, hwcdrv_sample_fn_t *sample_ftn)
+{
+  return -1;
+}
+
 HWCDRV_API int
 hwcdrv_get_descriptions (hwcf_hwc_cb_t *hwc_find_action,
 			 hwcf_attr_cb_t *attr_find_action, Hwcentry *hwcdef)
@@ -135,6 +141,7 @@ static hwcdrv_api_t hwcdrv_default = {
   hwcdrv_init,
   hwcdrv_get_info,
   hwcdrv_enable_mt,
+  hwcdrv_enable_batch,
   hwcdrv_get_descriptions,
   hwcdrv_assign_regnos,
   hwcdrv_create_counters,
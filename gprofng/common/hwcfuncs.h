@@ -134,6 +134,7 @@ extern void hwcfuncs_int_logerr(const char *format,...);
 #define HWCFUNCS_SUPPORT_PEBS_SAMPLING      0x02llu
 #define HWCFUNCS_SUPPORT_OVERFLOW_CTR_ID    0x04llu // OS identifies which counter overflowed
 #define SUPPORT_MEMORYSPACE_PROFILING       0x08
+#define HWCFUNCS_SUPPORT_SW_EVENTS_ONLY     0x10llu // no PMU access, only software events
   /* get info about session
      Input:
        <cpuver>: if not NULL, returns value of CPC cpu version
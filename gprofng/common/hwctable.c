@@ -2271,6 +2271,10 @@ process_ctr_def (int forKernel, hrtime_t global_min_time_nsec,
     {
       snprintf (UEbuf + strlen (UEbuf), UEsz - strlen (UEbuf),
 		GTXT ("Invalid HW counter name: %s\n"), nameOnly);
+      if ((cpcx_support_bitmask & HWCFUNCS_SUPPORT_SW_EVENTS_ONLY) != 0)
+	snprintf (UEbuf + strlen (UEbuf), UEsz - strlen (UEbuf),
+		  GTXT ("The hardware counters cannot be accessed on this system (`%s'); only the software events can be counted.\n"),
+		  cpcx_cciname);
       snprintf (UEbuf + strlen (UEbuf), UEsz - strlen (UEbuf),
 		GTXT ("Run \"%s -h\" with no other arguments for more information on HW counters on this system.\n"),
 		(IS_KERNEL (forKernel) ? "er_kernel" : "collect"));
@@ -3757,6 +3761,10 @@ hwc_process_raw_ctrs (int forKernel, Hwcentry ***pstd_out,
       {
 	if (!supported_hwc (pctr))
 	  continue;
+	// without access to the PMU, only the software events can be counted
+	if ((cpcx_support_bitmask & HWCFUNCS_SUPPORT_SW_EVENTS_ONLY) != 0
+	    && (!pctr->use_perf_event_type || pctr->type != PERF_TYPE_SOFTWARE))
+	  continue;
 	if (is_hidden_alias (pctr))
 	  list_append_shallow_copy (&table_copy[2], pctr); // hidden list
 	else
@@ -88,6 +88,7 @@ extern int __collector_ext_line_install (char *, const char *);
 extern void __collector_ext_line_close ();
 extern void __collector_ext_unwind_init (int);
 extern void __collector_ext_unwind_close ();
+extern void __collector_ext_unwind_update_modules (int rebuild);
 extern int __collector_ext_jstack_unwind (char*, int, ucontext_t *);
 extern void __collector_ext_dispatcher_fork_child_cleanup ();
 extern void __collector_ext_unwind_key_init (int isPthread, void * stack);
@@ -97,6 +97,8 @@ static void collector_record_counter (ucontext_t*,
 				      int timecvt,
 				      ABST_type, hrtime_t,
 				      unsigned, uint64_t);
+static void collector_record_sample (unsigned, hrtime_t, uint64_t, uint64_t,
+				     uint64_t *, int);
 static void collector_hwc_ABORT (int errnum, const char *msg);
 static void hwclogwrite0 ();
 static void hwclogwrite (Hwcentry *);
@@ -275,6 +277,19 @@ open_experiment (const char *exp)
   hwcdef_cnt = 0;
   hwcdef_has_memspace = 0;
 
+  /* read the samples in batches if requested */
+  char *batch = CALL_UTIL (getenv)("GPROFNG_HWC_BATCH");
+  int nsamples = batch ? CALL_UTIL (atoi)(batch) : 0;
+  if (nsamples > 1)
+    {
+      if (hwc_driver->hwcdrv_enable_batch (nsamples, collector_record_sample) == 0)
+	collector_interface->writeLog ("<event kind=\"%s\" id=\"%d\">HW counter samples read in batches of %d</event>\n",
+				       SP_JCMD_COMMENT, COL_COMMENT_NONE, nsamples);
+      else
+	collector_interface->writeLog ("<event kind=\"%s\" id=\"%d\">GPROFNG_HWC_BATCH=%s ignored: not supported by the kernel</event>\n",
+				       SP_JCMD_COMMENT, COL_COMMENT_NONE, batch);
+    }
+
   /* create counters based on hwcdef[] */
   err = __collector_hwcfuncs_bind_descriptor (defstring);
   if (err)
@@ -522,9 +537,10 @@ real_detach_experiment (void)
 /*---------------------------------------------------------------------------*/
 /* Record counter values. */
 
-/* <value> should already be adjusted to be "zero-based" (counting up from 0).*/
+/* <value> should already be adjusted to be "zero-based" (counting up from 0).
+   The call stack is given by <frmode> and <frarg> as in getFrameInfo(). */
 static void
-collector_record_counter_internal (ucontext_t *ucp, int timecvt,
+collector_record_counter_internal (int frmode, void *frarg, int timecvt,
 				   ABST_type ABS_memop, hrtime_t time,
 				   unsigned tag, uint64_t value, uint64_t pc,
 				   uint64_t va, uint64_t latency,
@@ -550,8 +566,11 @@ collector_record_counter_internal (ucontext_t *ucp, int timecvt,
   TprintfT (DBG_LT4, "hwprofile: %llu sample %lld tag %u recorded\n",
 	    (unsigned long long) time, (long long) value, tag);
   if (ABS_memop == ABST_NOPC)
-    ucp = &expr_nopc_uc;
-  pckt.comm.frinfo = collector_interface->getFrameInfo (expr_hndl, pckt.comm.tstamp, FRINFO_FROM_UC, ucp);
+    {
+      frmode = FRINFO_FROM_UC;
+      frarg = &expr_nopc_uc;
+    }
+  pckt.comm.frinfo = collector_interface->getFrameInfo (expr_hndl, pckt.comm.tstamp, frmode, frarg);
   collector_interface->writeDataRecord (expr_hndl, (Common_packet*) & pckt);
 }
 
@@ -559,7 +578,38 @@ static void
 collector_record_counter (ucontext_t *ucp, int timecvt, ABST_type ABS_memop,
 			  hrtime_t time, unsigned tag, uint64_t value)
 {
-  collector_record_counter_internal (ucp, timecvt, ABS_memop, time, tag, value,
+  collector_record_counter_internal (FRINFO_FROM_UC, ucp, timecvt, ABS_memop,
+				     time, tag, value,
+				     HWCFUNCS_INVALID_U64, HWCFUNCS_INVALID_U64,
+				     HWCFUNCS_INVALID_U64, HWCFUNCS_INVALID_U64);
+}
+
+/* Record a sample read in batch mode: its call stack was recorded by the
+   kernel, since the context of the signal is that of the last sample.  */
+static void
+collector_record_sample (unsigned idx, hrtime_t time, uint64_t value,
+			 uint64_t lost, uint64_t *pcs, int npcs)
+{
+  /* the counters of a thread may be stopped after the collection */
+  if (hwc_mode != HWCMODE_ACTIVE && hwc_mode != HWCMODE_SUSPEND)
+    return;
+  if (idx >= hwcdef_cnt)
+    return;
+  if (lost)
+    collector_record_counter (&expr_lostcounts_uc, hwcdef[idx]->timecvt,
+			      hwcdef[idx]->memop, time,
+			      hwcdef[idx]->sort_order, lost);
+  if (value == 0 || npcs <= 0)
+    return;
+  CM_Array array;
+  long *stack = (long *) alloca (npcs * sizeof (long));
+  for (int i = 0; i < npcs; i++)
+    stack[i] = (long) pcs[i];
+  array.length = npcs * sizeof (long);
+  array.bytes = stack;
+  collector_record_counter_internal (FRINFO_FROM_ARRAY, &array,
+				     hwcdef[idx]->timecvt, hwcdef[idx]->memop,
+				     time, hwcdef[idx]->sort_order, value,
 				     HWCFUNCS_INVALID_U64, HWCFUNCS_INVALID_U64,
 				     HWCFUNCS_INVALID_U64, HWCFUNCS_INVALID_U64);
 }
@@ -35,6 +35,7 @@
 #include "collector.h"
 #include "gp-experiment.h"
 #include "memmgr.h"
+#include "tsd.h"
 
 /* ------------- Data and prototypes for block management --------- */
 #define IO_BLK      0 /* Concurrent requests */
@@ -46,6 +47,7 @@
 
 /* IO_BLK, IO_SEQ */
 #define NCHUNKS     64
+#define CACHE_LINE  64
 
 /* IO_TXT */
 #define NBUFS  64 /* Number of text buffers */
@@ -61,6 +63,22 @@ typedef struct Buffer
   uint32_t state;   /* ST_FREE or ST_BUSY */
 } Buffer;
 
+/*
+ * State of a block of an IO_BLK or IO_SEQ file.  A block is owned by one
+ * writer while it is ST_BUSY, so the counters need no atomic updates.
+ * Blocks are padded to a cache line so that threads writing to their own
+ * blocks do not share cache lines.
+ */
+typedef struct Block
+{
+  uint32_t state;   /* ST_INIT, ST_FREE or ST_BUSY */
+  uint32_t off;     /* offset of the free space in the block */
+  uint32_t nrec;    /* number of records written to the block */
+  uint32_t nother;  /* records written after a thread moved to the block */
+  uint32_t nremap;  /* number of times the block was remapped */
+  uint8_t pad[CACHE_LINE - 5 * sizeof (uint32_t)];
+} Block;
+
 typedef struct DataHandle
 {
   Pckt_type kind;           /* obsolete (to be removed) */
@@ -70,12 +88,12 @@ typedef struct DataHandle
 
   /* IO_BLK, IO_SEQ */
   uint32_t nflow;           /* number of data flows */
-  uint32_t *blkstate;       /* block states, nflow*NCHUNKS array */
-  uint32_t *blkoff;         /* block offset, nflow*NCHUNKS array */
+  Block *blocks;            /* block states, nflow*NCHUNKS array */
   uint32_t nchnk;           /* number of active chunks, probably small for IO_BLK */
   uint8_t *chunks[NCHUNKS]; /* chunks (nflow contiguous blocks in virtual memory) */
   uint32_t chblk[NCHUNKS];  /* number of active blocks in a chunk */
   uint32_t nblk;            /* number of blocks in data file */
+  uint32_t ndrop;           /* number of records dropped, all blocks busy */
   int exempt;               /* if exempt from experiment size limit */
 
   /* IO_TXT */
@@ -90,6 +108,7 @@ static long blksz;          /* Block size. Multiple of page size. Power of two t
 static long log2blksz;      /* log2(blksz) to make (x/blksz)==(x>>log2blksz) fast. */
 static uint32_t size_limit; /* Experiment size limit */
 static uint32_t cur_size;   /* Current experiment size */
+static unsigned block_key = COLLECTOR_TSD_INVALID_KEY; /* block of each IO_BLK handle a thread writes to */
 static void init ();
 static void deleteHandle (DataHandle *hndl);
 static int exp_size_ck (int nblocks, char *fname);
@@ -100,6 +119,9 @@ static uint8_t *getBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
 static int remapBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
 static int newBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
 static void deleteBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
+#if defined(DEBUG)
+static void logBlockStats (DataHandle *hndl);
+#endif
 
 /* IO_TXT */
 static int is_not_the_log_file (char *fname);
@@ -125,6 +147,8 @@ init ()
 	    pgsz, pgsz, (long) blksz, (long) blksz, (long) log2blksz);
   size_limit = 0;
   cur_size = 0;
+  block_key = __collector_tsd_create_key (PROFILE_DATAHNDL_MAX * sizeof (uint8_t),
+					  NULL, NULL);
   initialized = 1;
 }
 
@@ -207,6 +231,7 @@ __collector_create_handle (char *descp)
 
   hndl->kind = kind;
   hndl->nblk = 0;
+  hndl->ndrop = 0;
   hndl->exempt = exempt;
   CALL_UTIL (strlcpy)(hndl->fname, fname, sizeof (hndl->fname));
   int fd = CALL_UTIL (open)(hndl->fname,
@@ -296,23 +321,22 @@ __collector_create_handle (char *descp)
 	}
       else if (hndl->iotype == IO_SEQ)
 	hndl->nflow = 1;
-      TprintfT (DBG_LT2, "create_handle calling allocCSize blkstate fname=`%s' nflow=%d NCHUNKS=%d size=%ld (0x%lx)\n",
+      TprintfT (DBG_LT2, "create_handle calling allocCSize blocks fname=`%s' nflow=%d NCHUNKS=%d size=%ld (0x%lx)\n",
 		fname, hndl->nflow, NCHUNKS,
-		(long) (hndl->nflow * NCHUNKS * sizeof (uint32_t)),
-		(long) (hndl->nflow * NCHUNKS * sizeof (uint32_t)));
-      uint32_t *blkstate = (uint32_t*) __collector_allocCSize (__collector_heap, hndl->nflow * NCHUNKS * sizeof (uint32_t), 1);
-      if (blkstate == NULL)
+		(long) (hndl->nflow * NCHUNKS * sizeof (Block)),
+		(long) (hndl->nflow * NCHUNKS * sizeof (Block)));
+      Block *blocks = (Block*) __collector_allocCSize (__collector_heap, hndl->nflow * NCHUNKS * sizeof (Block), 1);
+      if (blocks == NULL)
 	return NULL;
       for (int j = 0; j < hndl->nflow * NCHUNKS; ++j)
-	blkstate[j] = ST_INIT;
-      hndl->blkstate = blkstate;
-      TprintfT (DBG_LT2, "create_handle calling allocCSize blkoff fname=`%s' nflow=%d NCHUNKS=%d size=%ld (0x%lx)\n",
-		fname, hndl->nflow, NCHUNKS,
-		(long) (hndl->nflow * NCHUNKS * sizeof (uint32_t)),
-		(long) (hndl->nflow * NCHUNKS * sizeof (uint32_t)));
-      hndl->blkoff = (uint32_t*) __collector_allocCSize (__collector_heap, hndl->nflow * NCHUNKS * sizeof (uint32_t), 1);
-      if (hndl->blkoff == NULL)
-	return NULL;
+	{
+	  blocks[j].state = ST_INIT;
+	  blocks[j].off = 0;
+	  blocks[j].nrec = 0;
+	  blocks[j].nother = 0;
+	  blocks[j].nremap = 0;
+	}
+      hndl->blocks = blocks;
       hndl->nchnk = 0;
       for (int j = 0; j < NCHUNKS; ++j)
 	{
@@ -339,15 +363,18 @@ deleteHandle (DataHandle *hndl)
        */
       for (int j = 0; j < hndl->nflow * NCHUNKS; ++j)
 	{
-	  uint32_t oldstate = hndl->blkstate[j];
+	  uint32_t oldstate = hndl->blocks[j].state;
 	  if (oldstate != ST_FREE)
 	    continue;
 	  /* Mark as busy */
-	  uint32_t state = __collector_cas_32 (hndl->blkstate + j, oldstate, ST_BUSY);
+	  uint32_t state = __collector_cas_32 (&hndl->blocks[j].state, oldstate, ST_BUSY);
 	  if (state != oldstate)
 	    continue;
 	  deleteBlock (hndl, j / NCHUNKS, j % NCHUNKS);
 	}
+#if defined(DEBUG)
+      logBlockStats (hndl);
+#endif
     }
   else if (hndl->iotype == IO_TXT)
     {
@@ -655,7 +682,7 @@ remapBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk)
       rc = 1;
       goto exit;
     }
-  hndl->blkoff[iflow * NCHUNKS + ichunk] = 0;
+  hndl->blocks[iflow * NCHUNKS + ichunk].off = 0;
 
   /* Map block to file */
   uint8_t *bptr = getBlock (hndl, iflow, ichunk);
@@ -707,12 +734,34 @@ deleteBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk)
 {
   uint8_t *bptr = getBlock (hndl, iflow, ichunk);
   CALL_UTIL (munmap)((void*) bptr, blksz);
-  hndl->blkstate[iflow * NCHUNKS + ichunk] = ST_INIT;
+  hndl->blocks[iflow * NCHUNKS + ichunk].state = ST_INIT;
 
   /* Update the number of active blocks */
   __collector_dec_32 (hndl->chblk + ichunk);
 }
 
+#if defined(DEBUG)
+/*
+ * Trace the write statistics of a data file.  A record written to a
+ * block a thread moved to means that threads contended for blocks.
+ */
+static void
+logBlockStats (DataHandle *hndl)
+{
+  unsigned long nrec = 0;
+  unsigned long nother = 0;
+  unsigned long nremap = 0;
+  for (int j = 0; j < hndl->nflow * NCHUNKS; ++j)
+    {
+      nrec += hndl->blocks[j].nrec;
+      nother += hndl->blocks[j].nother;
+      nremap += hndl->blocks[j].nremap;
+    }
+  TprintfT (DBG_LT1, "iolib: %s: %lu records, %u blocks, %lu remaps, %lu contended, %u dropped\n",
+	    hndl->fname, nrec, hndl->nblk, nremap, nother, hndl->ndrop);
+}
+#endif
+
 int
 __collector_write_record (DataHandle *hndl, Common_packet *pckt)
 {
@@ -780,42 +829,64 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
 						  : __collector_thr_self ();
   unsigned iflow = (unsigned) (((unsigned long) tid) % hndl->nflow);
 
+  /*
+   * Threads sharing a flow share its first block.  A thread moves to
+   * another block only when the block it writes to is busy, and keeps
+   * writing to the block it moved to, so that only threads which contend
+   * claim blocks of their own.  Sequential files always start with the
+   * first block.
+   */
+  uint8_t *pref = NULL;
+  unsigned ipref = 0;
+  if (hndl->iotype == IO_BLK)
+    {
+      pref = (uint8_t *) __collector_tsd_get_by_key (block_key);
+      if (pref != NULL)
+	{
+	  pref += hndl - data_hndls;
+	  ipref = *pref;
+	}
+    }
+
   /* Acquire block */
-  uint32_t *sptr = &hndl->blkstate[iflow * NCHUNKS];
+  Block *blocks = &hndl->blocks[iflow * NCHUNKS];
   uint32_t state = ST_BUSY;
-  unsigned ichunk;
-  for (ichunk = 0; ichunk < NCHUNKS; ++ichunk)
+  unsigned ichunk = ipref;
+  int n;
+  for (n = 0; n < NCHUNKS; ++n, ichunk = (ichunk + 1) % NCHUNKS)
     {
-      uint32_t oldstate = sptr[ichunk];
+      uint32_t oldstate = blocks[ichunk].state;
       if (oldstate == ST_BUSY)
 	continue;
       /* Mark as busy */
-      state = __collector_cas_32 (sptr + ichunk, oldstate, ST_BUSY);
+      state = __collector_cas_32 (&blocks[ichunk].state, oldstate, ST_BUSY);
       if (state == oldstate)
 	break;
       if (state == ST_BUSY)
 	continue;
       /* It's possible the state changed from ST_INIT to ST_FREE */
       oldstate = state;
-      state = __collector_cas_32 (sptr + ichunk, oldstate, ST_BUSY);
+      state = __collector_cas_32 (&blocks[ichunk].state, oldstate, ST_BUSY);
       if (state == oldstate)
 	break;
     }
 
-  if (state == ST_BUSY || ichunk == NCHUNKS)
+  if (state == ST_BUSY || n == NCHUNKS)
     {
       /* We are out of blocks for this data flow.
        * We might switch to another flow but for now report and return.
        */
       TprintfT (0, "collector_write_packet: all %d blocks on flow %d for %s are busy\n",
 		NCHUNKS, iflow, hndl->fname);
+      __collector_inc_32 (&hndl->ndrop);
       return 1;
     }
 
   if (state == ST_INIT && newBlock (hndl, iflow, ichunk) != 0)
       return 1;
+  Block *blk = &blocks[ichunk];
   uint8_t *bptr = getBlock (hndl, iflow, ichunk);
-  uint32_t blkoff = hndl->blkoff[iflow * NCHUNKS + ichunk];
+  uint32_t blkoff = blk->off;
   if (blkoff + recsz > blksz)
     {
       /* The record doesn't fit. Close the block */
@@ -827,7 +898,8 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
 	}
       if (remapBlock (hndl, iflow, ichunk) != 0)
 	return 1;
-      blkoff = hndl->blkoff[iflow * NCHUNKS + ichunk];
+      blk->nremap++;
+      blkoff = blk->off;
     }
   if (blkoff + recsz < blksz)
     {
@@ -837,6 +909,13 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
       empty->tsize = blksz - blkoff - recsz;
     }
   __collector_memcpy (bptr + blkoff, pckt, recsz);
+  blk->nrec++;
+  if (ichunk != ipref)
+    {
+      blk->nother++;
+      if (pref != NULL)
+	*pref = (uint8_t) ichunk;
+    }
 
   /* Release block */
   if (hndl->active == 0)
@@ -844,8 +923,8 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
       deleteBlock (hndl, iflow, ichunk);
       return 0;
     }
-  hndl->blkoff[iflow * NCHUNKS + ichunk] += recsz;
-  sptr[ichunk] = ST_FREE;
+  blk->off += recsz;
+  blk->state = ST_FREE;
   return 0;
 }
 
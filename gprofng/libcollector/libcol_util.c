@@ -1265,6 +1265,15 @@ __collector_util_init ()
       err = COL_ERROR_UTIL_INIT;
     }
 
+  ptr = dlsym (libc, "dl_iterate_phdr");
+  if (ptr)
+    __collector_util_funcs.dl_iterate_phdr = (int(*)())ptr;
+  else
+    {
+      CALL_UTIL (fprintf)(stderr, "collector_util_init COL_ERROR_UTIL_INIT dl_iterate_phdr: %s\n", dlerror ());
+      err = COL_ERROR_UTIL_INIT;
+    }
+
   ptr = dlsym (libc, "execv");
   if (ptr)
     __collector_util_funcs.execv = (int(*)())ptr;
@@ -1604,6 +1604,8 @@ gprofng_dlopen (void*(real_dlopen) (const char *, int),
   /* Don't call update if dlopen failed: preserve dlerror() */
   if (ret && (mmap_mode > 0) && !(mode & RTLD_NOLOAD))
     update_map_segments (hrt, 1);
+  if (ret && !(mode & RTLD_NOLOAD))
+    __collector_ext_unwind_update_modules (1);
   TprintfT (DBG_LT2, "libcollector -- dlopen(%s) returning %p\n", pathname, ret);
   POP_REENTRANCE;
   return ret;
@@ -1637,7 +1639,10 @@ gprofng_dlclose (int (real_dlclose) (void *), void *handle)
       POP_REENTRANCE;
       hrt = GETRELTIME ();
     }
+  /* Stop unwinding with sections which may be unmapped */
+  __collector_ext_unwind_update_modules (0);
   int ret = real_dlclose (handle);
+  __collector_ext_unwind_update_modules (1);
 
   /* Don't call update if dlclose failed: preserve dlerror() */
   if (!ret && !CHCK_REENTRANCE)
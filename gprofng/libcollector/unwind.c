@@ -25,6 +25,7 @@
 #include <signal.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <link.h>
 
 #include "gp-defs.h"
 #include "collector.h"
@@ -38,6 +39,9 @@
 /* Get definitions for SP_LEAF_CHECK_MARKER, SP_TRUNC_STACK_MARKER */
 #include "data_pckts.h"
 
+/* Get the SFrame format definitions */
+#include "sframe.h"
+
 #if ARCH(SPARC)
 struct frame
 {
@@ -300,6 +304,19 @@ static uint32_t *OmpVals = NULL;
 static unsigned long *OmpRAs = NULL;
 static unsigned long adjust_ret_addr (unsigned long ra, unsigned long segoff, unsigned long tend);
 static int parse_x86_AVX_instruction (unsigned char *pc);
+#if WSIZE(64)
+#define SFrameCacheSize 65536
+struct SFrameCacheEntry
+{
+  volatile uint32_t seq;    /* odd while the entry is being written */
+  volatile uint32_t gen;    /* generation of the module table */
+  volatile uint64_t pc;
+  volatile uint64_t row;    /* packed struct SFrameRow */
+};
+static struct SFrameCacheEntry *SFrameCache = NULL; // Cache for SFrame rows
+static int sframe_unwind = 1;
+static void sframe_update_modules (int rebuild);
+#endif
 
 struct WalkContext
 {
@@ -310,6 +327,7 @@ struct WalkContext
   unsigned long sbase; /* stack boundary */
   unsigned long tbgn;  /* current memory segment start */
   unsigned long tend;  /* current memory segment end */
+  int caller;          /* pc is a return address, not an interrupted pc */
 };
 #endif
 
@@ -462,6 +480,20 @@ __collector_ext_unwind_init (int record)
 	  return;
 	}
     }
+#if WSIZE(64)
+  str = CALL_UTIL (getenv)("GPROFNG_SFRAME_UNWIND");
+  if (str != NULL && __collector_strcmp (str, "0") == 0)
+    sframe_unwind = 0;
+  if (sframe_unwind)
+    {
+      sz = SFrameCacheSize * sizeof (*SFrameCache);
+      SFrameCache = (struct SFrameCacheEntry*) __collector_allocCSize (__collector_heap, sz, 1);
+      if (SFrameCache != NULL)
+	CALL_UTIL (memset)((void*) SFrameCache, 0, sz);
+      sframe_update_modules (1);
+    }
+  TprintfT (DBG_LT0, "GPROFNG_SFRAME_UNWIND=%d\n", sframe_unwind);
+#endif
 #endif /* ARCH() */
 
   if (record)
@@ -489,6 +521,18 @@ __collector_ext_unwind_close ()
   dhndl = NULL;
 }
 
+/* Called outside of signal context when shared objects may have been
+   loaded (REBUILD is 1), or are about to be unloaded (REBUILD is 0).  */
+void
+__collector_ext_unwind_update_modules (int rebuild)
+{
+#if ARCH(Intel) && WSIZE(64)
+  sframe_update_modules (rebuild);
+#else
+  (void) rebuild;
+#endif
+}
+
 void*
 __collector_ext_return_address (unsigned level)
 {
@@ -1883,6 +1927,432 @@ is_after_ret (unsigned char * npc)
   return 1;
 }
 
+#if WSIZE(64)
+/*
+ * SFrame based unwinding.
+ *
+ * Objects assembled with --gsframe and linked by ld carry a PT_GNU_SFRAME
+ * segment which describes, for every PC, how to compute the
+ * CFA and where the return address and the frame pointer are saved.  This
+ * is exact even in code built without frame pointers, and much cheaper
+ * than walking instructions, so we try it before the instruction walker.
+ *
+ * The table of modules is built outside of signal context (at init time
+ * and after dlopen / dlclose), using dl_iterate_phdr.  Signal handlers
+ * only read it.  There are two copies of the table: an update fills the
+ * copy which is not in use, then bumps the generation number to publish
+ * it.  The generation number is odd while an update is in progress (or
+ * while a dlclose may unmap sections) and unwinders do not use the table
+ * then; otherwise bit 1 of it selects the copy in use.  A stack walk
+ * counts itself as a reader in sframe_readers from start to end, and an
+ * update waits for all the counts to drop to zero after making the
+ * generation odd, so that no unwinder is still reading a section when
+ * dlclose unmaps it.  Each thread uses the slot of sframe_readers picked
+ * by its thread id, and each slot has a cache line of its own, so that
+ * unwinders on different CPUs do not write to a shared line.
+ *
+ * The return address of a caller frame may be the first instruction of
+ * the next function (after a call to a noreturn function), so we look
+ * up the row for the return address minus one in caller frames.
+ *
+ * Rows found in the SFrame sections are cached in SFrameCache, indexed
+ * by PC.  Each entry carries the pc, the full generation of the module
+ * table the row was computed for, and the row, and is protected by a
+ * sequence number: a writer claims the entry by making the sequence
+ * number odd with a CAS, so that writers do not mix their fields, and
+ * makes it even again after writing the other fields.  A reader accepts
+ * an entry only if it sees the same even sequence number before and
+ * after reading the fields.  On x86 stores are not reordered with other
+ * stores, nor loads with other loads, so volatile accesses are enough
+ * to order the fields with the sequence number.  Whatever we get from
+ * the cache is validated against the stack before use, just like the
+ * values from the RA_FROMFP cache.
+ */
+#ifndef PT_GNU_SFRAME
+#define PT_GNU_SFRAME       0x6474e554
+#endif
+#define SFRAME_MAX_MODULES  512
+
+struct SFrameModule
+{
+  unsigned long tbgn;       /* text described by the section */
+  unsigned long tend;
+  unsigned long sec;        /* start of the .sframe section */
+  const unsigned char *fdes;
+  const unsigned char *fres;
+  uint32_t num_fdes;
+  uint8_t fde_size;         /* 17 bytes in version 1, 20 in version 2 */
+  uint8_t version;
+  int8_t ra_offset;         /* fixed RA offset */
+};
+
+#define SFRAME_V1_FDE_SIZE  17
+#define SFRAME_FDE(mod, i) \
+  ((const sframe_func_desc_entry *) ((mod)->fdes + (i) * (mod)->fde_size))
+
+struct SFrameRow
+{
+  int32_t cfa_offset;
+  int16_t fp_offset;        /* 0 if FP is not saved */
+  int8_t ra_offset;
+  uint8_t flags;
+};
+
+#define SFRAME_ROW_FOUND    1  /* the PC is described by an SFrame section */
+#define SFRAME_ROW_CFA_FP   2  /* the CFA is based on FP, not on SP */
+
+struct SFrameTable
+{
+  int nmodules;
+  struct SFrameModule modules[SFRAME_MAX_MODULES];
+};
+
+static struct SFrameTable sframe_tables[2];
+static volatile uint32_t sframe_gen = 0;
+#define SFRAME_READER_SLOTS 64
+static struct
+{
+  volatile uint32_t count;
+  char pad[64 - sizeof (uint32_t)];
+} sframe_readers[SFRAME_READER_SLOTS] __attribute__ ((aligned (64)));
+static collector_mutex_t sframe_lock = COLLECTOR_MUTEX_INITIALIZER;
+
+static int
+sframe_add_module (struct dl_phdr_info *info, size_t size ATTRIBUTE_UNUSED,
+		   void *data)
+{
+  struct SFrameTable *tbl = (struct SFrameTable *) data;
+  const sframe_header *hdr = NULL;
+  unsigned long tbgn = (unsigned long) -1;
+  unsigned long tend = 0;
+  for (int i = 0; i < info->dlpi_phnum; i++)
+    {
+      const ElfW (Phdr) *phdr = info->dlpi_phdr + i;
+      if (phdr->p_type == PT_GNU_SFRAME)
+	hdr = (const sframe_header *) (info->dlpi_addr + phdr->p_vaddr);
+      else if (phdr->p_type == PT_LOAD && (phdr->p_flags & PF_X) != 0)
+	{
+	  unsigned long bgn = info->dlpi_addr + phdr->p_vaddr;
+	  if (tbgn > bgn)
+	    tbgn = bgn;
+	  if (tend < bgn + phdr->p_memsz)
+	    tend = bgn + phdr->p_memsz;
+	}
+    }
+  if (hdr == NULL || tbgn >= tend)
+    return 0;
+
+  /* Only accept what we know how to read in a signal handler.  */
+  if (hdr->sfh_preamble.sfp_magic != SFRAME_MAGIC
+      || (hdr->sfh_preamble.sfp_version != SFRAME_VERSION_1
+	  && hdr->sfh_preamble.sfp_version != SFRAME_VERSION_2)
+      || (hdr->sfh_preamble.sfp_flags & SFRAME_F_FDE_SORTED) == 0
+      || hdr->sfh_abi_arch != SFRAME_ABI_AMD64_ENDIAN_LITTLE
+      || hdr->sfh_cfa_fixed_ra_offset == SFRAME_CFA_FIXED_RA_INVALID
+      || hdr->sfh_num_fdes == 0)
+    {
+      TprintfT (DBG_LT1, "sframe_add_module: %s: unsupported SFrame section\n",
+		info->dlpi_name);
+      return 0;
+    }
+  if (tbl->nmodules >= SFRAME_MAX_MODULES)
+    return 1;
+
+  const unsigned char *sub = (const unsigned char *) (hdr + 1) + hdr->sfh_auxhdr_len;
+  struct SFrameModule mod;
+  mod.tbgn = tbgn;
+  mod.tend = tend;
+  mod.sec = (unsigned long) hdr;
+  mod.fdes = sub + hdr->sfh_fdeoff;
+  mod.fres = sub + hdr->sfh_freoff;
+  mod.num_fdes = hdr->sfh_num_fdes;
+  mod.version = hdr->sfh_preamble.sfp_version;
+  mod.fde_size = mod.version == SFRAME_VERSION_1 ? SFRAME_V1_FDE_SIZE
+	  : sizeof (sframe_func_desc_entry);
+  mod.ra_offset = hdr->sfh_cfa_fixed_ra_offset;
+
+  /* Keep the table sorted by text address.  */
+  int i = tbl->nmodules;
+  for (; i > 0 && tbl->modules[i - 1].tbgn > tbgn; i--)
+    tbl->modules[i] = tbl->modules[i - 1];
+  tbl->modules[i] = mod;
+  tbl->nmodules++;
+  TprintfT (DBG_LT2, "sframe_add_module: %s: 0x%lx-0x%lx %u FDEs\n",
+	    info->dlpi_name, tbgn, tend, (unsigned) mod.num_fdes);
+  return 0;
+}
+
+/* Stop using the module table.  If REBUILD, build a new one from the
+   modules currently loaded and publish it.  */
+static void
+sframe_update_modules (int rebuild)
+{
+  if (!sframe_unwind || SFrameCache == NULL)
+    return;
+  __collector_mutex_lock (&sframe_lock);
+  /* The locked increment orders the new generation before the reads
+     of sframe_readers.  */
+  if ((sframe_gen & 1) == 0)
+    __collector_inc_32 ((uint32_t *) &sframe_gen);
+  /* Stack walks are short; let the walkers run rather than spin.  */
+  for (int i = 0; i < SFRAME_READER_SLOTS; i++)
+    while (sframe_readers[i].count != 0)
+      CALL_UTIL (syscall)(__NR_sched_yield);
+  if (rebuild)
+    {
+      struct SFrameTable *tbl = sframe_tables + (((sframe_gen + 1) >> 1) & 1);
+      tbl->nmodules = 0;
+      CALL_UTIL (dl_iterate_phdr)(sframe_add_module, tbl);
+      __collector_inc_32 ((uint32_t *) &sframe_gen);
+      TprintfT (DBG_LT1, "sframe_update_modules: %d modules, generation %u\n",
+		tbl->nmodules, (unsigned) sframe_gen);
+    }
+  __collector_mutex_unlock (&sframe_lock);
+}
+
+/* Read a little-endian signed value of SIZE bytes at P.  */
+static int32_t
+sframe_read_offset (const unsigned char *p, int size)
+{
+  if (size == 1)
+    return (int8_t) p[0];
+  if (size == 2)
+    return (int16_t) (p[0] | (p[1] << 8));
+  return (int32_t) (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24));
+}
+
+static uint32_t
+sframe_read_start_addr (const unsigned char *p, int fre_type)
+{
+  if (fre_type == SFRAME_FRE_TYPE_ADDR1)
+    return p[0];
+  if (fre_type == SFRAME_FRE_TYPE_ADDR2)
+    return p[0] | (p[1] << 8);
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Find the SFrame row describing PC in MOD.  */
+static int
+sframe_find_row (const struct SFrameModule *mod, unsigned long pc,
+		 struct SFrameRow *row)
+{
+  int32_t pc_rel = (int32_t) (pc - mod->sec);
+  int lo = 0;
+  int hi = mod->num_fdes - 1;
+  if (SFRAME_FDE (mod, lo)->sfde_func_start_address > pc_rel)
+    return 0;
+  while (lo < hi)
+    {
+      int mid = hi - (hi - lo) / 2;
+      if (SFRAME_FDE (mod, mid)->sfde_func_start_address <= pc_rel)
+	lo = mid;
+      else
+	hi = mid - 1;
+    }
+  const sframe_func_desc_entry *fde = SFRAME_FDE (mod, lo);
+  uint32_t off = pc_rel - fde->sfde_func_start_address;
+  if (off >= fde->sfde_func_size || fde->sfde_func_num_fres == 0)
+    return 0;
+  if (SFRAME_V1_FUNC_FDE_TYPE (fde->sfde_func_info) == SFRAME_FDE_TYPE_PCMASK)
+    {
+      /* The repetition size is only known since version 2.  */
+      if (mod->version == SFRAME_VERSION_1 || fde->sfde_func_rep_size == 0)
+	return 0;
+      off %= fde->sfde_func_rep_size;
+    }
+
+  int fre_type = SFRAME_V1_FUNC_FRE_TYPE (fde->sfde_func_info);
+  int addr_size = fre_type == SFRAME_FRE_TYPE_ADDR1 ? 1
+	  : fre_type == SFRAME_FRE_TYPE_ADDR2 ? 2 : 4;
+  const unsigned char *fre = mod->fres + fde->sfde_func_start_fre_off;
+  const unsigned char *found = NULL;
+  for (uint32_t i = 0; i < fde->sfde_func_num_fres; i++)
+    {
+      if (sframe_read_start_addr (fre, fre_type) > off)
+	break;
+      found = fre;
+      uint8_t info = fre[addr_size];
+      int osize = 1 << SFRAME_V1_FRE_OFFSET_SIZE (info);
+      fre += addr_size + 1 + SFRAME_V1_FRE_OFFSET_COUNT (info) * osize;
+    }
+  if (found == NULL)
+    return 0;
+
+  uint8_t info = found[addr_size];
+  int noffsets = SFRAME_V1_FRE_OFFSET_COUNT (info);
+  int osize = 1 << SFRAME_V1_FRE_OFFSET_SIZE (info);
+  const unsigned char *offsets = found + addr_size + 1;
+  if (noffsets < 1 || osize > 4 || SFRAME_V1_FRE_MANGLED_RA_P (info))
+    return 0;
+
+  /* With a fixed RA offset the offsets are { CFA [, FP] }.  */
+  int32_t fp_offset = 0;
+  if (noffsets > 1)
+    fp_offset = sframe_read_offset (offsets + osize, osize);
+  if (fp_offset != (int16_t) fp_offset)
+    return 0;
+  row->cfa_offset = sframe_read_offset (offsets, osize);
+  row->fp_offset = fp_offset;
+  row->ra_offset = mod->ra_offset;
+  row->flags = SFRAME_ROW_FOUND;
+  if (SFRAME_V1_FRE_CFA_BASE_REG_ID (info) == SFRAME_BASE_REG_FP)
+    row->flags |= SFRAME_ROW_CFA_FP;
+  return 1;
+}
+
+static inline uint64_t
+sframe_pack_row (const struct SFrameRow *row)
+{
+  return ((uint64_t) (uint32_t) row->cfa_offset
+	  | ((uint64_t) (uint16_t) row->fp_offset << 32)
+	  | ((uint64_t) (uint8_t) row->ra_offset << 48)
+	  | ((uint64_t) row->flags << 56));
+}
+
+static inline void
+sframe_unpack_row (uint64_t val, struct SFrameRow *row)
+{
+  row->cfa_offset = (int32_t) (uint32_t) val;
+  row->fp_offset = (int16_t) (uint16_t) (val >> 32);
+  row->ra_offset = (int8_t) (uint8_t) (val >> 48);
+  row->flags = (uint8_t) (val >> 56);
+}
+
+/* Look up the row for PC of generation GEN of the module table, in the
+   cache first.  */
+static int
+sframe_lookup_1 (unsigned long pc, uint32_t gen, struct SFrameRow *row)
+{
+  struct SFrameCacheEntry *entry = SFrameCache + ((pc * ROOT_IDX) >> 48);
+  uint32_t seq = entry->seq;
+  if ((seq & 1) == 0 && entry->pc == pc && entry->gen == gen)
+    {
+      uint64_t val = entry->row;
+      if (entry->seq == seq)
+	{
+	  sframe_unpack_row (val, row);
+	  return row->flags & SFRAME_ROW_FOUND;
+	}
+    }
+
+  /* Find the module with a binary search.  */
+  const struct SFrameTable *tbl = sframe_tables + ((gen >> 1) & 1);
+  int lo = 0;
+  int hi = tbl->nmodules - 1;
+  const struct SFrameModule *mod = NULL;
+  while (lo <= hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (pc < tbl->modules[mid].tbgn)
+	hi = mid - 1;
+      else if (pc >= tbl->modules[mid].tend)
+	lo = mid + 1;
+      else
+	{
+	  mod = tbl->modules + mid;
+	  break;
+	}
+    }
+  if (mod == NULL || !sframe_find_row (mod, pc, row))
+    CALL_UTIL (memset)(row, 0, sizeof (*row));
+
+  /* Skip the cache if another unwinder is writing this entry.  */
+  seq = entry->seq;
+  if ((seq & 1) == 0 && __collector_cas_32 (&entry->seq, seq, seq + 1) == seq)
+    {
+      entry->pc = pc;
+      entry->gen = gen;
+      entry->row = sframe_pack_row (row);
+      entry->seq = seq + 2;
+    }
+  return row->flags & SFRAME_ROW_FOUND;
+}
+
+/* Count the calling thread as a reader of the module table and of the
+   SFrame sections until sframe_leave.  Return its slot, or NULL if the
+   SFrame sections are not used.  */
+static volatile uint32_t *
+sframe_enter (void)
+{
+  if (SFrameCache == NULL)
+    return NULL;
+  volatile uint32_t *slot
+	  = &sframe_readers[(uint32_t) __collector_gettid () % SFRAME_READER_SLOTS].count;
+  /* The locked increment orders it before the reads of sframe_gen.  */
+  __collector_inc_32 ((uint32_t *) slot);
+  return slot;
+}
+
+static void
+sframe_leave (volatile uint32_t *slot)
+{
+  if (slot != NULL)
+    __collector_dec_32 (slot);
+}
+
+/* Look up the row for PC.  Return 0 if the SFrame sections do not
+   describe PC, or if the module table is being updated.  The caller
+   must be between sframe_enter and sframe_leave.  */
+static int
+sframe_lookup (unsigned long pc, struct SFrameRow *row)
+{
+  uint32_t gen = sframe_gen;
+  if (SFrameCache == NULL || (gen & 1) != 0)
+    return 0;
+  return sframe_lookup_1 (pc, gen, row);
+}
+
+/* Unwind one frame using the SFrame row for wctx->pc.  */
+static int
+sframe_ret_addr (struct WalkContext *wctx)
+{
+  struct SFrameRow row;
+  if (!sframe_lookup (wctx->caller ? wctx->pc - 1 : wctx->pc, &row))
+    return RA_FAILURE;
+
+  unsigned long base = (row.flags & SFRAME_ROW_CFA_FP) ? wctx->fp : wctx->sp;
+  if (base < wctx->sp || base >= wctx->sbase)
+    return RA_FAILURE;
+  unsigned long cfa = base + row.cfa_offset;
+  unsigned long ra_loc = cfa + row.ra_offset;
+  if (cfa <= wctx->sp || cfa > wctx->sbase || (cfa & 7) != 0
+      || ra_loc < wctx->sp || ra_loc + sizeof (long) > wctx->sbase)
+    return RA_FAILURE;
+  unsigned long fp = wctx->fp;
+  if (row.fp_offset != 0)
+    {
+      unsigned long fp_loc = cfa + row.fp_offset;
+      if (fp_loc < wctx->sp || fp_loc + sizeof (long) > wctx->sbase)
+	return RA_FAILURE;
+      fp = *(unsigned long *) fp_loc;
+    }
+  unsigned long ra = *(unsigned long *) ra_loc;
+  if (ra == 0)
+    {
+      DprintfT (SP_DUMP_UNWIND, "unwind.c:%d sframe RA_END_OF_STACK\n", __LINE__);
+      wctx->pc = 0;
+      wctx->sp = cfa;
+      wctx->fp = fp;
+      return RA_END_OF_STACK;
+    }
+  unsigned long tbgn = wctx->tbgn;
+  unsigned long tend = wctx->tend;
+  if (ra < tbgn || ra >= tend)
+    if (!__collector_check_segment (ra, &tbgn, &tend, 0))
+      return RA_FAILURE;
+  unsigned long npc = adjust_ret_addr (ra, ra - tbgn, tend);
+  if (npc == 0)
+    return RA_FAILURE;
+  DprintfT (SP_DUMP_UNWIND, "unwind.c:%d sframe pc=0x%lX cfa=0x%lX\n", __LINE__, npc, cfa);
+  wctx->pc = npc;
+  wctx->sp = cfa;
+  wctx->fp = fp;
+  wctx->tbgn = tbgn;
+  wctx->tend = tend;
+  return RA_SUCCESS;
+}
+#endif /* WSIZE(64) */
+
 static int
 find_i386_ret_addr (struct WalkContext *wctx, int do_walk)
 {
@@ -1895,6 +2365,13 @@ find_i386_ret_addr (struct WalkContext *wctx, int do_walk)
   if (retc != RA_FAILURE)
     return retc;
 
+#if WSIZE(64)
+  /* Use the SFrame section, if the module has one */
+  retc = sframe_ret_addr (wctx);
+  if (retc != RA_FAILURE)
+    return retc;
+#endif
+
   /* An attempt to perform code analysis for call stack tracing */
   unsigned char opcode;
   unsigned char extop;
@@ -4431,6 +4908,7 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
   wctx.sp = GET_SP (context);
   wctx.fp = GET_FP (context);
   wctx.ln = (unsigned long) context->uc_link;
+  wctx.caller = 0;
   unsigned long *sbase = (unsigned long*) __collector_tsd_get_by_key (unwind_key);
   if (sbase && *sbase > wctx.sp)
     wctx.sbase = *sbase;
@@ -4442,6 +4920,9 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
     }
   // We do not know yet if update_map_segments is really needed
   __collector_check_segment (wctx.pc, &wctx.tbgn, &wctx.tend, 0);
+#if WSIZE(64)
+  volatile uint32_t *sframe_slot = sframe_enter ();
+#endif
 
   for (;;)
     {
@@ -4481,6 +4962,7 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
 
 	  if (ret == RA_END_OF_STACK)
 	    goto exit;
+	  wctx.caller = 1;
 #if WSIZE(32)
 	  if (ret == RA_RT_SIGRETURN)
 	    {
@@ -4506,6 +4988,7 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
 		}
 	      wctx.sp = nsp;
 	      wctx.fp = GET_FP (ncontext);
+	      wctx.caller = 0;
 	      break;
 	    }
 	  else if (ret == RA_SIGRETURN)
@@ -4519,6 +5002,7 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
 		}
 	      wctx.sp = sctx->esp;
 	      wctx.fp = sctx->ebp;
+	      wctx.caller = 0;
 	      break;
 	    }
 #elif WSIZE(64)
@@ -4540,6 +5024,7 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
 		}
 	      wctx.sp = nsp;
 	      wctx.fp = GET_FP (ncontext);
+	      wctx.caller = 0;
 	      break;
 	    }
 #endif /* WSIZE() */
@@ -4563,6 +5048,9 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
     }
 
 exit:
+#if WSIZE(64)
+  sframe_leave (sframe_slot);
+#endif
 #if defined(DEBUG)
   if ((SP_DUMP_UNWIND & __collector_tracelevel) != 0)
     {
@@ -77,6 +77,7 @@ static Cmdtable cmd_lst[] = {   // list of commands
   { CRMFIRST, "crmfirst", NULL, NULL, 0, &desc[CRMFIRST]},
   { CRMLAST, "crmlast", NULL, NULL, 0, &desc[CRMLAST]},
   { CALLTREE, "calltree", "ctree", NULL, 0, &desc[CALLTREE]},
+  { REGRESSIONS, "regressions", NULL, NULL, 0, &desc[REGRESSIONS]},
 
   { NO_CMD, "", NULL, NULL, 0, &lahdr},
   { LEAKS, "leaks", NULL, NULL, 0, &desc[LEAKS]},
@@ -171,6 +172,7 @@ static Cmdtable cmd_lst[] = {   // list of commands
   { OPEN_EXP, "open_exp", NULL, "experiment", 1, &desc[OPEN_EXP]},
   { ADD_EXP, "add_exp", NULL, "experiment", 1, &desc[ADD_EXP]},
   { DROP_EXP, "drop_exp", NULL, "experiment", 1, &desc[DROP_EXP]},
+  { REFRESH_EXP, "refresh", NULL, NULL, 0, &desc[REFRESH_EXP]},
 
   { NO_CMD, "", NULL, NULL, 0, &deflthdr},
   { DMETRICS, "dmetrics", NULL, "metric_spec", 1, &desc[DMETRICS]},
@@ -208,6 +210,7 @@ static Cmdtable cmd_lst[] = {   // list of commands
   { DUMPUNK, "dunkpc", NULL, NULL, 0, &desc[DUMPUNK]},
   { DUMPMAP, "dmap", NULL, NULL, 0, &desc[DUMPMAP]},
   { DUMPENTITIES, "dentities", NULL, NULL, 0, &desc[DUMPENTITIES]},
+  { DUMP_LOAD_STATS, "dloadstats", NULL, NULL, 0, &desc[DUMP_LOAD_STATS]},
   { IGNORE_NO_XHWCPROF, "ignore_no_xhwcprof", NULL, NULL, 0, &desc[IGNORE_NO_XHWCPROF]},
   { IGNORE_FS_WARN, "ignore_fs_warn", NULL, NULL, 0, &desc[IGNORE_FS_WARN]},
 
@@ -445,6 +448,7 @@ Command::init_desc ()
   desc[SORT] = GTXT ("sort tables by the specified metric");
   desc[GPROF] = GTXT ("display the callers-callees for each function");
   desc[CALLTREE] = GTXT ("display the tree of function calls");
+  desc[REGRESSIONS] = GTXT ("display the call paths that regressed in the compared experiments");
   desc[CALLFLAME] = GTXT ("request calltree flame chart -- not a command, but used in the tabs command");
   desc[GMETRIC_LIST] = GTXT ("display the available callers-callees metrics");
   desc[FSINGLE] = GTXT ("display the summary metrics for specified function");
@@ -505,6 +509,7 @@ Command::init_desc ()
   desc[ADD_EXP] = GTXT ("add experiment or group");
   desc[DROP_EXP] = GTXT ("drop experiment");
   desc[OPEN_EXP] = GTXT ("open experiment or group (drops all loaded experiments first)");
+  desc[REFRESH_EXP] = GTXT ("load the data recorded since the experiments were loaded");
   desc[VERSION_cmd] = GTXT ("display the current release version");
   desc[HELP] = GTXT ("display the list of available commands");
   desc[QUIT] = GTXT ("terminate processing and exit");
@@ -531,6 +536,7 @@ Command::init_desc ()
   desc[DUMPDOBJS] = GTXT ("dump dataobjects whose name matches string");
   desc[DUMPMAP] = GTXT ("dump load-object map");
   desc[DUMPENTITIES] = GTXT ("dump threads, lwps, cpus");
+  desc[DUMP_LOAD_STATS] = GTXT ("dump data file loading statistics");
   desc[DUMP_PROFILE] = GTXT ("dump clock profile events");
   desc[DUMP_SYNC] = GTXT ("dump synchronization trace events");
   desc[DUMP_IOTRACE] = GTXT ("dump IO trace events");
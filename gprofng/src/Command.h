@@ -65,6 +65,7 @@ enum CmdType
   CRMLAST,
   CALLTREE,
   CALLFLAME,
+  REGRESSIONS,
 
   // Source/disassembly control commands
   SCOMPCOM,
@@ -161,6 +162,7 @@ enum CmdType
   ADD_EXP,
   DROP_EXP,
   OPEN_EXP,
+  REFRESH_EXP,
 
   // .rc-only Commands
   DMETRICS,
@@ -187,6 +189,7 @@ enum CmdType
   DUMPDOBJS,
   DUMPMAP,
   DUMPENTITIES,
+  DUMP_LOAD_STATS,
   DUMP_PROFILE,
   DUMP_SYNC,
   DUMP_HWC,
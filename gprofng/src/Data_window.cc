@@ -23,6 +23,8 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>     //  for close();
+#include <errno.h>
+#include <zlib.h>
 
 #include "util.h"
 #include "Data_window.h"
@@ -34,6 +36,25 @@ enum
   WIN_ALIGN     = 8
 };
 
+// Compressed data files start with a header, followed by the file offsets
+// of the compressed blocks (one more than the number of blocks), followed
+// by the blocks.  Each block holds zblksize bytes of the original file
+// (the last one may hold fewer) compressed by zlib.  The magic starts
+// with a zero packet size, which is never found at the start of a data
+// file.
+#define DWIN_ZMAGIC       "\0\0GPNGZ"
+#define DWIN_ZBLKSIZE     (1 << 20)
+#define DWIN_BYTE_ORDER   0x01020304
+
+typedef struct
+{
+  char magic[8];        // DWIN_ZMAGIC
+  uint32_t byte_order;  // DWIN_BYTE_ORDER in the byte order of the writer
+  uint32_t blksize;     // size of an uncompressed block
+  uint64_t fsize;       // size of the uncompressed file
+  uint64_t nblocks;     // number of blocks
+} DataZHeader;
+
 Data_window::Data_window (char *file_name)
 {
   Dprintf (DEBUG_DATA_WINDOW, NTXT ("Data_window:%d %s\n"), (int) __LINE__, STR (file_name));
@@ -47,6 +68,11 @@ Data_window::Data_window (char *file_name)
   basesize = 0;
   fname = dbe_strdup (file_name);
   mmap_on_file = false;
+  zblksize = 0;
+  znblocks = 0;
+  zoffsets = NULL;
+  zblock = NULL;
+  zblock_idx = -1;
   use_mmap = false;
 #if DEBUG
   if (DBE_USE_MMAP)
@@ -63,6 +89,14 @@ Data_window::Data_window (char *file_name)
       return;
     }
   opened = true;
+  if (!open_compressed ())
+    {
+      close (fd);
+      fd = -1;
+      opened = false;
+      fsize = 0;
+      return;
+    }
   if (use_mmap)
     {
       if (fsize != -1)
@@ -162,8 +196,12 @@ Data_window::bind (Span *span, int64_t minSize)
 	  if (wsize > fsize - woffset)
 	    wsize = fsize - woffset;
 	  off_t woff = (off_t) woffset;
-	  if (base == NULL || woff != lseek (myfd, woff, SEEK_SET)
-	      || wsize != read_from_file (myfd, base, wsize))
+	  if (base == NULL)
+	    remap_failed = true;
+	  else if (zoffsets != NULL)
+	    remap_failed = !read_compressed (myfd);
+	  else if (woff != lseek (myfd, woff, SEEK_SET)
+		   || wsize != read_from_file (myfd, base, wsize))
 	    remap_failed = true;
 	}
       if (fd == -1)
@@ -197,9 +235,200 @@ Data_window::get_data (int64_t offset, int64_t size, void *datap)
   return buf;
 }
 
+// Check whether the opened file is compressed and, if it is, read its
+// block index.  Return false if the file is a corrupted compressed file.
+bool
+Data_window::open_compressed ()
+{
+  DataZHeader hdr;
+  if (fsize < (int64_t) sizeof (hdr)
+      || pread (fd, &hdr, sizeof (hdr), 0) != (ssize_t) sizeof (hdr)
+      || memcmp (hdr.magic, DWIN_ZMAGIC, sizeof (hdr.magic)) != 0)
+    return true;
+  bool swap = hdr.byte_order != DWIN_BYTE_ORDER;
+  if (swap)
+    {
+      SWAP_ENDIAN (hdr.byte_order);
+      SWAP_ENDIAN (hdr.blksize);
+      SWAP_ENDIAN (hdr.fsize);
+      SWAP_ENDIAN (hdr.nblocks);
+      if (hdr.byte_order != DWIN_BYTE_ORDER)
+	return false;
+    }
+  if (hdr.blksize == 0 || hdr.fsize == 0
+      || hdr.nblocks != (hdr.fsize + hdr.blksize - 1) / hdr.blksize)
+    return false;
+  int64_t nblocks = (int64_t) hdr.nblocks;
+  int64_t isize = (nblocks + 1) * sizeof (uint64_t);
+  if ((int64_t) sizeof (hdr) + isize > fsize)
+    return false;
+  uint64_t *offsets = (uint64_t *) malloc (isize);
+  if (offsets == NULL)
+    return false;
+  if (pread (fd, offsets, isize, sizeof (hdr)) != isize)
+    {
+      free (offsets);
+      return false;
+    }
+  zoffsets = (int64_t *) malloc ((nblocks + 1) * sizeof (int64_t));
+  if (zoffsets == NULL)
+    {
+      free (offsets);
+      return false;
+    }
+  for (int64_t i = 0; i <= nblocks; i++)
+    {
+      if (swap)
+	SWAP_ENDIAN (offsets[i]);
+      zoffsets[i] = (int64_t) offsets[i];
+      if (zoffsets[i] > fsize || (i > 0 && zoffsets[i] < zoffsets[i - 1]))
+	{
+	  free (offsets);
+	  free (zoffsets);
+	  zoffsets = NULL;
+	  return false;
+	}
+    }
+  free (offsets);
+  zblksize = hdr.blksize;
+  znblocks = nblocks;
+  fsize = (int64_t) hdr.fsize;
+  use_mmap = false;
+  return true;
+}
+
+// Fill the current window from a compressed file.
+bool
+Data_window::read_compressed (int myfd)
+{
+  char *dst = (char *) base;
+  for (int64_t off = woffset, end = woffset + wsize; off < end;)
+    {
+      int64_t blk = off / zblksize;
+      int64_t blk_size = fsize - blk * zblksize;
+      if (blk_size > zblksize)
+	blk_size = zblksize;
+      if (blk != zblock_idx)
+	{
+	  if (zblock == NULL)
+	    zblock = (char *) malloc (zblksize);
+	  int64_t csize = zoffsets[blk + 1] - zoffsets[blk];
+	  char *cbuf = (char *) malloc (csize);
+	  uLongf len = (uLongf) blk_size;
+	  bool ok = pread (myfd, cbuf, csize, zoffsets[blk]) == csize
+		  && uncompress ((Bytef *) zblock, &len, (Bytef *) cbuf,
+				 (uLong) csize) == Z_OK
+		  && len == (uLongf) blk_size;
+	  free (cbuf);
+	  if (!ok)
+	    {
+	      zblock_idx = -1;
+	      return false;
+	    }
+	  zblock_idx = blk;
+	}
+      int64_t boff = off - blk * zblksize;
+      int64_t n = blk_size - boff;
+      if (n > end - off)
+	n = end - off;
+      memcpy (dst, zblock + boff, n);
+      dst += n;
+      off += n;
+    }
+  return true;
+}
+
+char *
+Data_window::compress_file (const char *filename)
+{
+  int fd = open64 (filename, O_RDONLY);
+  if (fd == -1)
+    return dbe_sprintf (GTXT ("Cannot open %s: %s"), filename,
+			strerror (errno));
+  dbe_stat_t sbuf;
+  DataZHeader hdr;
+  if (fstat64 (fd, &sbuf) != 0 || sbuf.st_size == 0
+      || (sbuf.st_size >= (off64_t) sizeof (hdr)
+	  && pread (fd, &hdr, sizeof (hdr), 0) == (ssize_t) sizeof (hdr)
+	  && memcmp (hdr.magic, DWIN_ZMAGIC, sizeof (hdr.magic)) == 0))
+    {
+      // Empty or already compressed
+      close (fd);
+      return NULL;
+    }
+
+  int64_t size = sbuf.st_size;
+  int64_t nblocks = (size + DWIN_ZBLKSIZE - 1) / DWIN_ZBLKSIZE;
+  int64_t isize = (nblocks + 1) * sizeof (uint64_t);
+  uint64_t *offsets = (uint64_t *) malloc (isize);
+  char *buf = (char *) malloc (DWIN_ZBLKSIZE);
+  uLong cbufsize = compressBound (DWIN_ZBLKSIZE);
+  char *cbuf = (char *) malloc (cbufsize);
+  char *tmpname = dbe_sprintf (NTXT ("%s.tmp.%d"), filename, (int) getpid ());
+  char *errmsg = NULL;
+  int tfd = open64 (tmpname, O_WRONLY | O_CREAT | O_TRUNC, sbuf.st_mode & 0777);
+  if (tfd == -1)
+    errmsg = dbe_sprintf (GTXT ("Cannot create %s: %s"), tmpname,
+			  strerror (errno));
+
+  int64_t off = sizeof (hdr) + isize;
+  for (int64_t i = 0; errmsg == NULL && i < nblocks; i++)
+    {
+      int64_t len = size - i * DWIN_ZBLKSIZE;
+      if (len > DWIN_ZBLKSIZE)
+	len = DWIN_ZBLKSIZE;
+      uLongf clen = cbufsize;
+      if (read_from_file (fd, buf, len) != len)
+	errmsg = dbe_sprintf (GTXT ("Cannot read %s: %s"), filename,
+			      strerror (errno));
+      else if (compress2 ((Bytef *) cbuf, &clen, (Bytef *) buf, (uLong) len,
+			  Z_DEFAULT_COMPRESSION) != Z_OK)
+	errmsg = dbe_sprintf (GTXT ("Cannot compress %s"), filename);
+      else if (pwrite (tfd, cbuf, clen, off) != (ssize_t) clen)
+	errmsg = dbe_sprintf (GTXT ("Cannot write %s: %s"), tmpname,
+			      strerror (errno));
+      offsets[i] = off;
+      off += clen;
+    }
+  offsets[nblocks] = off;
+  if (errmsg == NULL)
+    {
+      memcpy (hdr.magic, DWIN_ZMAGIC, sizeof (hdr.magic));
+      hdr.byte_order = DWIN_BYTE_ORDER;
+      hdr.blksize = DWIN_ZBLKSIZE;
+      hdr.fsize = size;
+      hdr.nblocks = nblocks;
+      if (pwrite (tfd, &hdr, sizeof (hdr), 0) != (ssize_t) sizeof (hdr)
+	  || pwrite (tfd, offsets, isize, sizeof (hdr)) != isize)
+	errmsg = dbe_sprintf (GTXT ("Cannot write %s: %s"), tmpname,
+			      strerror (errno));
+    }
+  if (tfd != -1 && close (tfd) != 0 && errmsg == NULL)
+    errmsg = dbe_sprintf (GTXT ("Cannot write %s: %s"), tmpname,
+			  strerror (errno));
+  close (fd);
+
+  // Keep the original file if compression does not make it smaller.
+  if (errmsg != NULL || off >= size || rename (tmpname, filename) != 0)
+    {
+      if (errmsg == NULL && off < size)
+	errmsg = dbe_sprintf (GTXT ("Cannot rename %s: %s"), tmpname,
+			      strerror (errno));
+      if (tfd != -1)
+	unlink (tmpname);
+    }
+  free (tmpname);
+  free (cbuf);
+  free (buf);
+  free (offsets);
+  return errmsg;
+}
+
 Data_window::~Data_window ()
 {
   free (fname);
+  free (zoffsets);
+  free (zblock);
   if (fd != -1)
     close (fd);
   if (base)
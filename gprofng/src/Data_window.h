@@ -27,6 +27,11 @@
 // The Data_window base class implements a set of windows into a raw data file.
 // It is responsible for mapping and unmapping regions of the file as
 // requested by other levels inside of the DBE.
+//
+// A data file may also be stored compressed, as written by
+// Data_window::compress_file.  Such a file is decompressed transparently,
+// one block at a time, and the offsets and sizes seen by the users of the
+// class are those of the uncompressed data.
 
 #include "util.h"
 
@@ -54,6 +59,11 @@ public:
 
   bool not_opened ()            { return !opened; }
   off64_t get_fsize ()          { return fsize; }
+  bool is_compressed ()         { return zoffsets != NULL; }
+
+  // Compress the data file FILENAME in place.  Return NULL on success,
+  // or an error message that the caller must free.
+  static char *compress_file (const char *filename);
 
   template <typename Key_t> inline Key_t
   get_align_val (Key_t *vp)
@@ -86,6 +96,9 @@ protected:
   bool mmap_on_file;
 
 private:
+  bool open_compressed ();
+  bool read_compressed (int myfd);
+
   long page_size;       // used in mmap()
   bool use_mmap;
   bool opened;
@@ -94,6 +107,13 @@ private:
   int64_t woffset;      // offset of current window
   int64_t wsize;        // size of current window
   int64_t basesize;     // size of allocated window
+
+  // Compressed data file
+  int64_t zblksize;     // size of an uncompressed block
+  int64_t znblocks;     // number of blocks
+  int64_t *zoffsets;    // file offsets of the compressed blocks
+  char *zblock;         // last uncompressed block
+  int64_t zblock_idx;   // index of the block in zblock
 };
 
 #endif /* _DATA_WINDOW_H */
@@ -1486,6 +1486,28 @@ DbeSession::drop_experiment (int exp_ind)
   return NULL;
 }
 
+/* Load the data recorded since the experiments were loaded, for the
+   experiments that were still being written then, and recompute the data
+   shown by the views.  Return the number of new events.  */
+long
+DbeSession::refresh_experiments ()
+{
+  Experiment *exp;
+  DbeView *dbev;
+  int index;
+  long cnt = 0;
+  Vec_loop (Experiment*, exps, index, exp)
+  {
+    cnt += exp->refresh_data ();
+  }
+  if (cnt > 0)
+    Vec_loop (DbeView*, views, index, dbev)
+    {
+      dbev->refresh_data ();
+    }
+  return cnt;
+}
+
 int
 DbeSession::find_experiment (char *path)
 {
@@ -2848,6 +2870,17 @@ DbeSession::dump_map (FILE *out)
   }
 }
 
+void
+DbeSession::dump_load_stats (FILE *out)
+{
+  Experiment *exp;
+  int index;
+  Vec_loop (Experiment*, exps, index, exp)
+  {
+    exp->dump_load_stats (out);
+  }
+}
+
 void
 DbeSession::dump_stacks (FILE *outfile)
 {
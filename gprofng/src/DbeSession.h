@@ -141,6 +141,7 @@ public:
   Vector<Vector<char*>*> *getExperimensGroups ();
   char *setExperimentsGroups (Vector<Vector<char*>*> *groups);
   char *drop_experiment (int exp_ind);
+  long refresh_experiments ();
   int find_experiment (char *path);
 
   int
@@ -324,6 +325,7 @@ public:
   void dump_dataobjects (FILE *);
   void dump_segments (FILE *);
   void dump_map (FILE *);
+  void dump_load_stats (FILE *);
 
   // Find dynamic property by name
   int registerPropertyName (const char *name);
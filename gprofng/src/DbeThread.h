@@ -45,6 +45,7 @@ public:
   DbeQueue *get_queue ();
   void put_queue (DbeQueue *q);
   void wait_queues ();
+  int get_max_threads ()    { return max_threads; }
 
   pthread_mutex_t p_mutex;
   pthread_cond_t p_cond_var;
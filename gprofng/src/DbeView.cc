@@ -373,6 +373,15 @@ DbeView::reset ()
   newViewMode = false;
 }
 
+/* Drop the data computed from the events, since events have been added
+   to the experiments.  */
+void
+DbeView::refresh_data ()
+{
+  purge_events ();
+  reset_data (false);
+}
+
 void
 DbeView::reset_data (bool all)
 {
@@ -1857,6 +1866,12 @@ DbeView::get_cstack_data (MetricList *mlist)
   return ptree->get_cstack_data (mlist);
 }
 
+Diff_data *
+DbeView::get_diff_data (BaseMetric *bm)
+{
+  return ptree->get_diff_data (bm);
+}
+
 Stats_data *
 DbeView::get_stats_data (int index)
 {
@@ -421,6 +421,7 @@ public:
   bool set_libdefaults ();
   void reset ();
   void reset_data (bool all);
+  void refresh_data ();
 
   char *
   get_error_msg ()
@@ -573,6 +574,7 @@ public:
 			    PathTree::PtreeComputeOption flag = PathTree::COMPUTEOPT_NONE
 			    );
   CStack_data *get_cstack_data (MetricList *);
+  Diff_data *get_diff_data (BaseMetric *);
   Stats_data *get_stats_data (int index);
   Ovw_data *get_ovw_data (int index);
 
@@ -28,6 +28,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/param.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <set>
 
 #include "util.h"
@@ -1389,6 +1391,11 @@ Experiment::Experiment ()
   cstack = NULL;
   cstackShowHide = NULL;
   frmpckts = new Vector<RawFramePacket*>;
+  load_stats = new Vector<DataFileStats*>;
+  live_files = new Vector<LiveDataFile*>;
+  live_regions = NULL;
+  unresolved_frinfo = new Vector<long>;
+  cache_maps = new Vector<DataCacheMap*>;
   typedef DefaultMap2D<uint32_t, hrtime_t, uint64_t> OmpMap0;
   mapPRid = new OmpMap0 (OmpMap0::Interval);
   typedef DefaultMap2D<uint32_t, hrtime_t, void*> OmpMap;
@@ -1466,6 +1473,18 @@ Experiment::~Experiment ()
   delete heapUnmapEvents;
   frmpckts->destroy ();
   delete frmpckts;
+  load_stats->destroy ();
+  delete load_stats;
+  live_files->destroy ();
+  delete live_files;
+  delete unresolved_frinfo;
+  for (long i = 0, sz = cache_maps->size (); i < sz; i++)
+    {
+      DataCacheMap *map = cache_maps->fetch (i);
+      munmap (map->base, map->size);
+    }
+  cache_maps->destroy ();
+  delete cache_maps;
   samples->destroy ();
   delete samples;
   delete fDataMap;
@@ -4459,43 +4478,76 @@ check_mstate (char *ptr, PacketDescriptor *pDscr, int arg)
 
 #define PACKET_ALIGNMENT 4
 
-uint64_t
-Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
+/* Bind the packet at the start of SPAN.  Return NULL if there is no valid
+   packet there, with *SIZE set to the number of bytes to skip, or to 0 at
+   the end of the data.  Count invalid packets in *INVALID.  The skipped
+   parts that are not written yet are added to live_regions, if set.  */
+char *
+Experiment::bindPacket (Data_window *dwin, Data_window::Span *span,
+			uint64_t *size, int *invalid)
 {
   Common_packet *rcp = (Common_packet *) dwin->bind (span,
 						    sizeof (CommonHead_packet));
   uint16_t v16;
-  uint64_t size = 0;
+  *size = 0;
   if (rcp)
     {
       if ((((long) rcp) % PACKET_ALIGNMENT) != 0)
 	{
-	  invalid_packet++;
-	  size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
-	  return size;
+	  (*invalid)++;
+	  *size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
+	  return NULL;
 	}
       v16 = (uint16_t) rcp->tsize;
-      size = dwin->decode (v16);
-      if (size == 0)
+      *size = dwin->decode (v16);
+      if (*size == 0)
 	{
-	  size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
-	  return size;
+	  *size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
+	  if (live_regions)
+	    {
+	      live_regions->append (span->offset);
+	      live_regions->append (span->offset + *size);
+	    }
+	  return NULL;
 	}
-      rcp = (Common_packet *) dwin->bind (span, size);
+      rcp = (Common_packet *) dwin->bind (span, *size);
     }
   if (rcp == NULL)
-    return 0;
+    {
+      *size = 0;
+      return NULL;
+    }
 
   if ((((long) rcp) % PACKET_ALIGNMENT) != 0)
     {
-      invalid_packet++;
-      size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
-      return size;
+      (*invalid)++;
+      *size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
+      return NULL;
     }
+  return (char *) rcp;
+}
+
+uint64_t
+Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
+{
+  uint64_t size;
+  Common_packet *rcp = (Common_packet *) bindPacket (dwin, span, &size,
+						     &invalid_packet);
+  if (rcp == NULL)
+    return size;
+  uint16_t v16;
   v16 = (uint16_t) rcp->type;
   uint32_t rcptype = dwin->decode (v16);
   if (rcptype == EMPTY_PCKT)
-    return size;
+    {
+      // The collector pads the free part of a block with an empty packet
+      if (live_regions)
+	{
+	  live_regions->append (span->offset);
+	  live_regions->append (span->offset + size);
+	}
+      return size;
+    }
   if (rcptype == FRAME_PCKT)
     {
       RawFramePacket *fp = new RawFramePacket;
@@ -4691,6 +4743,20 @@ Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
 void
 Experiment::readPacket (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
 			DataDescriptor *dDscr, int arg, uint64_t pktsz)
+{
+  int sz = pDscr->getFields ()->size ();
+  uint64_t *values = (uint64_t *) alloca (sz * sizeof (uint64_t));
+  decodePacket (dwin, ptr, pDscr, pktsz, values);
+  storePacket (dDscr, pDscr, arg, values);
+}
+
+/* Decode the fields of the packet at PTR into VALUES, without changing
+   the experiment: this is called by the threads reading data chunks.
+   A TYPE_STRING field is decoded to a StringBuilder*, or NULL.  */
+void
+Experiment::decodePacket (Data_window *dwin, char *ptr,
+			  PacketDescriptor *pDscr, uint64_t pktsz,
+			  uint64_t *values)
 {
   union Value
   {
@@ -4698,129 +4764,1515 @@ Experiment::readPacket (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
     uint64_t val64;
   } *v;
 
-  long recn = dDscr->addRecord ();
-  Vector<FieldDescr*> *fields = pDscr->getFields ();
-  int sz = fields->size ();
-  for (int i = 0; i < sz; i++)
+  Vector<FieldDescr*> *fields = pDscr->getFields ();
+  int sz = fields->size ();
+  for (int i = 0; i < sz; i++)
+    {
+      FieldDescr *field = fields->fetch (i);
+      v = (Value*) (ptr + field->offset);
+      values[i] = 0;
+      switch (field->vtype)
+	{
+	case TYPE_INT32:
+	case TYPE_UINT32:
+	  values[i] = dwin->decode (v->val32);
+	  break;
+	case TYPE_INT64:
+	case TYPE_UINT64:
+	  values[i] = dwin->decode (v->val64);
+	  break;
+	case TYPE_STRING:
+	  {
+	    if (field->propID == PROP_THRID || field->propID == PROP_LWPID
+		|| field->propID == PROP_CPUID)
+	      break;
+	    int len = (int) (pktsz - field->offset);
+	    if ((len > 0) && (ptr[field->offset] != 0))
+	      {
+		StringBuilder *sb = new StringBuilder ();
+		sb->append (ptr + field->offset, 0, len);
+		values[i] = (uint64_t) sb;
+	      }
+	    break;
+	  }
+	  // ignoring the following cases (why?)
+	case TYPE_DOUBLE:
+	case TYPE_OBJ:
+	case TYPE_DATE:
+	case TYPE_BOOL:
+	case TYPE_ENUM:
+	case TYPE_LAST:
+	case TYPE_NONE:
+	  break;
+	}
+    }
+}
+
+/* Add a record for the packet decoded into VALUES to DDSCR.  */
+void
+Experiment::storePacket (DataDescriptor *dDscr, PacketDescriptor *pDscr,
+			 int arg, uint64_t *values)
+{
+  long recn = dDscr->addRecord ();
+  Vector<FieldDescr*> *fields = pDscr->getFields ();
+  int sz = fields->size ();
+  for (int i = 0; i < sz; i++)
+    {
+      FieldDescr *field = fields->fetch (i);
+      if (field->propID == arg)
+	{
+	  dDscr->setValue (PROP_NTICK, recn, (uint32_t) values[i]);
+	  dDscr->setValue (PROP_MSTATE, recn, (uint32_t) (field->propID - PROP_UCPU));
+	}
+      if (field->propID == PROP_THRID || field->propID == PROP_LWPID
+	  || field->propID == PROP_CPUID)
+	{
+	  uint32_t tag = mapTagValue ((Prop_type) field->propID, values[i]);
+	  dDscr->setValue (field->propID, recn, tag);
+	}
+      else
+	{
+	  switch (field->vtype)
+	    {
+	    case TYPE_INT32:
+	    case TYPE_UINT32:
+	    case TYPE_INT64:
+	    case TYPE_UINT64:
+	      dDscr->setValue (field->propID, recn, values[i]);
+	      break;
+	    case TYPE_STRING:
+	      if (values[i] != 0)
+		dDscr->setObjValue (field->propID, recn, (void *) values[i]);
+	      break;
+	    case TYPE_DOUBLE:
+	    case TYPE_OBJ:
+	    case TYPE_DATE:
+	    case TYPE_BOOL:
+	    case TYPE_ENUM:
+	    case TYPE_LAST:
+	    case TYPE_NONE:
+	      break;
+	    }
+	}
+    }
+}
+
+/*
+ *    Experiment cache
+ *
+ * With GPROFNG_EXPERIMENT_CACHE set to a non-zero value, the records read
+ * from a data file are saved in <experiment>/cache/<data file>, and later
+ * sessions load them from there instead of decoding the packets again.
+ * The cache holds one table per data descriptor, stored by column:
+ *
+ *   DataCacheHeader
+ *   DataCacheTag [ntags]      thread, LWP and CPU ids in order of appearance
+ *   for each table:
+ *     DataCacheTable
+ *     for each column:
+ *       DataCacheColumn, followed by the values, padded to 8 bytes
+ *
+ * Integer columns hold arrays of 4 or 8 byte values, which are used in
+ * place from the mapped cache.  A string column holds the 4 byte lengths
+ * of the strings, then their characters.  Thread, LWP and CPU ids are
+ * saved as read, since their tags depend on the other files loaded in
+ * the session.
+ *
+ * The cache is only written for files whose records do not refer to
+ * frame or uid packets, and is ignored when the size or modification time
+ * of the data file does not match.  The call stacks of the records are
+ * saved separately, see below.
+ */
+#define DATA_CACHE_MAGIC    "GPNGCOL"
+#define DATA_CACHE_VERSION  1
+#define DATA_CACHE_ORDER    0x01020304
+
+struct DataCacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;    // DATA_CACHE_ORDER in the writer's byte order
+  uint64_t fsize;         // size of the data file
+  int64_t mtime_sec;      // modification time of the data file
+  int64_t mtime_nsec;
+  uint32_t invalid;       // invalid packets in the data file
+  uint32_t ntags;
+  uint32_t ntables;
+  uint32_t reserved;
+};
+
+struct DataCacheTag
+{
+  uint32_t prop;
+  uint32_t reserved;
+  uint64_t value;
+};
+
+struct DataCacheTable
+{
+  uint32_t id;            // data descriptor id
+  uint32_t ncols;
+  uint64_t nrecs;
+};
+
+struct DataCacheColumn
+{
+  uint32_t prop;
+  uint32_t vtype;
+  uint64_t nvals;         // values stored; trailing records have none
+  uint64_t size;          // bytes of data
+};
+
+static const int data_cache_tag_props[] = { PROP_THRID, PROP_LWPID, PROP_CPUID };
+#define DATA_CACHE_NTAG_PROPS \
+  ((int) (sizeof (data_cache_tag_props) / sizeof (data_cache_tag_props[0])))
+
+/* What the experiment looked like before reading a data file, to find
+   what the data file added.  */
+class Experiment::DataCacheState
+{
+public:
+  DataCacheState (Experiment *exp)
+  {
+    dsizes = new Vector<long>;
+    for (long i = 0, sz = exp->dataDscrs->size (); i < sz; i++)
+      {
+	DataDescriptor *dDscr = exp->dataDscrs->fetch (i);
+	dsizes->append (dDscr ? dDscr->getSize () : 0);
+      }
+    for (int i = 0; i < DATA_CACHE_NTAG_PROPS; i++)
+      tags[i] = exp->tagObjs->fetch (data_cache_tag_props[i])->copy ();
+    nframes = exp->frmpckts->size ();
+    nnodes = exp->nnodes;
+  }
+
+  ~DataCacheState ()
+  {
+    delete dsizes;
+    for (int i = 0; i < DATA_CACHE_NTAG_PROPS; i++)
+      delete tags[i];
+  }
+
+  Vector<long> *dsizes;
+  Vector<Histable*> *tags[DATA_CACHE_NTAG_PROPS];
+  long nframes;
+  long nnodes;
+};
+
+static bool
+is_tag_prop (int prop)
+{
+  for (int i = 0; i < DATA_CACHE_NTAG_PROPS; i++)
+    if (data_cache_tag_props[i] == prop)
+      return true;
+  return false;
+}
+
+static int
+data_cache_vsize (int vtype)
+{
+  switch (vtype)
+    {
+    case TYPE_INT32:
+    case TYPE_UINT32:
+      return 4;
+    case TYPE_INT64:
+    case TYPE_UINT64:
+    case TYPE_DOUBLE:
+      return 8;
+    case TYPE_STRING:
+      return 4;
+    default:
+      return 0;
+    }
+}
+
+static int
+tag_cmp (const void *a, const void *b)
+{
+  uint32_t t1 = (*((Other **) a))->tag;
+  uint32_t t2 = (*((Other **) b))->tag;
+  return t1 < t2 ? -1 : t1 > t2 ? 1 : 0;
+}
+
+/* Return true if GPROFNG_EXPERIMENT_CACHE asks for the experiment cache.  */
+static bool
+data_cache_enabled ()
+{
+  char *s = getenv ("GPROFNG_EXPERIMENT_CACHE");
+  return s != NULL && atoi (s) != 0;
+}
+
+static char *
+data_cache_name (const char *expt_name, const char *fname)
+{
+  return dbe_sprintf (NTXT ("%s/%s/%s"), expt_name, SP_CACHE_DIR, fname);
+}
+
+/* Walk the tables of the cache at BASE of SIZE bytes.  Only check them
+   if APPLY is false, otherwise add their records to the data
+   descriptors.  Return false if the cache does not match the
+   experiment.  */
+bool
+Experiment::apply_data_cache (char *base, int64_t size, bool apply)
+{
+  DataCacheHeader *hdr = (DataCacheHeader *) base;
+  int64_t pos = sizeof (DataCacheHeader) + hdr->ntags * sizeof (DataCacheTag);
+  if (pos > size)
+    return false;
+  if (apply)
+    {
+      DataCacheTag *tag = (DataCacheTag *) (base + sizeof (DataCacheHeader));
+      for (uint32_t i = 0; i < hdr->ntags; i++, tag++)
+	mapTagValue ((Prop_type) tag->prop, tag->value);
+      invalid_packet = hdr->invalid;
+    }
+  else
+    {
+      DataCacheTag *tag = (DataCacheTag *) (base + sizeof (DataCacheHeader));
+      for (uint32_t i = 0; i < hdr->ntags; i++, tag++)
+	if (!is_tag_prop (tag->prop))
+	  return false;
+    }
+
+  for (uint32_t t = 0; t < hdr->ntables; t++)
+    {
+      if (pos + (int64_t) sizeof (DataCacheTable) > size)
+	return false;
+      DataCacheTable *tbl = (DataCacheTable *) (base + pos);
+      pos += sizeof (DataCacheTable);
+      DataDescriptor *dDscr = getDataDescriptor (tbl->id);
+      if (dDscr == NULL)
+	return false;
+      long start = dDscr->getSize ();
+      if (apply)
+	for (uint64_t i = 0; i < tbl->nrecs; i++)
+	  dDscr->addRecord ();
+      for (uint32_t c = 0; c < tbl->ncols; c++)
+	{
+	  if (pos + (int64_t) sizeof (DataCacheColumn) > size)
+	    return false;
+	  DataCacheColumn *col = (DataCacheColumn *) (base + pos);
+	  pos += sizeof (DataCacheColumn);
+	  int vsize = data_cache_vsize (col->vtype);
+	  PropDescr *prop = dDscr->getProp (col->prop);
+	  if (prop == NULL || prop->vtype != (VType_type) col->vtype
+	      || vsize == 0 || col->nvals > tbl->nrecs
+	      || col->size > (uint64_t) (size - pos)
+	      || col->size < col->nvals * vsize)
+	    return false;
+	  char *vals = base + pos;
+	  pos += (col->size + 7) & ~7;
+	  if (col->vtype == TYPE_STRING)
+	    {
+	      uint32_t *lens = (uint32_t *) vals;
+	      char *str = vals + col->nvals * sizeof (uint32_t);
+	      char *end = vals + col->size;
+	      for (uint64_t i = 0; i < col->nvals; i++)
+		{
+		  if (lens[i] > (uint64_t) (end - str))
+		    return false;
+		  if (apply && lens[i] != 0)
+		    {
+		      StringBuilder *sb = new StringBuilder ();
+		      sb->append (str, 0, lens[i]);
+		      dDscr->setObjValue (col->prop, start + i, sb);
+		    }
+		  str += lens[i];
+		}
+	      continue;
+	    }
+	  if (!apply)
+	    continue;
+	  bool tag = is_tag_prop (col->prop);
+	  if (!tag && start == 0)
+	    {
+	      // Use the values in place
+	      Data *d = Data::newMappedData ((VType_type) col->vtype, vals,
+					     (long) col->nvals);
+	      if (d != NULL && dDscr->setData (col->prop, d))
+		continue;
+	      delete d;
+	    }
+	  for (uint64_t i = 0; i < col->nvals; i++)
+	    {
+	      uint64_t v = vsize == 4 ? ((uint32_t *) vals)[i]
+		      : ((uint64_t *) vals)[i];
+	      if (tag)
+		v = mapTagValue ((Prop_type) col->prop, v);
+	      dDscr->setValue (col->prop, start + i, v);
+	    }
+	}
+    }
+  return pos <= size;
+}
+
+/* Load the records of the data file FNAME, whose status is SBUF, from the
+   cache.  Return false if there is no valid cache for it.  */
+bool
+Experiment::read_data_cache (const char *fname, dbe_stat_t *sbuf)
+{
+  char *path = data_cache_name (expt_name, fname);
+  int fd = open64 (path, O_RDONLY);
+  free (path);
+  if (fd == -1)
+    return false;
+  dbe_stat_t cbuf;
+  bool ok = false;
+  if (fstat64 (fd, &cbuf) == 0
+      && cbuf.st_size >= (off64_t) sizeof (DataCacheHeader))
+    {
+      int64_t size = cbuf.st_size;
+      void *base = mmap (0, (size_t) size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base != MAP_FAILED)
+	{
+	  DataCacheHeader *hdr = (DataCacheHeader *) base;
+	  ok = memcmp (hdr->magic, DATA_CACHE_MAGIC, sizeof (hdr->magic)) == 0
+		  && hdr->version == DATA_CACHE_VERSION
+		  && hdr->byte_order == DATA_CACHE_ORDER
+		  && hdr->fsize == (uint64_t) sbuf->st_size
+		  && hdr->mtime_sec == (int64_t) sbuf->st_mtim.tv_sec
+		  && hdr->mtime_nsec == (int64_t) sbuf->st_mtim.tv_nsec
+		  && apply_data_cache ((char *) base, size, false);
+	  if (ok)
+	    {
+	      apply_data_cache ((char *) base, size, true);
+	      DataCacheMap *map = new DataCacheMap;
+	      map->base = base;
+	      map->size = (size_t) size;
+	      cache_maps->append (map);
+	    }
+	  else
+	    munmap (base, (size_t) size);
+	}
+    }
+  close (fd);
+  return ok;
+}
+
+/* Save the records added by the data file FNAME, whose status is SBUF,
+   since the experiment was in the state OLD.  */
+void
+Experiment::write_data_cache (const char *fname, dbe_stat_t *sbuf,
+			      DataCacheState *old)
+{
+  if (frmpckts->size () != old->nframes || nnodes != old->nnodes)
+    return;
+
+  // Tags in order of appearance, and the values of all tags
+  Vector<Other*> *new_tags = new Vector<Other*>;
+  DefaultMap<int64_t, Other*> *tag_values[DATA_CACHE_NTAG_PROPS];
+  bool ok = true;
+  for (int i = 0; i < DATA_CACHE_NTAG_PROPS; i++)
+    {
+      Vector<Histable*> *objs = tagObjs->fetch (data_cache_tag_props[i]);
+      Vector<Histable*> *prev = old->tags[i];
+      Vector<Other*> *added = new Vector<Other*>;
+      tag_values[i] = new DefaultMap<int64_t, Other*>;
+      for (long j = 0, k = 0, sz = objs->size (); j < sz; j++)
+	{
+	  Other *obj = (Other *) objs->fetch (j);
+	  if (k < prev->size () && prev->fetch (k) == obj)
+	    k++;
+	  else
+	    added->append (obj);
+	  if (tag_values[i]->get (obj->tag) != NULL)
+	    ok = false; // the tag of two values is the same
+	  tag_values[i]->put (obj->tag, obj);
+	}
+      added->sort (tag_cmp);
+      new_tags->addAll (added);
+      delete added;
+    }
+
+  char *dir = dbe_sprintf (NTXT ("%s/%s"), expt_name, SP_CACHE_DIR);
+  mkdir (dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+  char *tmp_name = dbe_sprintf (NTXT ("%s/%s_%llx"), dir, fname,
+				(unsigned long long) gethrtime ());
+  free (dir);
+  FILE *f = ok ? fopen (tmp_name, NTXT ("w")) : NULL;
+  if (f != NULL)
+    {
+      DataCacheHeader hdr;
+      memset (&hdr, 0, sizeof (hdr));
+      memcpy (hdr.magic, DATA_CACHE_MAGIC, sizeof (hdr.magic));
+      hdr.version = DATA_CACHE_VERSION;
+      hdr.byte_order = DATA_CACHE_ORDER;
+      hdr.fsize = sbuf->st_size;
+      hdr.mtime_sec = sbuf->st_mtim.tv_sec;
+      hdr.mtime_nsec = sbuf->st_mtim.tv_nsec;
+      hdr.invalid = invalid_packet;
+      hdr.ntags = new_tags->size ();
+      for (long i = 0, sz = old->dsizes->size (); i < sz; i++)
+	if (dataDscrs->fetch (i) && dataDscrs->fetch (i)->getSize () > old->dsizes->fetch (i))
+	  hdr.ntables++;
+      fwrite (&hdr, sizeof (hdr), 1, f);
+      for (long i = 0, sz = new_tags->size (); i < sz; i++)
+	{
+	  Other *obj = new_tags->fetch (i);
+	  DataCacheTag tag;
+	  memset (&tag, 0, sizeof (tag));
+	  for (int j = 0; j < DATA_CACHE_NTAG_PROPS; j++)
+	    if (tag_values[j]->get (obj->tag) == obj)
+	      tag.prop = data_cache_tag_props[j];
+	  tag.value = obj->value64;
+	  fwrite (&tag, sizeof (tag), 1, f);
+	}
+
+      static const char zeros[8] = { 0 };
+      for (long i = 0, sz = old->dsizes->size (); i < sz && ok; i++)
+	{
+	  DataDescriptor *dDscr = dataDscrs->fetch (i);
+	  long start = old->dsizes->fetch (i);
+	  if (dDscr == NULL || dDscr->getSize () <= start)
+	    continue;
+	  Vector<PropDescr*> *props = dDscr->getProps ();
+	  DataCacheTable tbl;
+	  memset (&tbl, 0, sizeof (tbl));
+	  tbl.id = dDscr->getId ();
+	  tbl.nrecs = dDscr->getSize () - start;
+	  for (long j = 0, nprops = props->size (); j < nprops; j++)
+	    {
+	      PropDescr *prop = props->fetch (j);
+	      Data *d = dDscr->getData (prop->propID);
+	      if (d == NULL || d->getSize () <= start)
+		continue;
+	      if (data_cache_vsize (prop->vtype) == 0)
+		ok = false;   // a pointer was set while reading
+	      tbl.ncols++;
+	    }
+	  fwrite (&tbl, sizeof (tbl), 1, f);
+	  for (long j = 0, nprops = props->size (); j < nprops && ok; j++)
+	    {
+	      PropDescr *prop = props->fetch (j);
+	      Data *d = dDscr->getData (prop->propID);
+	      if (d == NULL || d->getSize () <= start)
+		continue;
+	      DataCacheColumn col;
+	      memset (&col, 0, sizeof (col));
+	      col.prop = prop->propID;
+	      col.vtype = prop->vtype;
+	      col.nvals = d->getSize () - start;
+	      int vsize = data_cache_vsize (prop->vtype);
+	      col.size = col.nvals * vsize;
+	      if (prop->vtype == TYPE_STRING)
+		for (long k = start, end = d->getSize (); k < end; k++)
+		  {
+		    StringBuilder *sb = (StringBuilder *) d->fetchObject (k);
+		    col.size += sb ? sb->length () : 0;
+		  }
+	      fwrite (&col, sizeof (col), 1, f);
+	      DefaultMap<int64_t, Other*> *tags = NULL;
+	      for (int k = 0; k < DATA_CACHE_NTAG_PROPS; k++)
+		if (data_cache_tag_props[k] == prop->propID)
+		  tags = tag_values[k];
+	      for (long k = start, end = d->getSize (); k < end; k++)
+		{
+		  uint64_t v = d->fetchULong (k);
+		  if (prop->vtype == TYPE_STRING)
+		    {
+		      StringBuilder *sb = (StringBuilder *) d->fetchObject (k);
+		      v = sb ? sb->length () : 0;
+		    }
+		  else if (prop->vtype == TYPE_DOUBLE)
+		    {
+		      double dv = d->fetchDouble (k);
+		      memcpy (&v, &dv, sizeof (v));
+		    }
+		  else if (tags)
+		    {
+		      Other *obj = tags->get ((uint32_t) v);
+		      if (obj == NULL)
+			{
+			  ok = false;
+			  break;
+			}
+		      v = obj->value64;
+		    }
+		  if (vsize == 4)
+		    {
+		      uint32_t v32 = (uint32_t) v;
+		      fwrite (&v32, sizeof (v32), 1, f);
+		    }
+		  else
+		    fwrite (&v, sizeof (v), 1, f);
+		}
+	      if (prop->vtype == TYPE_STRING)
+		for (long k = start, end = d->getSize (); k < end; k++)
+		  {
+		    StringBuilder *sb = (StringBuilder *) d->fetchObject (k);
+		    if (sb && sb->length () > 0)
+		      {
+			char *str = sb->toString ();
+			fwrite (str, sb->length (), 1, f);
+			free (str);
+		      }
+		  }
+	      fwrite (zeros, (8 - col.size % 8) % 8, 1, f);
+	    }
+	}
+      if (ferror (f))
+	ok = false;
+      if (fclose (f) != 0)
+	ok = false;
+      char *path = data_cache_name (expt_name, fname);
+      if (!ok || rename (tmp_name, path) != 0)
+	unlink (tmp_name);
+      free (path);
+    }
+  free (tmp_name);
+  for (int i = 0; i < DATA_CACHE_NTAG_PROPS; i++)
+    delete tag_values[i];
+  delete new_tags;
+}
+
+/*
+ * The call stacks resolved for the records of a data descriptor are saved
+ * in <experiment>/cache/<data descriptor>.stacks, as references to the
+ * functions of the load objects, so that later sessions do not map every
+ * frame again:
+ *
+ *   StackCacheHeader
+ *   StackCacheLoadObject [nlobjs]
+ *   StackCacheFunction [nfuncs]
+ *   StackCacheInstr [ninstrs]
+ *   uint32_t [nframes]        for each stack, its size, then its
+ *                             instructions from the leaf
+ *   uint32_t [nrecs]          the stack of each record
+ *   char [strsize]            path names of the load objects
+ *
+ * The arrays of uint32_t are padded to 8 bytes.  The cache is ignored
+ * when the time stamps, frame info or leaf PCs of the records, the map or
+ * frame info files of the experiment, or one of the load objects have
+ * changed.  Only native stacks are saved: experiments with Java or OpenMP
+ * data, and records whose leaf PC is corrected from hardware counter
+ * data, are resolved in every session.
+ */
+#define STACK_CACHE_MAGIC   "GPNGSTK"
+#define STACK_CACHE_VERSION 1
+
+#define STACK_CACHE_UNKNOWN_FUNC  (-1)  // the <Unknown> function
+#define STACK_CACHE_SPECIAL_FUNC  (-2)  // -2 - N: special function N
+
+struct StackCacheFile
+{
+  uint64_t size;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+};
+
+struct StackCacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;    // DATA_CACHE_ORDER in the writer's byte order
+  uint64_t nrecs;
+  uint64_t hash;          // of the TSTAMP, FRINFO and LEAFPC values
+  StackCacheFile map;     // status of map.xml
+  StackCacheFile frinfo;  // status of data.frameinfo
+  uint32_t nlobjs;
+  uint32_t nfuncs;
+  uint32_t ninstrs;
+  uint32_t nstacks;
+  uint64_t nframes;
+  uint64_t strsize;
+};
+
+struct StackCacheLoadObject
+{
+  uint64_t name;          // offset of the path name in the strings
+  StackCacheFile st;
+};
+
+struct StackCacheFunction
+{
+  int32_t lobj;           // load object, or STACK_CACHE_*_FUNC
+  uint32_t reserved;
+  uint64_t img_offset;
+};
+
+struct StackCacheInstr
+{
+  uint32_t func;
+  int32_t flags;
+  uint64_t addr;
+};
+
+static void
+set_stack_cache_file (StackCacheFile *f, dbe_stat_t *sbuf)
+{
+  memset (f, 0, sizeof (*f));
+  if (sbuf == NULL)
+    return;
+  f->size = sbuf->st_size;
+  f->mtime_sec = sbuf->st_mtim.tv_sec;
+  f->mtime_nsec = sbuf->st_mtim.tv_nsec;
+}
+
+/* Set F to the status of the file FNAME of the experiment EXPT_NAME.  */
+static void
+set_stack_cache_file (StackCacheFile *f, const char *expt_name,
+		      const char *fname)
+{
+  char *path = dbe_sprintf (NTXT ("%s/%s"), expt_name, fname);
+  dbe_stat_t sbuf;
+  set_stack_cache_file (f, dbe_stat (path, &sbuf) == 0 ? &sbuf : NULL);
+  free (path);
+}
+
+/* Return a hash of the values the call stacks of DDSCR are resolved from.
+   Also extend *DURATION to the last time stamp after START.  */
+static uint64_t
+stack_cache_hash (DataDescriptor *dDscr, hrtime_t start, hrtime_t *duration)
+{
+  static const int props[] = { PROP_TSTAMP, PROP_FRINFO, PROP_LEAFPC };
+  uint64_t hash = 14695981039346656037ULL;  // FNV-1a, on 8 byte words
+  uint64_t vals[DATA_BLOCK_SIZE];
+  long size = dDscr->getSize ();
+  for (int p = 0; p < (int) (sizeof (props) / sizeof (props[0])); p++)
+    {
+      Data *d = dDscr->getData (props[p]);
+      for (long i = 0; i < size; i += DATA_BLOCK_SIZE)
+	{
+	  long n = size - i < DATA_BLOCK_SIZE ? size - i : DATA_BLOCK_SIZE;
+	  if (d == NULL || !d->fetchValues (i, n, vals))
+	    memset (vals, 0, n * sizeof (vals[0]));
+	  for (long k = 0; k < n; k++)
+	    {
+	      hash = (hash ^ vals[k]) * 1099511628211ULL;
+	      hrtime_t ts = (hrtime_t) vals[k] - start;
+	      if (props[p] == PROP_TSTAMP && *duration < ts)
+		*duration = ts;
+	    }
+	}
+    }
+  return hash;
+}
+
+static char *
+stack_cache_name (const char *expt_name, DataDescriptor *dDscr)
+{
+  return dbe_sprintf (NTXT ("%s/%s/%s.stacks"), expt_name, SP_CACHE_DIR,
+		      dDscr->getName ());
+}
+
+/* Return the first load object of LOBJS named PATH.  */
+static LoadObject *
+find_stack_cache_lobj (Vector<LoadObject*> *lobjs, const char *path)
+{
+  for (long i = 0, sz = lobjs->size (); i < sz; i++)
+    {
+      LoadObject *lo = lobjs->fetch (i);
+      if (strcmp (lo->get_pathname (), path) == 0)
+	return lo;
+    }
+  return NULL;
+}
+
+/* Set the call stacks of the records of DDSCR from the cache at BASE of
+   SIZE bytes.  Return false if it does not match the experiment.  */
+bool
+Experiment::apply_stack_cache (char *base, int64_t size,
+			       DataDescriptor *dDscr)
+{
+  StackCacheHeader *hdr = (StackCacheHeader *) base;
+  long nrecs = dDscr->getSize ();
+  if (memcmp (hdr->magic, STACK_CACHE_MAGIC, sizeof (hdr->magic)) != 0
+      || hdr->version != STACK_CACHE_VERSION
+      || hdr->byte_order != DATA_CACHE_ORDER
+      || hdr->nrecs != (uint64_t) nrecs
+      || hdr->nframes > (uint64_t) size)
+    return false;
+  StackCacheFile st;
+  set_stack_cache_file (&st, expt_name, SP_MAP_FILE);
+  if (memcmp (&st, &hdr->map, sizeof (st)) != 0)
+    return false;
+  set_stack_cache_file (&st, expt_name, "data." SP_FRINFO_FILE);
+  if (memcmp (&st, &hdr->frinfo, sizeof (st)) != 0)
+    return false;
+
+  uint64_t pos = sizeof (StackCacheHeader);
+  StackCacheLoadObject *clobjs = (StackCacheLoadObject *) (base + pos);
+  pos += hdr->nlobjs * sizeof (StackCacheLoadObject);
+  StackCacheFunction *cfuncs = (StackCacheFunction *) (base + pos);
+  pos += hdr->nfuncs * sizeof (StackCacheFunction);
+  StackCacheInstr *cinstrs = (StackCacheInstr *) (base + pos);
+  pos += hdr->ninstrs * sizeof (StackCacheInstr);
+  uint32_t *frames = (uint32_t *) (base + pos);
+  pos += (hdr->nframes * sizeof (uint32_t) + 7) & ~7;
+  uint32_t *recs = (uint32_t *) (base + pos);
+  pos += (nrecs * sizeof (uint32_t) + 7) & ~7;
+  char *strs = base + pos;
+  if (pos > (uint64_t) size || hdr->strsize != (uint64_t) size - pos)
+    return false;
+
+  // Check the stacks
+  uint64_t k = 0;
+  for (uint32_t i = 0; i < hdr->nstacks; i++)
+    {
+      if (k >= hdr->nframes || frames[k] > hdr->nframes - k - 1)
+	return false;
+      for (uint32_t j = 0, n = frames[k++]; j < n; j++)
+	if (frames[k++] >= hdr->ninstrs)
+	  return false;
+    }
+  if (k != hdr->nframes)
+    return false;
+  for (long i = 0; i < nrecs; i++)
+    if (recs[i] >= hdr->nstacks)
+      return false;
+  const hrtime_t start = getStartTime ();
+  hrtime_t duration = getLastEvent () == ZERO_TIME ? 0
+	  : getLastEvent () - start;
+  if (stack_cache_hash (dDscr, start, &duration) != hdr->hash)
+    return false;
+
+  // Find the load objects, functions and instructions
+  Vector<LoadObject*> lobjs (hdr->nlobjs);
+  for (uint32_t i = 0; i < hdr->nlobjs; i++)
+    {
+      uint64_t name = clobjs[i].name;
+      if (name >= hdr->strsize
+	  || memchr (strs + name, 0, hdr->strsize - name) == NULL)
+	return false;
+      LoadObject *lo = find_stack_cache_lobj (loadObjs, strs + name);
+      if (lo == NULL || lo->dbeFile == NULL)
+	return false;
+      set_stack_cache_file (&st, lo->dbeFile->get_stat ());
+      if (memcmp (&st, &clobjs[i].st, sizeof (st)) != 0)
+	return false;
+      lobjs.append (lo);
+    }
+  Vector<Function*> funcs (hdr->nfuncs);
+  for (uint32_t i = 0; i < hdr->nfuncs; i++)
+    {
+      int32_t lobj = cfuncs[i].lobj;
+      int64_t special = STACK_CACHE_SPECIAL_FUNC - (int64_t) lobj;
+      Function *func = NULL;
+      if (lobj == STACK_CACHE_UNKNOWN_FUNC)
+	func = dbeSession->get_Unknown_Function ();
+      else if (special >= 0 && special < DbeSession::LastSpecialFunction)
+	func = dbeSession->getSpecialFunction ((DbeSession::SpecialFunction)
+					       special);
+      else if (lobj >= 0 && (uint32_t) lobj < hdr->nlobjs)
+	{
+	  LoadObject *lo = lobjs.fetch (lobj);
+	  lo->sync_read_stabs ();
+	  func = lo->find_function (cfuncs[i].img_offset);
+	}
+      if (func == NULL)
+	return false;
+      funcs.append (func);
+    }
+  Vector<DbeInstr*> instrs (hdr->ninstrs);
+  for (uint32_t i = 0; i < hdr->ninstrs; i++)
+    {
+      if (cinstrs[i].func >= hdr->nfuncs)
+	return false;
+      Function *func = funcs.fetch (cinstrs[i].func);
+      DbeInstr *instr = func->find_dbeinstr (cinstrs[i].flags,
+					     cinstrs[i].addr);
+      if (!func->isUsed)
+	{
+	  func->isUsed = true;
+	  func->module->isUsed = true;
+	  func->module->loadobject->isUsed = true;
+	}
+      instrs.append (instr);
+    }
+
+  // Add the stacks
+  Vector<void*> nodes (hdr->nstacks);
+  Vector<Histable*> objs;
+  k = 0;
+  for (uint32_t i = 0; i < hdr->nstacks; i++)
+    {
+      objs.reset ();
+      for (uint32_t j = 0, n = frames[k++]; j < n; j++)
+	objs.append (instrs.fetch (frames[k++]));
+      nodes.append (cstack->add_stack (&objs));
+    }
+  for (long i = 0; i < nrecs; i++)
+    {
+      void *node = nodes.fetch (recs[i]);
+      dDscr->setObjValue (PROP_MSTACK, i, node);
+      dDscr->setObjValue (PROP_XSTACK, i, node);
+      dDscr->setObjValue (PROP_USTACK, i, node);
+    }
+  update_last_event (start + duration);
+  return true;
+}
+
+/* Set the call stacks of the records of DDSCR from the cache.  Return
+   false if there is no valid cache for them.  */
+bool
+Experiment::read_stack_cache (DataDescriptor *dDscr)
+{
+  char *path = stack_cache_name (expt_name, dDscr);
+  int fd = open64 (path, O_RDONLY);
+  free (path);
+  if (fd == -1)
+    return false;
+  dbe_stat_t cbuf;
+  bool ok = false;
+  if (fstat64 (fd, &cbuf) == 0
+      && cbuf.st_size >= (off64_t) sizeof (StackCacheHeader))
+    {
+      int64_t size = cbuf.st_size;
+      void *base = mmap (0, (size_t) size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base != MAP_FAILED)
+	{
+	  ok = apply_stack_cache ((char *) base, size, dDscr);
+	  munmap (base, (size_t) size);
+	}
+    }
+  close (fd);
+  return ok;
+}
+
+/* Return the number of the function FUNC in the stack cache, adding it
+   and its load object to FUNCS and LOBJS.  Return -1 if it can not be
+   found again from the cache.  */
+static long
+stack_cache_func (Function *func, Vector<LoadObject*> *expt_lobjs,
+		  Vector<Function*> *funcs, Vector<LoadObject*> *lobjs,
+		  Vector<StackCacheFunction> *cfuncs,
+		  DefaultMap<void*, long> *ids)
+{
+  long id = ids->get (func);
+  if (id != 0)
+    return id - 1;
+  StackCacheFunction cfunc;
+  memset (&cfunc, 0, sizeof (cfunc));
+  if (func == dbeSession->get_Unknown_Function ())
+    cfunc.lobj = STACK_CACHE_UNKNOWN_FUNC;
+  else
+    {
+      for (int i = 0; i < DbeSession::LastSpecialFunction; i++)
+	{
+	  DbeSession::SpecialFunction kind = (DbeSession::SpecialFunction) i;
+	  if (func == dbeSession->getSpecialFunction (kind))
+	    cfunc.lobj = STACK_CACHE_SPECIAL_FUNC - i;
+	}
+      if (cfunc.lobj == 0)
+	{
+	  LoadObject *lo = func->module ? func->module->loadobject : NULL;
+	  if (lo == NULL || lo->dbeFile == NULL
+	      || lo->dbeFile->get_stat () == NULL
+	      || find_stack_cache_lobj (expt_lobjs, lo->get_pathname ()) != lo
+	      || lo->find_function (func->img_offset) != func)
+	    return -1;
+	  long lid = ids->get (lo);
+	  if (lid == 0)
+	    {
+	      lobjs->append (lo);
+	      lid = lobjs->size ();
+	      ids->put (lo, lid);
+	    }
+	  cfunc.lobj = (int32_t) (lid - 1);
+	  cfunc.img_offset = func->img_offset;
+	}
+    }
+  funcs->append (func);
+  cfuncs->append (cfunc);
+  ids->put (func, funcs->size ());
+  return funcs->size () - 1;
+}
+
+/* Save the call stacks resolved for the records of DDSCR.  */
+void
+Experiment::write_stack_cache (DataDescriptor *dDscr)
+{
+  long nrecs = dDscr->getSize ();
+  if (nrecs == 0 || nrecs > (long) UINT32_MAX)
+    return;
+  for (long i = 0; i < nrecs; i++)
+    if (dDscr->getLongValue (PROP_VIRTPC, i) != 0)
+      return;
+
+  // Number the load objects, functions, instructions and stacks
+  DefaultMap<void*, long> *ids = new DefaultMap<void*, long>;
+  Vector<LoadObject*> *lobjs = new Vector<LoadObject*>;
+  Vector<Function*> *funcs = new Vector<Function*>;
+  Vector<StackCacheFunction> *cfuncs = new Vector<StackCacheFunction>;
+  Vector<StackCacheInstr> *cinstrs = new Vector<StackCacheInstr>;
+  Vector<uint32_t> *frames = new Vector<uint32_t>;
+  Vector<uint32_t> *recs = new Vector<uint32_t>;
+  uint32_t nstacks = 0;
+  bool ok = true;
+  for (long i = 0; i < nrecs && ok; i++)
+    {
+      void *node = dDscr->getObjValue (PROP_MSTACK, i);
+      if (node == NULL || dDscr->getObjValue (PROP_XSTACK, i) != node
+	  || dDscr->getObjValue (PROP_USTACK, i) != node)
+	{
+	  ok = false;
+	  break;
+	}
+      long id = ids->get (node);
+      if (id == 0)
+	{
+	  Vector<Histable*> *pcs = CallStack::getStackPCs (node);
+	  frames->append ((uint32_t) pcs->size ());
+	  for (long j = 0, sz = pcs->size (); j < sz && ok; j++)
+	    {
+	      Histable *obj = pcs->fetch (j);
+	      long k = ok && obj->get_type () == Histable::INSTR
+		      ? ids->get (obj) : -1;
+	      if (k == 0)
+		{
+		  DbeInstr *instr = (DbeInstr *) obj;
+		  Function *func = instr->func;
+		  long f = stack_cache_func (func, loadObjs, funcs, lobjs,
+					     cfuncs, ids);
+		  if (f < 0
+		      || func->find_dbeinstr (instr->flags, instr->addr) != instr)
+		    ok = false;
+		  StackCacheInstr cinstr;
+		  memset (&cinstr, 0, sizeof (cinstr));
+		  cinstr.func = (uint32_t) f;
+		  cinstr.flags = instr->flags;
+		  cinstr.addr = instr->addr;
+		  cinstrs->append (cinstr);
+		  k = cinstrs->size ();
+		  ids->put (obj, k);
+		}
+	      else if (k < 0)
+		ok = false;
+	      frames->append ((uint32_t) (k - 1));
+	    }
+	  delete pcs;
+	  id = ++nstacks;
+	  ids->put (node, id);
+	}
+      recs->append ((uint32_t) (id - 1));
+    }
+
+  char *dir = dbe_sprintf (NTXT ("%s/%s"), expt_name, SP_CACHE_DIR);
+  mkdir (dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+  char *path = stack_cache_name (expt_name, dDscr);
+  char *tmp_name = dbe_sprintf (NTXT ("%s_%llx"), path,
+				(unsigned long long) gethrtime ());
+  free (dir);
+  FILE *f = ok ? fopen (tmp_name, NTXT ("w")) : NULL;
+  if (f != NULL)
+    {
+      static const char zeros[8] = { 0 };
+      StackCacheHeader hdr;
+      memset (&hdr, 0, sizeof (hdr));
+      memcpy (hdr.magic, STACK_CACHE_MAGIC, sizeof (hdr.magic));
+      hdr.version = STACK_CACHE_VERSION;
+      hdr.byte_order = DATA_CACHE_ORDER;
+      hdr.nrecs = nrecs;
+      hrtime_t duration = 0;
+      hdr.hash = stack_cache_hash (dDscr, getStartTime (), &duration);
+      set_stack_cache_file (&hdr.map, expt_name, SP_MAP_FILE);
+      set_stack_cache_file (&hdr.frinfo, expt_name, "data." SP_FRINFO_FILE);
+      hdr.nlobjs = lobjs->size ();
+      hdr.nfuncs = cfuncs->size ();
+      hdr.ninstrs = cinstrs->size ();
+      hdr.nstacks = nstacks;
+      hdr.nframes = frames->size ();
+      for (long i = 0, sz = lobjs->size (); i < sz; i++)
+	hdr.strsize += strlen (lobjs->fetch (i)->get_pathname ()) + 1;
+      fwrite (&hdr, sizeof (hdr), 1, f);
+      uint64_t name = 0;
+      for (long i = 0, sz = lobjs->size (); i < sz; i++)
+	{
+	  LoadObject *lo = lobjs->fetch (i);
+	  StackCacheLoadObject clobj;
+	  clobj.name = name;
+	  set_stack_cache_file (&clobj.st, lo->dbeFile->get_stat ());
+	  fwrite (&clobj, sizeof (clobj), 1, f);
+	  name += strlen (lo->get_pathname ()) + 1;
+	}
+      for (long i = 0, sz = cfuncs->size (); i < sz; i++)
+	{
+	  StackCacheFunction cfunc = cfuncs->fetch (i);
+	  fwrite (&cfunc, sizeof (cfunc), 1, f);
+	}
+      for (long i = 0, sz = cinstrs->size (); i < sz; i++)
+	{
+	  StackCacheInstr cinstr = cinstrs->fetch (i);
+	  fwrite (&cinstr, sizeof (cinstr), 1, f);
+	}
+      Vector<uint32_t> *arrays[] = { frames, recs };
+      for (int i = 0; i < 2; i++)
+	{
+	  for (long j = 0, sz = arrays[i]->size (); j < sz; j++)
+	    {
+	      uint32_t v = arrays[i]->fetch (j);
+	      fwrite (&v, sizeof (v), 1, f);
+	    }
+	  fwrite (zeros, (arrays[i]->size () % 2) * sizeof (uint32_t), 1, f);
+	}
+      for (long i = 0, sz = lobjs->size (); i < sz; i++)
+	{
+	  char *pathname = lobjs->fetch (i)->get_pathname ();
+	  fwrite (pathname, strlen (pathname) + 1, 1, f);
+	}
+      if (ferror (f))
+	ok = false;
+      if (fclose (f) != 0)
+	ok = false;
+      if (!ok || rename (tmp_name, path) != 0)
+	unlink (tmp_name);
+    }
+  free (tmp_name);
+  free (path);
+  delete ids;
+  delete lobjs;
+  delete funcs;
+  delete cfuncs;
+  delete cinstrs;
+  delete frames;
+  delete recs;
+}
+
+#define PROG_BYTE 102400 // update progress bar every PROG_BYTE bytes
+
+// Data files of at least two chunks are read by several threads.
+// DATA_CHUNK_SIZE is a multiple of the collector's buffer block size,
+// so a chunk almost always begins with a packet.
+#define DATA_CHUNK_SIZE     (8 * 1024 * 1024)
+#define DATA_CHUNKS_BATCH   16  // chunks parsed before their records are merged
+
+/* Statistics of reading one data file, or of resolving the call stacks of
+   one data descriptor, printed by the dloadstats command.  */
+struct Experiment::DataFileStats
+{
+  DataFileStats (const char *_fname)
+  {
+    fname = dbe_strdup (_fname);
+    fsize = 0;
+    records = 0;
+    chunks = 0;
+    threads = 0;
+    read_time = 0;
+    merge_time = 0;
+    cached = false;
+  }
+
+  ~DataFileStats ()
+  {
+    free (fname);
+  }
+
+  char *fname;
+  int64_t fsize;
+  long records;         // records added to the data descriptors
+  int chunks;           // chunks read in parallel, 0 if read serially
+  int threads;          // threads reading the chunks
+  hrtime_t read_time;   // total time to read the file
+  hrtime_t merge_time;  // time to merge chunk records into data descriptors
+  bool cached;          // records are loaded from the experiment cache
+};
+
+/* A part of a data file parsed by a worker thread.  The packets are
+   decoded into chunk-local vectors; read_data_chunks adds them to the
+   data descriptors in file order, since mapping thread, LWP and CPU ids
+   depends on the order of the records.  */
+class Experiment::DataChunk
+{
+public:
+  DataChunk (Experiment *_exp, const char *_path, int64_t _offset,
+	     int64_t _limit)
+  {
+    exp = _exp;
+    path = _path;
+    offset = _offset;
+    limit = _limit;
+    end = _offset;
+    invalid = 0;
+    need_serial = false;
+    merged = false;
+    dDscrs = new Vector<DataDescriptor*>;
+    pDscrs = new Vector<PacketDescriptor*>;
+    args = new Vector<int>;
+    first = new Vector<long>;
+    values = new Vector<uint64_t>;
+  }
+
+  ~DataChunk ()
+  {
+    if (!merged)
+      // The strings have not been passed to the data descriptors
+      for (long i = 0, sz = pDscrs->size (); i < sz; i++)
+	{
+	  Vector<FieldDescr*> *fields = pDscrs->fetch (i)->getFields ();
+	  for (long j = 0, nf = fields->size (); j < nf; j++)
+	    if (fields->fetch (j)->vtype == TYPE_STRING)
+	      delete (StringBuilder *) values->fetch (first->fetch (i) + j);
+	}
+    delete dDscrs;
+    delete pDscrs;
+    delete args;
+    delete first;
+    delete values;
+  }
+
+  void
+  add (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
+       DataDescriptor *dDscr, int arg, uint64_t pktsz)
+  {
+    int sz = pDscr->getFields ()->size ();
+    uint64_t *vals = (uint64_t *) alloca (sz * sizeof (uint64_t));
+    exp->decodePacket (dwin, ptr, pDscr, pktsz, vals);
+    dDscrs->append (dDscr);
+    pDscrs->append (pDscr);
+    args->append (arg);
+    first->append (values->size ());
+    for (int i = 0; i < sz; i++)
+      values->append (vals[i]);
+  }
+
+  Experiment *exp;
+  const char *path;
+  int64_t offset;       // offset of the first packet
+  int64_t limit;        // packets starting at or after limit are not read
+  int64_t end;          // offset of the first packet not read
+  int invalid;          // number of invalid packets
+  bool need_serial;     // stopped at a packet which must be read serially
+  bool merged;          // records are added to the data descriptors
+  Vector<DataDescriptor*> *dDscrs;
+  Vector<PacketDescriptor*> *pDscrs;
+  Vector<int> *args;
+  Vector<long> *first;  // index of the first value of each record
+  Vector<uint64_t> *values;
+};
+
+int
+Experiment::read_data_chunk_thr (void *arg)
+{
+  DataChunk *chunk = (DataChunk *) arg;
+  chunk->exp->read_data_chunk (chunk);
+  return 0;
+}
+
+/* Parse the packets of CHUNK.  This runs on a worker thread, so it must
+   not change the experiment.  Frame and uid packets update the shared
+   stack tables; stop at them and let the caller read the rest of the
+   file serially.  */
+void
+Experiment::read_data_chunk (DataChunk *chunk)
+{
+  Data_window *dwin = new Data_window ((char *) chunk->path);
+  if (dwin->not_opened ())
+    {
+      chunk->need_serial = true;
+      delete dwin;
+      return;
+    }
+  dwin->need_swap_endian = need_swap_endian;
+
+  Data_window::Span span;
+  span.offset = chunk->offset;
+  span.length = dwin->get_fsize () - chunk->offset;
+  while (span.offset < chunk->limit)
     {
-      FieldDescr *field = fields->fetch (i);
-      v = (Value*) (ptr + field->offset);
-      if (field->propID == arg)
-	{
-	  dDscr->setValue (PROP_NTICK, recn, dwin->decode (v->val32));
-	  dDscr->setValue (PROP_MSTATE, recn, (uint32_t) (field->propID - PROP_UCPU));
-	}
-      if (field->propID == PROP_THRID || field->propID == PROP_LWPID
-	  || field->propID == PROP_CPUID)
+      uint64_t size;
+      Common_packet *rcp = (Common_packet *) bindPacket (dwin, &span, &size,
+							 &chunk->invalid);
+      if (size == 0)
+	break;
+      if (rcp != NULL)
 	{
-	  uint64_t tmp64 = 0;
-	  switch (field->vtype)
+	  uint16_t v16 = (uint16_t) rcp->type;
+	  uint32_t rcptype = dwin->decode (v16);
+	  if (rcptype == FRAME_PCKT || rcptype == UID_PCKT)
 	    {
-	    case TYPE_INT32:
-	    case TYPE_UINT32:
-	      tmp64 = dwin->decode (v->val32);
-	      break;
-	    case TYPE_INT64:
-	    case TYPE_UINT64:
-	      tmp64 = dwin->decode (v->val64);
-	      break;
-	    case TYPE_STRING:
-	    case TYPE_DOUBLE:
-	    case TYPE_OBJ:
-	    case TYPE_DATE:
-	    case TYPE_BOOL:
-	    case TYPE_ENUM:
-	    case TYPE_LAST:
-	    case TYPE_NONE:
+	      chunk->need_serial = true;
 	      break;
 	    }
-	  uint32_t tag = mapTagValue ((Prop_type) field->propID, tmp64);
-	  dDscr->setValue (field->propID, recn, tag);
+	  PacketDescriptor *pcktDescr = getPacketDescriptor (rcptype);
+	  DataDescriptor *dataDescr = pcktDescr ?
+		  pcktDescr->getDataDescriptor () : NULL;
+	  if (rcptype == EMPTY_PCKT || dataDescr == NULL)
+	    ;
+	  else if (rcptype == PROF_PCKT)
+	    {
+	      // See readPacket
+	      int numstates = get_params ()->lms_magic_id;
+	      if (numstates > LMS_NUM_SOLARIS_MSTATES)
+		numstates = LMS_NUM_SOLARIS_MSTATES;
+	      for (int i = 0; i < numstates; i++)
+		if (check_mstate ((char*) rcp, pcktDescr, PROP_UCPU + i))
+		  chunk->add (dwin, (char*) rcp, pcktDescr, dataDescr,
+			      PROP_UCPU + i, size);
+	    }
+	  else
+	    chunk->add (dwin, (char*) rcp, pcktDescr, dataDescr, 0, size);
 	}
-      else
+      span.length -= size;
+      span.offset += size;
+    }
+  // A packet which can't be bound is truncated, or the file is damaged.
+  // Let the serial reader stop there.
+  if (span.offset < chunk->limit)
+    chunk->need_serial = true;
+  chunk->end = span.offset;
+  delete dwin;
+}
+
+/* Read the data file PATH of FSIZE bytes in chunks on a thread pool and
+   add the records to the data descriptors.  Return the offset at which
+   the file must be read serially, or FSIZE.  */
+int64_t
+Experiment::read_data_chunks (const char *path, int64_t fsize, int *nchunks,
+			      int *nthreads, hrtime_t *merge_time,
+			      const char *progress_bar_msg)
+{
+  int64_t chunk_size = DATA_CHUNK_SIZE;
+  int64_t offset = 0;
+  bool serial = false;
+  *nchunks = 0;
+  *nthreads = 0;
+  *merge_time = 0;
+  Vector<DataChunk*> *chunks = new Vector<DataChunk*>(DATA_CHUNKS_BATCH);
+  while (offset < fsize && !serial)
+    {
+      DbeThreadPool *threadPool = new DbeThreadPool (-1);
+      if (*nthreads < threadPool->get_max_threads () + 1)
+	*nthreads = threadPool->get_max_threads () + 1;
+      int64_t start_offset = offset;
+      int64_t start = offset;
+      for (int i = 0; i < DATA_CHUNKS_BATCH && start < fsize; i++)
+	{
+	  int64_t limit = start + chunk_size;
+	  if (limit > fsize - chunk_size / 2)
+	    limit = fsize;
+	  DataChunk *chunk = new DataChunk (this, path, start, limit);
+	  chunks->append (chunk);
+	  threadPool->put_queue (new DbeQueue (read_data_chunk_thr, chunk));
+	  start = limit;
+	}
+      threadPool->wait_queues ();
+      delete threadPool;
+
+      hrtime_t merge_start = gethrtime ();
+      for (long i = 0, sz = chunks->size (); i < sz; i++)
+	{
+	  DataChunk *chunk = chunks->fetch (i);
+	  if (serial)
+	    {
+	      delete chunk;
+	      continue;
+	    }
+	  if (chunk->offset != offset)
+	    {
+	      // The previous chunk ended past this chunk's start: the last
+	      // packet crossed the boundary.  Parse from the right place.
+	      DataChunk *c = new DataChunk (this, path, offset,
+					    offset < chunk->limit ?
+					    chunk->limit : offset);
+	      delete chunk;
+	      chunk = c;
+	      read_data_chunk (chunk);
+	    }
+	  uint64_t *vals = NULL;
+	  int vals_sz = 0;
+	  for (long j = 0, nrec = chunk->dDscrs->size (); j < nrec; j++)
+	    {
+	      PacketDescriptor *pDscr = chunk->pDscrs->fetch (j);
+	      int nf = pDscr->getFields ()->size ();
+	      if (nf > vals_sz)
+		{
+		  vals_sz = nf;
+		  vals = (uint64_t *) realloc (vals, vals_sz * sizeof (uint64_t));
+		}
+	      long first = chunk->first->fetch (j);
+	      for (int k = 0; k < nf; k++)
+		vals[k] = chunk->values->fetch (first + k);
+	      storePacket (chunk->dDscrs->fetch (j), pDscr,
+			   chunk->args->fetch (j), vals);
+	    }
+	  free (vals);
+	  chunk->merged = true;
+	  invalid_packet += chunk->invalid;
+	  offset = chunk->end;
+	  serial = chunk->need_serial;
+	  (*nchunks)++;
+	  delete chunk;
+	}
+      chunks->reset ();
+      if (offset == start_offset)
+	serial = true;  // no progress, don't loop forever
+      *merge_time += gethrtime () - merge_start;
+      theApplication->set_progress ((int) (100 * offset / fsize),
+				    progress_bar_msg);
+    }
+  delete chunks;
+  return offset;
+}
+
+/* Read the packets of DWIN serially, from OFFSET to the end.  Return the
+   offset of the first byte that was not read.  */
+int64_t
+Experiment::read_data_span (Data_window *dwin, int64_t offset,
+			    const char *progress_bar_msg)
+{
+  Data_window::Span span;
+  off64_t total_len, remain_len;
+  int progress_bar_percent = -1;
+
+  span.offset = offset;
+  span.length = dwin->get_fsize () - offset;
+  total_len = dwin->get_fsize ();
+  remain_len = span.length;
+  for (;;)
+    {
+      uint64_t pcktsz = readPacket (dwin, &span);
+      if (pcktsz == 0)
+	break;
+      // Update progress bar
+      if ((span.length <= remain_len) && (remain_len > 0))
 	{
-	  switch (field->vtype)
+	  int percent = (int) (100 * (total_len - remain_len) / total_len);
+	  if (percent > progress_bar_percent)
 	    {
-	    case TYPE_INT32:
-	    case TYPE_UINT32:
-	      dDscr->setValue (field->propID, recn, dwin->decode (v->val32));
-	      break;
-	    case TYPE_INT64:
-	    case TYPE_UINT64:
-	      dDscr->setValue (field->propID, recn, dwin->decode (v->val64));
-	      break;
-	    case TYPE_STRING:
-	      {
-		int len = (int) (pktsz - field->offset);
-		if ((len > 0) && (ptr[field->offset] != 0))
-		  {
-		    StringBuilder *sb = new StringBuilder ();
-		    sb->append (ptr + field->offset, 0, len);
-		    dDscr->setObjValue (field->propID, recn, sb);
-		  }
-		break;
-	      }
-	      // ignoring the following cases (why?)
-	    case TYPE_DOUBLE:
-	    case TYPE_OBJ:
-	    case TYPE_DATE:
-	    case TYPE_BOOL:
-	    case TYPE_ENUM:
-	    case TYPE_LAST:
-	    case TYPE_NONE:
-	      break;
+	      progress_bar_percent += 10;
+	      theApplication->set_progress (percent, progress_bar_msg);
 	    }
+	  remain_len -= PROG_BYTE;
 	}
+      span.length -= pcktsz;
+      span.offset += pcktsz;
     }
+  return span.offset;
 }
 
-#define PROG_BYTE 102400 // update progress bar every PROG_BYTE bytes
+long
+Experiment::count_records ()
+{
+  long cnt = 0;
+  for (long i = 0, sz = VecSize (dataDscrs); i < sz; i++)
+    {
+      DataDescriptor *dDscr = dataDscrs->fetch (i);
+      if (dDscr)
+	cnt += dDscr->getSize ();
+    }
+  return cnt;
+}
+
+/* A data file read while the experiment was still being written.
+   REGIONS holds the [start, end) offsets of the parts that had no packets
+   yet; refresh_data reads them again, along with the data written past
+   OFFSET.  */
+class Experiment::LiveDataFile
+{
+public:
+  LiveDataFile (const char *_fname)
+  {
+    fname = dbe_strdup (_fname);
+    offset = 0;
+    regions = new Vector<int64_t>;
+  }
+
+  ~LiveDataFile ()
+  {
+    free (fname);
+    delete regions;
+  }
+
+  char *fname;
+  int64_t offset;               // end of the data read so far
+  Vector<int64_t> *regions;
+};
+
+/* Return true if the data file FNAME is still being written and its new
+   packets can be added later by refresh_data.  Only the data whose
+   records need no processing other than resolve_frame_info are
+   refreshed.  */
+bool
+Experiment::is_live_file (const char *fname)
+{
+  if (status != INCOMPLETE)
+    return false;
+  return strcmp (fname, SP_PROFILE_FILE) == 0
+	  || strcmp (fname, SP_HWCNTR_FILE) == 0
+	  || strcmp (fname, SP_RACETRACE_FILE) == 0
+	  || strcmp (fname, SP_DEADLOCK_FILE) == 0
+	  || strcmp (fname, "data." SP_FRINFO_FILE) == 0;
+}
 
 void
 Experiment::read_data_file (const char *fname, const char *msg)
 {
-  Data_window::Span span;
-  off64_t total_len, remain_len;
   char *progress_bar_msg;
-  int progress_bar_percent = -1;
+
+  // The new packets of a file read before are added by refresh_data
+  for (long i = 0, sz = VecSize (live_files); i < sz; i++)
+    if (strcmp (live_files->fetch (i)->fname, fname) == 0)
+      return;
 
   char *data_file_name = dbe_sprintf (NTXT ("%s/%s"), expt_name, fname);
   Data_window *dwin = new Data_window (data_file_name);
   // Here we can call stat(data_file_name) to get file size,
   // and call a function to reallocate vectors for clock profiling data
-  free (data_file_name);
   if (dwin->not_opened ())
     {
+      free (data_file_name);
       delete dwin;
       return;
     }
   dwin->need_swap_endian = need_swap_endian;
 
-  span.offset = 0;
-  span.length = dwin->get_fsize ();
-  total_len = remain_len = span.length;
+  DataFileStats *stats = new DataFileStats (fname);
+  load_stats->append (stats);
+  hrtime_t start_time = gethrtime ();
+  long records = count_records ();
+  int64_t fsize = dwin->get_fsize ();
+  int64_t offset = 0;
+  stats->fsize = fsize;
   progress_bar_msg = dbe_sprintf (NTXT ("%s %s"), NTXT ("  "), msg);
   invalid_packet = 0;
-  for (;;)
+
+  // A file that is still being written is read serially, so that the
+  // parts without data are recorded for refresh_data.
+  LiveDataFile *lfile = NULL;
+  if (is_live_file (fname))
     {
-      uint64_t pcktsz = readPacket (dwin, &span);
-      if (pcktsz == 0)
-	break;
-      // Update progress bar
-      if ((span.length <= remain_len) && (remain_len > 0))
+      lfile = new LiveDataFile (fname);
+      live_files->append (lfile);
+      live_regions = lfile->regions;
+    }
+
+  DataCacheState *cache = NULL;
+  dbe_stat_t sbuf;
+  if (data_cache_enabled () && lfile == NULL
+      && dbe_stat (data_file_name, &sbuf) == 0)
+    {
+      if (read_data_cache (fname, &sbuf))
 	{
-	  int percent = (int) (100 * (total_len - remain_len) / total_len);
-	  if (percent > progress_bar_percent)
-	    {
-	      progress_bar_percent += 10;
-	      theApplication->set_progress (percent, progress_bar_msg);
-	    }
-	  remain_len -= PROG_BYTE;
+	  stats->cached = true;
+	  offset = fsize;
 	}
-      span.length -= pcktsz;
-      span.offset += pcktsz;
+      else
+	cache = new DataCacheState (this);
+    }
+  if (fsize >= 2 * DATA_CHUNK_SIZE && offset < fsize && lfile == NULL)
+    {
+      theApplication->set_progress (0, progress_bar_msg);
+      offset = read_data_chunks (data_file_name, fsize, &stats->chunks,
+				 &stats->threads, &stats->merge_time,
+				 progress_bar_msg);
+    }
+  if (offset < fsize)
+    offset = read_data_span (dwin, offset, progress_bar_msg);
+  if (lfile)
+    {
+      lfile->offset = offset;
+      live_regions = NULL;
     }
+  free (data_file_name);
   delete dwin;
+  if (cache)
+    {
+      write_data_cache (fname, &sbuf, cache);
+      delete cache;
+    }
+  stats->records = count_records () - records;
+  stats->read_time = gethrtime () - start_time;
 
   if (invalid_packet)
     {
@@ -4835,6 +6287,118 @@ Experiment::read_data_file (const char *fname, const char *msg)
   free (progress_bar_msg);
 }
 
+/* Read the packets written to DWIN since LFILE was read last: those in
+   the regions that had no data, and those past the old end of the data.  */
+void
+Experiment::read_live_file (Data_window *dwin, LiveDataFile *lfile)
+{
+  Vector<int64_t> *old = lfile->regions;
+  int64_t fsize = dwin->get_fsize ();
+  if (fsize > lfile->offset)
+    {
+      old->append (lfile->offset);
+      old->append (fsize);
+    }
+  lfile->regions = new Vector<int64_t>;
+  live_regions = lfile->regions;
+  for (long i = 0, sz = old->size (); i < sz; i += 2)
+    {
+      // Adjacent regions are merged, a packet may cross their boundary.
+      int64_t start = old->fetch (i);
+      int64_t end = old->fetch (i + 1);
+      while (i + 2 < sz && old->fetch (i + 2) == end)
+	{
+	  end = old->fetch (i + 3);
+	  i += 2;
+	}
+
+      Data_window::Span span;
+      span.offset = start;
+      span.length = end - start;
+      while (span.length > 0)
+	{
+	  uint64_t pcktsz = readPacket (dwin, &span);
+	  if (pcktsz == 0)
+	    {
+	      // The rest of the region is not complete yet
+	      live_regions->append (span.offset);
+	      live_regions->append (end);
+	      break;
+	    }
+	  span.length -= pcktsz;
+	  span.offset += pcktsz;
+	}
+
+      // A skipped part must not reach into the next region
+      long n = live_regions->size ();
+      if (n > 0 && live_regions->fetch (n - 1) > end)
+	live_regions->store (n - 1, end);
+    }
+  live_regions = NULL;
+  if (fsize > lfile->offset)
+    lfile->offset = fsize;
+  delete old;
+}
+
+/* Add the packets written to the data files since they were read, if
+   the experiment was still being written then.  Return the number of
+   records added.  */
+long
+Experiment::refresh_data ()
+{
+  long nfiles = VecSize (live_files);
+  if (nfiles == 0)
+    return 0;
+  long records = count_records ();
+  long ndscrs = VecSize (dataDscrs);
+  long *sizes = new long[ndscrs];
+  for (long i = 0; i < ndscrs; i++)
+    {
+      DataDescriptor *dDscr = dataDscrs->fetch (i);
+      sizes[i] = dDscr ? dDscr->getSize () : 0;
+    }
+
+  // The collector writes a frame before the events that refer to it,
+  // so the frame info is read last.
+  for (int pass = 0; pass < 2; pass++)
+    for (long i = 0; i < nfiles; i++)
+      {
+	LiveDataFile *lfile = live_files->fetch (i);
+	bool frinfo = strcmp (lfile->fname, "data." SP_FRINFO_FILE) == 0;
+	if (frinfo != (pass == 1))
+	  continue;
+	char *data_file_name = dbe_sprintf (NTXT ("%s/%s"), expt_name,
+					    lfile->fname);
+	Data_window *dwin = new Data_window (data_file_name);
+	if (!dwin->not_opened ())
+	  {
+	    dwin->need_swap_endian = need_swap_endian;
+	    read_live_file (dwin, lfile);
+	  }
+	free (data_file_name);
+	delete dwin;
+      }
+  frmpckts->sort (frUidCmp);
+  uidnodes->sort (uidNodeCmp);
+
+  // The records whose frame info was not written yet when they were
+  // resolved are resolved again, along with the new ones.
+  for (long i = 0; i < ndscrs; i++)
+    {
+      DataDescriptor *dDscr = dataDscrs->fetch (i);
+      if (dDscr == NULL || !dDscr->isResolveFrInfoDone ())
+	continue;
+      long first = sizes[i];
+      if (i < unresolved_frinfo->size ()
+	  && unresolved_frinfo->fetch (i) < first)
+	first = unresolved_frinfo->fetch (i);
+      if (dDscr->getSize () > first)
+	resolve_frame_info (dDscr, first);
+    }
+  delete[] sizes;
+  return count_records () - records;
+}
+
 int
 Experiment::read_overview_file ()
 {
@@ -5168,33 +6732,12 @@ Experiment::find_frame_packet (uint64_t uid)
 //  It works on a chunk of iterations (size CSTCTX_CHUNK_SZ) and invokes add_stack()
 // for each one of them
 
+/* Add the call stack properties computed by resolve_frame_info to DDSCR.  */
 void
-Experiment::resolve_frame_info (DataDescriptor *dDscr)
+Experiment::add_frame_info_props (DataDescriptor *dDscr)
 {
-  if (!resolveFrameInfo)
-    return;
-  if (NULL == cstack)
-    return;
-  dDscr->setResolveFrInfoDone ();
-
-  // Check for TSTAMP
-  int propID = dbeSession->getPropIdByName (NTXT ("TSTAMP"));
-  Data *dataTStamp = dDscr->getData (propID);
-  if (dataTStamp == NULL)
-    return;
-
-  propID = dbeSession->getPropIdByName (NTXT ("FRINFO"));
-  Data *dataFrinfo = dDscr->getData (propID);
-
-  propID = dbeSession->getPropIdByName (NTXT ("THRID"));
-  Data *dataThrId = dDscr->getData (propID);
-
-  // We can get frame info either by FRINFO or by [THRID,STKIDX]
-  if (dataFrinfo == NULL)
-    return;
-
   char *propName = NTXT ("MSTACK");
-  propID = dbeSession->getPropIdByName (propName);
+  int propID = dbeSession->getPropIdByName (propName);
   PropDescr *prMStack = new PropDescr (propID, propName);
   prMStack->uname = dbe_strdup (GTXT ("Machine Call Stack"));
   prMStack->vtype = TYPE_OBJ;
@@ -5266,12 +6809,65 @@ Experiment::resolve_frame_info (DataDescriptor *dDscr)
       prop->vtype = TYPE_OBJ;
       dDscr->addProperty (prop);
     }
+}
+
+/* Resolve the call stacks of the records of DDSCR, starting at record
+   FIRST.  FIRST is not 0 when refresh_data has added records to a data
+   descriptor that was resolved before.  */
+void
+Experiment::resolve_frame_info (DataDescriptor *dDscr, long first)
+{
+  if (!resolveFrameInfo)
+    return;
+  if (NULL == cstack)
+    return;
+  dDscr->setResolveFrInfoDone ();
+  unresolved_frinfo->store (dDscr->getId (), dDscr->getSize ());
+
+  // Check for TSTAMP
+  int propID = dbeSession->getPropIdByName (NTXT ("TSTAMP"));
+  Data *dataTStamp = dDscr->getData (propID);
+  if (dataTStamp == NULL)
+    return;
+
+  propID = dbeSession->getPropIdByName (NTXT ("FRINFO"));
+  Data *dataFrinfo = dDscr->getData (propID);
+
+  propID = dbeSession->getPropIdByName (NTXT ("THRID"));
+  Data *dataThrId = dDscr->getData (propID);
+
+  // We can get frame info either by FRINFO or by [THRID,STKIDX]
+  if (dataFrinfo == NULL)
+    return;
+
+  if (first == 0)
+    add_frame_info_props (dDscr);
+
+  // With the experiment cache, the resolved stacks are loaded from it or
+  // saved to it, and shown by dloadstats as <data descriptor>.stacks.
+  DataFileStats *stats = NULL;
+  hrtime_t start_time = gethrtime ();
+  if (first == 0 && !has_java && !ompavail && data_cache_enabled ())
+    {
+      char *fname = dbe_sprintf (NTXT ("%s.stacks"), dDscr->getName ());
+      stats = new DataFileStats (fname);
+      free (fname);
+      stats->records = dDscr->getSize ();
+      load_stats->append (stats);
+      if (read_stack_cache (dDscr))
+	{
+	  stats->cached = true;
+	  stats->read_time = gethrtime () - start_time;
+	  return;
+	}
+    }
+
   char *progress_bar_msg = dbe_sprintf (NTXT ("%s %s: %s"), NTXT ("  "),
 					GTXT ("Processing CallStack Data"),
 					get_basename (expt_name));
   int progress_bar_percent = -1;
   long deltaReport = 5000;
-  long nextReport = 0;
+  long nextReport = first;
 
   long size = dDscr->getSize ();
   //    bool resolve_frinfo_pipelined = size > FRINFO_PIPELINE_SIZE_LIMIT && !ompavail;
@@ -5304,12 +6900,13 @@ Experiment::resolve_frame_info (DataDescriptor *dDscr)
 
   int missed_fi = 0;
   int total_fi = 0;
+  long first_missed = size;
 
-  for (long i = 0; i < size; i++)
+  for (long i = first; i < size; i++)
     {
       if (i == nextReport)
 	{
-	  int percent = (int) (i * 100 / size);
+	  int percent = (int) ((i - first) * 100 / (size - first));
 	  if (percent > progress_bar_percent)
 	    {
 	      progress_bar_percent += 10;
@@ -5345,7 +6942,11 @@ Experiment::resolve_frame_info (DataDescriptor *dDscr)
 		frameInfoCache->put (frinfo, (uint64_t) rfp);
 	    }
 	  else
-	    missed_fi++;
+	    {
+	      missed_fi++;
+	      if (frinfo && first_missed == size)
+		first_missed = i;
+	    }
 	  total_fi++;
 	}
 
@@ -5521,6 +7122,10 @@ Experiment::resolve_frame_info (DataDescriptor *dDscr)
     update_last_event (exp_end_time);
   }
 
+  // refresh_data resolves the records from FIRST_MISSED again once more
+  // frame info has been read.
+  unresolved_frinfo->store (dDscr->getId (), first_missed);
+
   if (missed_fi > 0)
     {
       StringBuilder sb;
@@ -5529,6 +7134,12 @@ Experiment::resolve_frame_info (DataDescriptor *dDscr)
 		  missed_fi, total_fi, dDscr->getName ());
       warnq->append (new Emsg (CMSG_WARN, sb));
     }
+  if (stats != NULL)
+    {
+      if (missed_fi == 0)
+	write_stack_cache (dDscr);
+      stats->read_time = gethrtime () - start_time;
+    }
 
   //    threadPool->wait_group();
   //    delete threadPool;
@@ -6455,6 +8066,23 @@ Experiment::dump_map (FILE *outfile)
   fprintf (outfile, NTXT ("\n"));
 }
 
+void
+Experiment::dump_load_stats (FILE *outfile)
+{
+  fprintf (outfile, GTXT ("Experiment %s\n"), get_expt_name ());
+  fprintf (outfile, GTXT ("File                         Size     Records  Chunks Threads  Read (sec)  Merge (sec)  Cache\n"));
+  for (long i = 0, sz = load_stats->size (); i < sz; i++)
+    {
+      DataFileStats *st = load_stats->fetch (i);
+      fprintf (outfile, "%-20s %12lld %11ld %7d %7d %11.3f %12.3f  %s\n",
+	       st->fname, (long long) st->fsize, st->records, st->chunks,
+	       st->threads, (double) st->read_time / NANOSEC,
+	       (double) st->merge_time / NANOSEC,
+	       st->cached ? GTXT ("yes") : GTXT ("no"));
+    }
+  fprintf (outfile, NTXT ("\n"));
+}
+
 /**
  * Copy file to archive
  * @param name
@@ -401,9 +401,13 @@ public:
   PacketDescriptor *newPacketDescriptor (int kind, DataDescriptor *dDscr);
   PacketDescriptor *getPacketDescriptor (int kind);
 
-  // debugging aids -- dump_stacks, dump_map
+  // Add the data recorded since the data files were read
+  long refresh_data ();
+
+  // debugging aids -- dump_stacks, dump_map, dump_load_stats
   void dump_stacks (FILE *);
   void dump_map (FILE *);
+  void dump_load_stats (FILE *);
 
   // These methods are used in nightly performance regression testing
   void DBG_memuse (Sample *);
@@ -503,6 +507,51 @@ protected:
   uint64_t readPacket (Data_window *dwin, Data_window::Span *span);
   void readPacket (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
 		   DataDescriptor *dDscr, int arg, uint64_t pktsz);
+  char *bindPacket (Data_window *dwin, Data_window::Span *span,
+		    uint64_t *size, int *invalid);
+  void decodePacket (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
+		     uint64_t pktsz, uint64_t *values);
+  void storePacket (DataDescriptor *dDscr, PacketDescriptor *pDscr, int arg,
+		    uint64_t *values);
+
+  // Parallel reading of large data files
+  class DataChunk;
+  struct DataFileStats;
+  static int read_data_chunk_thr (void *arg);
+  void read_data_chunk (DataChunk *chunk);
+  int64_t read_data_chunks (const char *path, int64_t fsize, int *nchunks,
+			    int *nthreads, hrtime_t *merge_time,
+			    const char *progress_bar_msg);
+  int64_t read_data_span (Data_window *dwin, int64_t offset,
+			  const char *progress_bar_msg);
+  long count_records ();
+  Vector<DataFileStats*> *load_stats;
+
+  // Data files read while the experiment was still being written
+  class LiveDataFile;
+  bool is_live_file (const char *fname);
+  void read_live_file (Data_window *dwin, LiveDataFile *lfile);
+  Vector<LiveDataFile*> *live_files;
+  Vector<int64_t> *live_regions;    // parts of the file not written yet
+  Vector<long> *unresolved_frinfo;  // first record of each data type whose
+				    // frame info was not read yet
+
+  // Experiment cache of the records read from data files, and of their
+  // resolved call stacks
+  class DataCacheState;
+  struct DataCacheMap
+  {
+    void *base;
+    size_t size;
+  };
+  bool read_data_cache (const char *fname, dbe_stat_t *sbuf);
+  bool apply_data_cache (char *base, int64_t size, bool apply);
+  void write_data_cache (const char *fname, dbe_stat_t *sbuf,
+			 DataCacheState *old);
+  bool read_stack_cache (DataDescriptor *dDscr);
+  bool apply_stack_cache (char *base, int64_t size, DataDescriptor *dDscr);
+  void write_stack_cache (DataDescriptor *dDscr);
+  Vector<DataCacheMap*> *cache_maps; // caches whose columns are used in place
 
   // read data
   DataDescriptor *get_profile_events ();
@@ -569,7 +618,8 @@ protected:
   void fini ();
   void post_process ();
   void constructJavaStack (FramePacket *, UIDnode *, Map<uint64_t, uint64_t> *);
-  void resolve_frame_info (DataDescriptor*);
+  void add_frame_info_props (DataDescriptor*);
+  void resolve_frame_info (DataDescriptor*, long first = 0);
   void cleanup_cstk_ctx_chunk ();
   void register_metric (Metric::Type type);
   void register_metric (Hwcentry *ctr, const char* aux, const char* username);
@@ -1093,6 +1093,265 @@ Expression::bEval (Context *ctx)
   return false;
 }
 
+/* Return the property read by getVal for PROPID in the packets of
+   CTX->dview, to which *OFFSET is added, or PROP_NONE if getVal computes
+   the value otherwise.  Only the properties used by the thread, LWP, CPU
+   and time filters are handled.  */
+static int
+column_prop (Expression::Context *ctx, int propId, uint64_t *offset)
+{
+  *offset = 0;
+  if (ctx == NULL || ctx->dview == NULL)
+    return PROP_NONE;
+  switch (propId)
+    {
+    case PROP_THRID:
+    case PROP_LWPID:
+    case PROP_CPUID:
+      break;
+    case PROP_TSTAMP_LO:
+    case PROP_TSTAMP_HI:
+      if (ctx->dview->getProp (PROP_EVT_TIME)
+	  || ctx->dview->getProp (PROP_TSTAMP2))
+	return PROP_NONE;
+      // no break; without duration, TSTAMP_LO and TSTAMP_HI are TSTAMP
+    case PROP_TSTAMP:
+      if (ctx->exp == NULL)
+	return PROP_NONE;
+      *offset = ctx->exp->getRelativeStartTime () - ctx->exp->getStartTime ();
+      propId = PROP_TSTAMP;
+      break;
+    case PROP_ETSTAMP:
+      if (ctx->exp == NULL)
+	return PROP_NONE;
+      *offset = -ctx->exp->getStartTime ();
+      propId = PROP_TSTAMP;
+      break;
+    case PROP_ATSTAMP:
+      if (ctx->exp == NULL)
+	return PROP_NONE;
+      propId = PROP_TSTAMP;
+      break;
+    default:
+      return PROP_NONE;
+    }
+  if (ctx->dview->getProp (propId) == NULL)
+    return PROP_NONE;
+  return propId;
+}
+
+/* Set *LO and *HI to the bounds of the value of the expression in the
+   packets of block BLOCK of CTX->dview, which must be an immutable view.
+   Comparisons and logical operators are 0 or 1.  Return false if the
+   bounds are not known, or if the expression can not be evaluated for
+   some packet.  */
+bool
+Expression::bounds (Context *ctx, long block, uint64_t *lo, uint64_t *hi)
+{
+  uint64_t lo0, hi0, lo1, hi1;
+  switch (op)
+    {
+    case OP_NUM:
+      *lo = *hi = v.val;
+      return true;
+    case OP_NAME:
+      {
+	if (arg0 == NULL || arg0->op != OP_NUM || ctx == NULL
+	    || ctx->dview == NULL)
+	  return false;
+	DataDescriptor *dDscr = ctx->dview->getDataDescriptor ();
+	int propId = (int) arg0->v.val;
+	if (propId == PROP_SAMPLE_MAP)
+	  {
+	    // All the packets are in one sample if its first and last are
+	    if (ctx->exp == NULL || ctx->dview->getProp (PROP_SAMPLE)
+		|| !dDscr->getBlockBounds (PROP_TSTAMP, block, &lo0, &hi0))
+	      return false;
+	    Sample *sample = ctx->exp->map_event_to_Sample (lo0);
+	    if (sample == NULL || sample != ctx->exp->map_event_to_Sample (hi0))
+	      return false;
+	    *lo = *hi = sample->get_number ();
+	    return true;
+	  }
+	uint64_t offset;
+	propId = column_prop (ctx, propId, &offset);
+	if (propId == PROP_NONE
+	    || !dDscr->getBlockBounds (propId, block, lo, hi))
+	  return false;
+	*lo += offset;
+	*hi += offset;
+	return *lo <= *hi;
+      }
+    case OP_LT:
+    case OP_LE:
+    case OP_GT:
+    case OP_GE:
+    case OP_EQ:
+    case OP_NE:
+      {
+	if (!arg0->bounds (ctx, block, &lo0, &hi0)
+	    || !arg1->bounds (ctx, block, &lo1, &hi1))
+	  return false;
+	int res; // 1 if true for all the packets, 0 if false for all
+	switch (op)
+	  {
+	  case OP_LT:
+	    res = hi0 < lo1 ? 1 : lo0 >= hi1 ? 0 : -1;
+	    break;
+	  case OP_LE:
+	    res = hi0 <= lo1 ? 1 : lo0 > hi1 ? 0 : -1;
+	    break;
+	  case OP_GT:
+	    res = lo0 > hi1 ? 1 : hi0 <= lo1 ? 0 : -1;
+	    break;
+	  case OP_GE:
+	    res = lo0 >= hi1 ? 1 : hi0 < lo1 ? 0 : -1;
+	    break;
+	  default:
+	    res = lo0 == hi0 && lo1 == hi1 && lo0 == lo1 ? 1
+		    : hi0 < lo1 || hi1 < lo0 ? 0 : -1;
+	    if (op == OP_NE && res != -1)
+	      res = 1 - res;
+	    break;
+	  }
+	*lo = res == 1 ? 1 : 0;
+	*hi = res == 0 ? 0 : 1;
+	return true;
+      }
+    case OP_AND:
+      {
+	// As in bEval, a false operand is enough
+	bool b0 = arg0->bounds (ctx, block, &lo0, &hi0);
+	bool b1 = arg1->bounds (ctx, block, &lo1, &hi1);
+	if ((b0 && hi0 == 0) || (b1 && hi1 == 0))
+	  {
+	    *lo = *hi = 0;
+	    return true;
+	  }
+	if (!b0 || !b1)
+	  return false;
+	*lo = lo0 != 0 && lo1 != 0 ? 1 : 0;
+	*hi = 1;
+	return true;
+      }
+    case OP_OR:
+      {
+	bool b0 = arg0->bounds (ctx, block, &lo0, &hi0);
+	bool b1 = arg1->bounds (ctx, block, &lo1, &hi1);
+	if ((b0 && lo0 != 0) || (b1 && lo1 != 0))
+	  {
+	    *lo = *hi = 1;
+	    return true;
+	  }
+	if (!b0 || !b1)
+	  return false;
+	*lo = 0;
+	*hi = hi0 != 0 || hi1 != 0 ? 1 : 0;
+	return true;
+      }
+    case OP_NOT:
+      if (!arg0->bounds (ctx, block, &lo0, &hi0))
+	return false;
+      *lo = hi0 == 0 ? 1 : 0;
+      *hi = lo0 != 0 ? 0 : 1;
+      return true;
+    default:
+      return false;
+    }
+}
+
+/* Store in VALS the values of the expression in the CNT packets of
+   CTX->dview from FIRST on, at most DATA_BLOCK_SIZE.  The properties
+   are read a column at a time, and the operators applied to whole
+   columns.  Return false if the expression has an operator or property
+   that is only evaluated by bEval.  */
+bool
+Expression::evalBlock (Context *ctx, long first, long cnt, uint64_t *vals)
+{
+  uint64_t vals1[DATA_BLOCK_SIZE];
+  if (cnt > DATA_BLOCK_SIZE)
+    return false;
+  switch (op)
+    {
+    case OP_NUM:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = v.val;
+      return true;
+    case OP_NAME:
+      {
+	if (arg0 == NULL || arg0->op != OP_NUM)
+	  return false;
+	uint64_t offset;
+	int propId = column_prop (ctx, (int) arg0->v.val, &offset);
+	if (propId == PROP_NONE)
+	  return false;
+	Data *data = ctx->dview->getDataDescriptor ()->getData (propId);
+	if (data == NULL || !data->fetchValues (first, cnt, vals))
+	  return false;
+	if (offset != 0)
+	  for (long i = 0; i < cnt; i++)
+	    vals[i] += offset;
+	return true;
+      }
+    case OP_NOT:
+      if (!arg0->evalBlock (ctx, first, cnt, vals))
+	return false;
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] == 0;
+      return true;
+    case OP_LT:
+    case OP_LE:
+    case OP_GT:
+    case OP_GE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_AND:
+    case OP_OR:
+      if (!arg0->evalBlock (ctx, first, cnt, vals)
+	  || !arg1->evalBlock (ctx, first, cnt, vals1))
+	return false;
+      break;
+    default:
+      return false;
+    }
+  switch (op)
+    {
+    case OP_LT:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] < vals1[i];
+      break;
+    case OP_LE:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] <= vals1[i];
+      break;
+    case OP_GT:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] > vals1[i];
+      break;
+    case OP_GE:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] >= vals1[i];
+      break;
+    case OP_EQ:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] == vals1[i];
+      break;
+    case OP_NE:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = vals[i] != vals1[i];
+      break;
+    case OP_AND:
+      for (long i = 0; i < cnt; i++)
+	vals[i] = (vals[i] != 0) & (vals1[i] != 0);
+      break;
+    default: // OP_OR
+      for (long i = 0; i < cnt; i++)
+	vals[i] = (vals[i] != 0) | (vals1[i] != 0);
+      break;
+    }
+  return true;
+}
+
 Expression *
 Expression::pEval (Context *ctx) // partial evaluation (dview may be NULL)
 {
@@ -146,6 +146,10 @@ public:
     return op == OP_NUM;
   };
 
+  // Evaluation on the blocks of packets of an immutable DataView
+  bool bounds (Context *ctx, long block, uint64_t *lo, uint64_t *hi);
+  bool evalBlock (Context *ctx, long first, long cnt, uint64_t *vals);
+
   bool verifyObjectInExpr (Histable *obj);
   Expression *
   pEval (Context *ctx); // Partial evaluation to simplify expression
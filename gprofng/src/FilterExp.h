@@ -47,6 +47,25 @@ public:
     ctx->put (dview, eventId);
   }
 
+  // Return 1 if all the packets of block BLOCK pass, 0 if none passes,
+  // and -1 if they must be evaluated.
+  int
+  passesBlock (long block)
+  {
+    uint64_t lo, hi;
+    if (expr == NULL)
+      return 1;
+    if (!expr->bounds (ctx, block, &lo, &hi))
+      return -1;
+    return lo != 0 ? 1 : hi == 0 ? 0 : -1;
+  }
+
+  bool
+  evalBlock (long first, long cnt, uint64_t *vals)
+  {
+    return expr ? expr->evalBlock (ctx, first, cnt, vals) : false;
+  }
+
   Expression *expr;
   Expression::Context *ctx;
   bool noParFilter;
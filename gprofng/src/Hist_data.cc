@@ -20,6 +20,7 @@
 
 #include "config.h"
 #include <assert.h>
+#include <math.h>
 
 #include "util.h"
 #include "DefaultMap.h"
@@ -1739,6 +1740,86 @@ CStack_data::new_cstack_item ()
   return item;
 }
 
+Diff_data::Diff_data (BaseMetric *_metric, int _ngroups)
+{
+  metric = _metric;
+  ngroups = _ngroups;
+  diff_items = new Vector<Diff_item*>;
+  weight = new double[ngroups];
+  avail = new bool[ngroups];
+  for (int i = 0; i < ngroups; i++)
+    {
+      weight[i] = 0.;
+      avail[i] = true;
+    }
+}
+
+Diff_data::~Diff_data ()
+{
+  diff_items->destroy ();
+  delete diff_items;
+  delete[] weight;
+  delete[] avail;
+}
+
+Diff_data::Diff_item::Diff_item (long _caller, Histable *_func, int ngroups)
+{
+  caller = _caller;
+  func = _func;
+  callees = NULL;
+  incl = new double[ngroups];
+  excl = new double[ngroups];
+  for (int i = 0; i < ngroups; i++)
+    {
+      incl[i] = 0.;
+      excl[i] = 0.;
+    }
+}
+
+Diff_data::Diff_item::~Diff_item ()
+{
+  delete callees;
+  delete[] incl;
+  delete[] excl;
+}
+
+// Return the index of the item for FUNC called from the item CALLER,
+// creating it on first use.
+long
+Diff_data::find_callee (long caller, Histable *func)
+{
+  Diff_item *item = caller >= 0 ? fetch (caller) : NULL;
+  if (item && item->callees)
+    for (long i = 0, sz = item->callees->size (); i < sz; i++)
+      {
+	long ind = item->callees->fetch (i);
+	if (fetch (ind)->func == func)
+	  return ind;
+      }
+  long ind = size ();
+  diff_items->append (new Diff_item (caller, func, ngroups));
+  if (item)
+    {
+      if (item->callees == NULL)
+	item->callees = new Vector<long>;
+      item->callees->append (ind);
+    }
+  return ind;
+}
+
+// Return the difference of a value in group GRP from the base line, in
+// standard deviations.  The events are counted as Poisson processes, so
+// a value V made of events of average value W has a variance of V * W.
+double
+Diff_data::get_significance (Diff_item *item, int grp, bool incl)
+{
+  double *val = incl ? item->incl : item->excl;
+  double var = val[0] * weight[0] + val[grp] * weight[grp];
+  if (var <= 0.)
+    return 0.;
+  return (val[grp] - val[0]) / sqrt (var);
+}
+
 HistableFile::HistableFile ()
 {
   dbeFile = NULL;
@@ -290,4 +290,48 @@ struct CStack_data
   MetricList *metrics;
 };
 
+// Differences between the experiment groups being compared, for the
+// nodes of a call tree of functions aligned across all groups.
+// Group 0 is the base line.
+
+class BaseMetric;
+
+struct Diff_data
+{
+
+  struct Diff_item
+  {
+    Diff_item (long _caller, Histable *_func, int ngroups);
+    ~Diff_item ();
+    long caller;                // index of the calling item, or -1
+    Histable *func;
+    double *incl;               // inclusive value in each group
+    double *excl;               // exclusive value in each group
+    Vector<long> *callees;
+  };
+
+  Diff_data (BaseMetric *, int);
+  ~Diff_data ();
+  long find_callee (long caller, Histable *func);
+  double get_significance (Diff_item *item, int grp, bool incl);
+
+  long
+  size ()
+  {
+    return diff_items->size ();
+  }
+
+  Diff_item *
+  fetch (long i)
+  {
+    return diff_items->fetch (i);
+  }
+
+  BaseMetric *metric;
+  int ngroups;
+  Vector<Diff_item*> *diff_items;
+  double *weight;               // average value of one event in each group
+  bool *avail;                  // the metric is recorded in each group
+};
+
 #endif /* _HIST_DATA_H */
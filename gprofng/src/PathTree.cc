@@ -27,10 +27,12 @@
 #include "CacheMap.h"
 
 #include "DbeSession.h"
+#include "DbeThread.h"
 #include "Application.h"
 #include "CallStack.h"
 #include "Emsg.h"
 #include "Experiment.h"
+#include "ExpGroup.h"
 #include "Expression.h"
 #include "Function.h"
 #include "Histable.h"
@@ -250,6 +252,7 @@ PathTree::allocate_slot (int id, ValueTag vtype)
 
   slots[slot_idx].id = id;
   slots[slot_idx].vtype = vtype;
+  slots[slot_idx].nevents = 0;
   int **ip = new int*[nchunks];
   for (i = 0; i < nchunks; i++)
     ip[i] = NULL;
@@ -603,7 +606,23 @@ PathTree::process_packets (Experiment *exp, DataView *packets, int data_type)
       mslots[midx] = SLOT_IDX (slot_ind);
     }
 
-  for (long i = 0, packets_sz = packets->getSize (); i < packets_sz; ++i)
+  // When there are more events than nodes, add the value of each event
+  // to its leaf node only and compute the inclusive values once, instead
+  // of walking the path of every event.
+  long packets_sz = packets->getSize ();
+  MetricDelta *deltas = NULL;
+  if (packets_sz >= nodes && mlist2.size () > 0)
+    {
+      deltas = new MetricDelta[mlist2.size ()];
+      for (int midx = 0, mlist_sz = mlist2.size (); midx < mlist_sz; ++midx)
+	{
+	  deltas[midx].ptree = this;
+	  deltas[midx].slot = mslots[midx];
+	  deltas[midx].self = new Vector<int64_t*>;
+	}
+    }
+
+  for (long i = 0; i < packets_sz; ++i)
     {
       if (dbeSession->is_interactive ())
 	{
@@ -618,6 +637,17 @@ PathTree::process_packets (Experiment *exp, DataView *packets, int data_type)
 		  && cancel_ok)
 		{
 		  delete[] mslots;
+		  if (deltas)
+		    {
+		      for (int midx = 0; midx < mlist2.size (); ++midx)
+			{
+			  Vector<int64_t*> *self = deltas[midx].self;
+			  for (long k = 0; k < self->size (); k++)
+			    delete[] self->fetch (k);
+			  delete self;
+			}
+		      delete[] deltas;
+		    }
 		  return CANCELED;
 		}
 	    }
@@ -635,8 +665,14 @@ PathTree::process_packets (Experiment *exp, DataView *packets, int data_type)
 	  int64_t mval = mtr->get_val ()->eval (&ctx);
 	  if (mval == 0)
 	    continue;
+	  mslots[midx]->nevents++;
 	  if (path_idx == 0)
 	    path_idx = find_path (exp, packets, i);
+	  if (deltas)
+	    {
+	      ADD_SELF_METRIC (&deltas[midx], path_idx, mval);
+	      continue;
+	    }
 	  NodeIdx node_idx = path_idx;
 	  Slot *mslot = mslots[midx];
 	  while (node_idx)
@@ -649,11 +685,95 @@ PathTree::process_packets (Experiment *exp, DataView *packets, int data_type)
   if (dbeSession->is_interactive ())
     free (progress_bar_msg);
   delete[] mslots;
+  if (deltas)
+    {
+      add_metric_deltas (deltas, mlist2.size ());
+      delete[] deltas;
+    }
   if (indx_expr != NULL)
     root->descendants->sort ((CompareFunc) desc_node_comp, this);
   return NORMAL;
 }
 
+int
+PathTree::add_metric_delta_thr (void *arg)
+{
+  MetricDelta *delta = (MetricDelta *) arg;
+  delta->ptree->add_metric_delta (delta);
+  return 0;
+}
+
+/* Add the values of DELTA, which are set for the leaf nodes of the
+   events, to the inclusive values of its slot.  */
+void
+PathTree::add_metric_delta (MetricDelta *delta)
+{
+  Vector<int64_t*> *self = delta->self;
+  Slot *slot = delta->slot;
+
+  // Every node has a greater index than its ancestor, so a pass from the
+  // last node down adds the values of all descendants to a node before
+  // it is reached.
+  for (long chunk = self->size () - 1; chunk >= 0; chunk--)
+    {
+      int64_t *tmp = self->fetch (chunk);
+      if (tmp == NULL)
+	continue;
+      for (long i = CHUNKSZ - 1; i >= 0; i--)
+	{
+	  NodeIdx idx = chunk * CHUNKSZ + i;
+	  if (tmp[i] == 0 || idx == 0 || idx >= nodes)
+	    continue;
+	  NodeIdx anc = NODE_IDX (idx)->ancestor;
+	  if (anc)
+	    ADD_SELF_METRIC (delta, anc, tmp[i]);
+	}
+    }
+
+  for (long chunk = 0, sz = self->size (); chunk < sz; chunk++)
+    {
+      int64_t *tmp = self->fetch (chunk);
+      if (tmp == NULL)
+	continue;
+      if (slot->vtype == VT_LLONG || slot->vtype == VT_ULLONG)
+	{
+	  int64_t *mvals = slot->mvals64[chunk];
+	  if (mvals == NULL)
+	    mvals = allocate_chunk (slot->mvals64, chunk);
+	  for (int i = 0; i < CHUNKSZ; i++)
+	    mvals[i] += tmp[i];
+	}
+      else
+	{
+	  int *mvals = slot->mvals[chunk];
+	  if (mvals == NULL)
+	    mvals = allocate_chunk (slot->mvals, chunk);
+	  for (int i = 0; i < CHUNKSZ; i++)
+	    mvals[i] += (int) tmp[i];
+	}
+      delete[] tmp;
+    }
+  delete self;
+}
+
+/* Add the NDELTAS metric values of DELTAS to their slots.  The slots
+   are independent, so large trees are done on a thread pool.  */
+void
+PathTree::add_metric_deltas (MetricDelta *deltas, int ndeltas)
+{
+  if (ndeltas > 1 && nodes > CHUNKSZ)
+    {
+      DbeThreadPool *threadPool = new DbeThreadPool (-1);
+      for (int i = 0; i < ndeltas; i++)
+	threadPool->put_queue (new DbeQueue (add_metric_delta_thr, &deltas[i]));
+      threadPool->wait_queues ();
+      delete threadPool;
+    }
+  else
+    for (int i = 0; i < ndeltas; i++)
+      add_metric_delta (&deltas[i]);
+}
+
 DataView *
 PathTree::get_filtered_events (int exp_index, int data_type)
 {
@@ -2600,6 +2720,112 @@ PathTree::get_cstack_list (CStack_data *lam, NodeIdx node_idx, int dpth)
     }
 }
 
+double
+PathTree::get_slot_value (Slot *slot, NodeIdx node_idx)
+{
+  TValue val;
+  val.ll = 0;
+  ASN_METRIC_VAL (val, *slot, node_idx);
+  switch (slot->vtype)
+    {
+    case VT_INT:
+      return (double) val.i;
+    case VT_ULLONG:
+      return (double) val.ull;
+    default:
+      return (double) val.ll;
+    }
+}
+
+/* Build the call tree of functions of all experiment groups, aligned on
+   the functions matched across the groups in compare mode, with the
+   values of the metric BM in each group.  Item 0 is <Total>.  */
+Diff_data *
+PathTree::get_diff_data (BaseMetric *bm)
+{
+  if (reset () == CANCELED || status != 0)
+    return NULL;
+  Vector<ExpGroup*> *groups = dbeSession->expGroups;
+  int ngroups = groups->size ();
+  Slot **gslots = new Slot*[ngroups];
+  for (int i = 0; i < ngroups; i++)
+    {
+      char buf[128];
+      snprintf (buf, sizeof (buf), NTXT ("EXPGRID==%d"),
+		groups->fetch (i)->groupId);
+      BaseMetric *gbm = dbeSession->find_metric (bm->get_type (),
+						 bm->get_cmd (), buf);
+      gslots[i] = gbm ? SLOT_IDX (find_slot (gbm->get_id ())) : NULL;
+    }
+
+  Diff_data *dd = new Diff_data (bm, ngroups);
+  double scale = 1.;
+  if (bm->get_vtype () == VT_DOUBLE && bm->get_precision () > 0)
+    scale /= bm->get_precision ();
+  get_diff_list (dd, gslots, scale, root_idx, -1);
+  if (dd->size () == 0)
+    dd->find_callee (-1, dbeSession->get_Total_Function ());
+
+  // The average value of one event in each group
+  Diff_data::Diff_item *total = dd->fetch (0);
+  for (int i = 0; i < ngroups; i++)
+    if (gslots[i] == NULL)
+      dd->avail[i] = false;
+    else if (gslots[i]->nevents > 0)
+      dd->weight[i] = total->incl[i] / gslots[i]->nevents;
+  delete[] gslots;
+  return dd;
+}
+
+void
+PathTree::get_diff_list (Diff_data *dd, Slot **gslots, double scale,
+			 NodeIdx node_idx, long caller)
+{
+  Node *node = NODE_IDX (node_idx);
+  bool subtree_empty = true;
+  for (int i = 0; i < dd->ngroups; i++)
+    if (gslots[i] && !IS_MVAL_ZERO (*gslots[i], node_idx))
+      {
+	subtree_empty = false;
+	break;
+      }
+  if (subtree_empty)
+    return;
+
+  // Nodes of different instructions of the same function path share
+  // one item, so their values are added.
+  Histable *func = node_idx == root_idx ? dbeSession->get_Total_Function ()
+	  : get_hist_func_obj (node);
+  long ind = dd->find_callee (caller, func);
+  Diff_data::Diff_item *item = dd->fetch (ind);
+  int dsize = NUM_DESCENDANTS (node);
+
+  // LIBRARY VISIBILITY
+  // The call path ends at the entry function of an API-only load object,
+  // unless it is the outermost frame, as in find_path.
+  if (caller > 0)
+    {
+      Function *f = (Function*) node->instr->convertto (Histable::FUNCTION);
+      if (f != NULL
+	  && dbev->get_lo_expand (f->module->loadobject->seg_idx) == LIBEX_API)
+	dsize = 0;
+    }
+  for (int i = 0; i < dd->ngroups; i++)
+    {
+      if (gslots[i] == NULL)
+	continue;
+      double val = get_slot_value (gslots[i], node_idx);
+      double excl = val;
+      for (int index = 0; index < dsize; index++)
+	excl -= get_slot_value (gslots[i], node->descendants->fetch (index));
+      item->incl[i] += val * scale;
+      item->excl[i] += excl * scale;
+    }
+
+  for (int index = 0; index < dsize; index++)
+    get_diff_list (dd, gslots, scale, node->descendants->fetch (index), ind);
+}
+
 Emsg *
 PathTree::fetch_stats ()
 {
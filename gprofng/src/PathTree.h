@@ -60,6 +60,8 @@ public:
 			      PtreeComputeOption flag = COMPUTEOPT_NONE);
   // Get aggregated callstack data
   CStack_data *get_cstack_data (MetricList *);
+  // Get the differences between the experiment groups
+  Diff_data *get_diff_data (BaseMetric *);
 
   Vector<Histable*> *get_clr_instr (Histable *);
   Vector<void*> *get_cle_instr (Histable *, Vector<Histable*>*&);
@@ -152,6 +154,7 @@ private:
   {
     int id;
     ValueTag vtype;
+    int64_t nevents;            // number of events with a value
     union
     {
       int **mvals;
@@ -361,6 +364,33 @@ private:
     return &slots[idx];
   }
 
+  // Metric values of events added to their leaf nodes only
+  struct MetricDelta
+  {
+    PathTree *ptree;
+    Slot *slot;
+    Vector<int64_t*> *self;     // chunks of values by node index
+  };
+
+  inline void
+  ADD_SELF_METRIC (MetricDelta *delta, NodeIdx idx, int64_t val)
+  {
+    long chunk = idx / CHUNKSZ;
+    int64_t *tmp = chunk < delta->self->size () ? delta->self->fetch (chunk)
+	    : NULL;
+    if (tmp == NULL)
+      {
+	tmp = new int64_t[CHUNKSZ];
+	for (int i = 0; i < CHUNKSZ; i++)
+	  tmp[i] = 0;
+	delta->self->store (chunk, tmp);
+      }
+    tmp[idx % CHUNKSZ] += val;
+  }
+
+  static int add_metric_delta_thr (void *arg);
+  void add_metric_delta (MetricDelta *delta);
+  void add_metric_deltas (MetricDelta *deltas, int ndeltas);
   int allocate_slot (int id, ValueTag vtype);
   void allocate_slots (Slot *slots, int nslots);
   int find_slot (int);
@@ -383,6 +413,8 @@ private:
   void get_self_metrics (Histable *, Vector<Function*> *funclist,
 			 Vector<Histable*>* sel_objs = NULL);
   void get_cstack_list (CStack_data *, NodeIdx, int);
+  double get_slot_value (Slot *, NodeIdx);
+  void get_diff_list (Diff_data *, Slot **, double, NodeIdx, long);
 
   // Generate PathTree based on Functions instead of Instructions // Used for flame chart
   void ftree_reset ();
@@ -51,6 +51,7 @@
 #include "Table.h"
 #include "DbeFile.h"
 #include "CallStack.h"
+#include "ExpGroup.h"
 
 int
 er_print_common_display::open (Print_params *params)
@@ -1125,6 +1126,179 @@ er_print_ctree::print_children (Hist_data *data, int index, Histable *my_obj,
   return;
 }
 
+/*
+ * Class er_print_regressions to print the call paths whose metric values
+ * increased significantly in the compared experiments
+ */
+
+// Call paths with a smaller significance are not reported
+#define MIN_REGRESSION_SIGNIFICANCE 2.0
+
+er_print_regressions::er_print_regressions (DbeView *_dbev, int _limit)
+{
+  dbev = _dbev;
+  limit = _limit;
+  exp_idx1 = 0;
+  exp_idx2 = dbeSession->nexps () - 1;
+  load = false;
+  header = false;
+}
+
+// Sort the items by decreasing delta
+static int
+regression_comp (const void *s1, const void *s2, const void *arg)
+{
+  double *delta = (double *) arg;
+  double d1 = delta[*(long *) s1];
+  double d2 = delta[*(long *) s2];
+  if (d1 > d2)
+    return -1;
+  if (d1 < d2)
+    return 1;
+  return *(long *) s1 < *(long *) s2 ? -1 : 1;
+}
+
+// Return the functions from the root to item INDEX, separated by ';'
+char *
+er_print_regressions::get_path (Diff_data *data, long index,
+				Histable::NameFormat nfmt)
+{
+  Vector<Histable*> funcs;
+  for (long i = index; i > 0; i = data->fetch (i)->caller)
+    funcs.append (data->fetch (i)->func);
+  StringBuilder sb;
+  for (long i = funcs.size () - 1; i >= 0; i--)
+    {
+      sb.append (funcs.fetch (i)->get_name (nfmt));
+      if (i > 0)
+	sb.append (';');
+    }
+  return sb.toString ();
+}
+
+void
+er_print_regressions::data_dump ()
+{
+  // Use the sort metric, or else the first metric that can be compared
+  MetricList *mlist = dbev->get_metric_list (MET_NORMAL);
+  Metric *mtr = mlist->get_sort_metric ();
+  BaseMetric *bm = NULL;
+  for (long i = -1, sz = mlist->size (); i < sz && bm == NULL; i++)
+    {
+      if (i >= 0)
+	mtr = mlist->get (i);
+      if (mtr == NULL || !mtr->comparable ())
+	continue;
+      bm = dbeSession->find_metric (mtr->get_type (), mtr->get_cmd (), NULL);
+      if (bm && bm->get_packet_type () == (ProfData_type) -1)
+	bm = NULL;
+    }
+  Diff_data *data = bm ? dbev->get_diff_data (bm) : NULL;
+  if (data == NULL)
+    {
+      fprintf (out_file, GTXT ("\nNo metric to compare\n\n"));
+      return;
+    }
+
+  bool incl = mtr->get_subtype () == BaseMetric::INCLUSIVE;
+  const char *fmt = bm->get_vtype () == VT_DOUBLE ? "%.3f" : "%.0f";
+  const char *sfmt = bm->get_vtype () == VT_DOUBLE ? "%+.3f" : "%+.0f";
+  Histable::NameFormat nfmt = dbev->get_name_format ();
+  bool delim = dbev->get_printmode () == PM_DELIM_SEP_LIST;
+  char dc = dbev->get_printdelimiter ();
+  Vector<ExpGroup*> *groups = dbeSession->expGroups;
+  long nitems = data->size ();
+  double *delta = new double[nitems];
+  Vector<long> rows;
+
+  if (delim)
+    fprintf (out_file, "\"%s\"%c\"%s\"%c\"%s\"%c\"%s\"%c\"%s\"%c\"%s\"%c"
+	     "\"%s\"%c\"%s\"\n",
+	     GTXT ("Group"), dc, GTXT ("Rank"), dc, GTXT ("Delta"), dc,
+	     GTXT ("Base"), dc, GTXT ("Compared"), dc, GTXT ("Change"), dc,
+	     GTXT ("Significance"), dc, GTXT ("Call path"));
+  for (int grp = 1; grp < data->ngroups; grp++)
+    {
+      // No values to compare
+      int na = !data->avail[0] ? 0 : !data->avail[grp] ? grp : -1;
+      if (na >= 0)
+	{
+	  fprintf (delim ? stderr : out_file,
+		   GTXT ("Metric `%s' is not available in `%s'\n"),
+		   mtr->get_name (), groups->fetch (na)->name);
+	  if (!delim)
+	    fprintf (out_file, nl);
+	  continue;
+	}
+
+      rows.reset ();
+      for (long i = 0; i < nitems; i++)
+	{
+	  Diff_data::Diff_item *item = data->fetch (i);
+	  double *val = incl ? item->incl : item->excl;
+	  delta[i] = val[grp] - val[0];
+	  if (i > 0 && delta[i] > 0 && data->get_significance (item, grp, incl)
+	      >= MIN_REGRESSION_SIGNIFICANCE)
+	    rows.append (i);
+	}
+      rows.sort ((CompareFunc) regression_comp, delta);
+      rows.insert (0, 0);   // <Total> first
+      long nrows = rows.size ();
+      if (limit > 0 && nrows > limit + 1)
+	nrows = limit + 1;
+
+      if (!delim)
+	{
+	  fprintf (out_file,
+		   GTXT ("Call paths that regressed in `%s' relative to `%s'\n"),
+		   groups->fetch (grp)->name, groups->fetch (0)->name);
+	  fprintf (out_file, GTXT ("Sorted by the increase of metric: %s\n\n"),
+		   mtr->get_name ());
+	  fprintf (out_file, "%4s  %12s  %12s  %12s  %8s  %7s  %s\n",
+		   GTXT ("Rank"), GTXT ("Delta"), GTXT ("Base"),
+		   GTXT ("Compared"), GTXT ("Change"), GTXT ("Signif."),
+		   GTXT ("Call path"));
+	}
+      for (long r = 0; r < nrows; r++)
+	{
+	  long ind = rows.fetch (r);
+	  Diff_data::Diff_item *item = data->fetch (ind);
+	  // <Total> has no exclusive value
+	  double *val = incl || ind == 0 ? item->incl : item->excl;
+	  double d = val[grp] - val[0];
+	  double sig = data->get_significance (item, grp, incl || ind == 0);
+	  char *dstr = dbe_sprintf (sfmt, d);
+	  char *bstr = dbe_sprintf (fmt, val[0]);
+	  char *cstr = dbe_sprintf (fmt, val[grp]);
+	  char *pstr = val[0] > 0 ? dbe_sprintf ("%+.1f%%", 100. * d / val[0])
+		  : dbe_strdup (NTXT ("-"));
+	  char *path = ind == 0 ? dbe_strdup (item->func->get_name (nfmt))
+		  : get_path (data, ind, nfmt);
+	  if (delim)
+	    {
+	      char *p = csv_ize_name (path, dc);
+	      fprintf (out_file, "\"%d\"%c\"%ld\"%c\"%s\"%c\"%s\"%c\"%s\"%c"
+		       "\"%s\"%c\"%.2f\"%c\"%s\"\n",
+		       grp + 1, dc, r, dc, dstr, dc, bstr, dc, cstr, dc,
+		       pstr, dc, sig, dc, p);
+	      free (p);
+	    }
+	  else
+	    fprintf (out_file, "%4ld  %12s  %12s  %12s  %8s  %7.2f  %s\n",
+		     r, dstr, bstr, cstr, pstr, sig, path);
+	  free (dstr);
+	  free (bstr);
+	  free (cstr);
+	  free (pstr);
+	  free (path);
+	}
+      if (!delim)
+	fprintf (out_file, nl);
+    }
+  delete[] delta;
+  delete data;
+}
+
 er_print_gprof::er_print_gprof (DbeView *_dbev, Vector<Histable*> *_cstack)
 {
   dbev = _dbev;
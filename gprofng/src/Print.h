@@ -160,6 +160,18 @@ private:
   int print_row;
 };
 
+class er_print_regressions : public er_print_common_display
+{
+public:
+  er_print_regressions (DbeView *dbv, int limit);
+  void data_dump ();
+
+private:
+  char *get_path (Diff_data *data, long index, Histable::NameFormat nfmt);
+
+  int limit;
+};
+
 class er_print_gprof : public er_print_common_display
 {
 public:
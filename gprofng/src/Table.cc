@@ -213,6 +213,21 @@ checkCompatibility (VType_type v1, VType_type v2)
     }
 }
 
+/* Store in VALS the values of DATA from I to I+CNT-1.  The packets
+   without a value yet are 0, as in DataDescriptor::getLongValue.  */
+template <typename ITEM> static void
+fetchVectorValues (Vector<ITEM> *data, long i, long cnt, uint64_t *vals)
+{
+  long n = data->size () - i;
+  if (n > cnt)
+    n = cnt;
+  long k = 0;
+  for (; k < n; k++)
+    vals[k] = (uint64_t) data->fetch (i + k);
+  for (; k < cnt; k++)
+    vals[k] = 0;
+}
+
 class DataINT32 : public Data
 {
 public:
@@ -318,6 +333,13 @@ public:
     return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
   }
 
+  virtual bool
+  fetchValues (long i, long cnt, uint64_t *vals)
+  {
+    fetchVectorValues (data, i, cnt, vals);
+    return true;
+  }
+
 private:
   Vector<int32_t> *data;
 };
@@ -427,6 +449,13 @@ public:
     return u1 < u2 ? -1 : u1 > u2 ? 1 : 0;
   }
 
+  virtual bool
+  fetchValues (long i, long cnt, uint64_t *vals)
+  {
+    fetchVectorValues (data, i, cnt, vals);
+    return true;
+  }
+
 private:
   Vector<uint32_t> *data;
 };
@@ -536,6 +565,13 @@ public:
     return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
   }
 
+  virtual bool
+  fetchValues (long i, long cnt, uint64_t *vals)
+  {
+    fetchVectorValues (data, i, cnt, vals);
+    return true;
+  }
+
 private:
   Vector<int64_t> *data;
 };
@@ -645,6 +681,13 @@ public:
     return u1 < u2 ? -1 : u1 > u2 ? 1 : 0;
   }
 
+  virtual bool
+  fetchValues (long i, long cnt, uint64_t *vals)
+  {
+    fetchVectorValues (data, i, cnt, vals);
+    return true;
+  }
+
 private:
   Vector<uint64_t> *data;
 };
@@ -976,6 +1019,160 @@ private:
   Vector<double> *data;
 };
 
+/* A column of integers of type VTYPE read in place from a mapped file,
+   such as the experiment cache.  It is copied to a column of the usual
+   kind when a value is first changed.  */
+template <typename ITEM, VType_type VTYPE>
+class DataMapped : public Data
+{
+public:
+
+  DataMapped (const ITEM *_vals, long _nvals)
+  {
+    vals = _vals;
+    nvals = _nvals;
+    copied = NULL;
+  }
+
+  virtual
+  ~DataMapped ()
+  {
+    delete copied;
+  }
+
+  virtual VType_type
+  type ()
+  {
+    return VTYPE;
+  }
+
+  virtual void
+  reset ()
+  {
+    copy ()->reset ();
+  }
+
+  virtual long
+  getSize ()
+  {
+    return copied ? copied->getSize () : nvals;
+  }
+
+  virtual int
+  fetchInt (long i)
+  {
+    return copied ? copied->fetchInt (i) : (int) vals[i];
+  }
+
+  virtual unsigned long long
+  fetchULong (long i)
+  {
+    return copied ? copied->fetchULong (i) : (unsigned long long) vals[i];
+  }
+
+  virtual long long
+  fetchLong (long i)
+  {
+    return copied ? copied->fetchLong (i) : (long long) vals[i];
+  }
+
+  virtual char *
+  fetchString (long i)
+  {
+    if (copied)
+      return copied->fetchString (i);
+    if ((ITEM) -1 < 0)
+      return dbe_sprintf (NTXT ("%lld"), (long long) vals[i]);
+    return dbe_sprintf (NTXT ("%llu"), (unsigned long long) vals[i]);
+  }
+
+  virtual double
+  fetchDouble (long i)
+  {
+    return copied ? copied->fetchDouble (i) : (double) vals[i];
+  }
+
+  virtual void *
+  fetchObject (long)
+  {
+    assert (ASSERT_SKIP);
+    return NULL;
+  }
+
+  virtual void
+  setDatumValue (long idx, const Datum *val)
+  {
+    copy ()->setDatumValue (idx, val);
+  }
+
+  virtual void
+  setValue (long idx, uint64_t val)
+  {
+    copy ()->setValue (idx, val);
+  }
+
+  virtual void
+  setObjValue (long, void*)
+  {
+    assert (ASSERT_SKIP);
+    return;
+  }
+
+  virtual int
+  cmpValues (long idx1, long idx2)
+  {
+    if (copied)
+      return copied->cmpValues (idx1, idx2);
+    ITEM i1 = vals[idx1];
+    ITEM i2 = vals[idx2];
+    return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+  }
+
+  virtual int
+  cmpDatumValue (long idx, const Datum *val)
+  {
+    if (copied)
+      return copied->cmpDatumValue (idx, val);
+    ITEM i1 = vals[idx];
+    ITEM i2 = sizeof (ITEM) == 4 ? (ITEM) val->i : (ITEM) val->ll;
+    return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+  }
+
+  virtual bool
+  fetchValues (long i, long cnt, uint64_t *v)
+  {
+    if (copied)
+      return copied->fetchValues (i, cnt, v);
+    long n = nvals - i;
+    if (n > cnt)
+      n = cnt;
+    long k = 0;
+    for (; k < n; k++)
+      v[k] = (uint64_t) vals[i + k];
+    for (; k < cnt; k++)
+      v[k] = 0;
+    return true;
+  }
+
+private:
+
+  Data *
+  copy ()
+  {
+    if (copied == NULL)
+      {
+	copied = Data::newData (VTYPE);
+	for (long i = nvals - 1; i >= 0; i--)
+	  copied->setValue (i, (uint64_t) vals[i]);
+      }
+    return copied;
+  }
+
+  const ITEM *vals;
+  long nvals;
+  Data *copied;     // the values once one was changed
+};
+
 Data *
 Data::newData (VType_type vtype)
 {
@@ -1000,6 +1197,31 @@ Data::newData (VType_type vtype)
     }
 }
 
+/* Return a column of type VTYPE holding the NVALS values at VALS, which
+   must stay mapped while it is used, or NULL if VTYPE is not an integer
+   type.  */
+Data *
+Data::newMappedData (VType_type vtype, const void *vals, long nvals)
+{
+  switch (vtype)
+    {
+    case TYPE_INT32:
+      return new DataMapped<int32_t, TYPE_INT32>((const int32_t *) vals,
+						 nvals);
+    case TYPE_UINT32:
+      return new DataMapped<uint32_t, TYPE_UINT32>((const uint32_t *) vals,
+						   nvals);
+    case TYPE_INT64:
+      return new DataMapped<int64_t, TYPE_INT64>((const int64_t *) vals,
+						 nvals);
+    case TYPE_UINT64:
+      return new DataMapped<uint64_t, TYPE_UINT64>((const uint64_t *) vals,
+						   nvals);
+    default:
+      return NULL;
+    }
+}
+
 /*
  *    class DataDescriptor
  */
@@ -1018,6 +1240,7 @@ DataDescriptor::DataDescriptor (int _id, const char *_name, const char *_uname,
   props = new Vector<PropDescr*>;
   data = new Vector<Data*>;
   setsTBR = new Vector<Vector<long long>*>;
+  blockBounds = new Vector<Vector<uint64_t>*>;
 
   // master references point to self:
   ref_size = &master_size;
@@ -1039,6 +1262,7 @@ DataDescriptor::DataDescriptor (int _id, const char *_name, const char *_uname,
   props = dDscr->props;
   data = dDscr->data;
   setsTBR = dDscr->setsTBR;
+  blockBounds = dDscr->blockBounds;
 
   // data that should never be accessed in reference copy
   master_size = -1;
@@ -1057,6 +1281,8 @@ DataDescriptor::~DataDescriptor ()
   delete data;
   setsTBR->destroy ();
   delete setsTBR;
+  blockBounds->destroy ();
+  delete blockBounds;
 }
 
 void
@@ -1072,6 +1298,9 @@ DataDescriptor::reset ()
       Vector<long long> *set = setsTBR->fetch (i);
       if (set != NULL)
 	set->reset ();
+      Vector<uint64_t> *bounds = blockBounds->fetch (i);
+      if (bounds != NULL)
+	bounds->reset ();
     }
   master_size = 0;
 }
@@ -1113,6 +1342,26 @@ DataDescriptor::addProperty (PropDescr *propDscr)
   props->append (propDscr);
   data->store (propDscr->propID, Data::newData (propDscr->vtype));
   setsTBR->store (propDscr->propID, NULL);
+  blockBounds->store (propDscr->propID, NULL);
+}
+
+/* Replace the values of property PROP_ID, which has none yet, by the
+   column D.  */
+bool
+DataDescriptor::setData (int prop_id, Data *d)
+{
+  Data *old = getData (prop_id);
+  if (old == NULL || old->getSize () != 0 || old->type () != d->type ())
+    return false;
+  delete old;
+  data->store (prop_id, d);
+  Vector<long long> *set = setsTBR->fetch (prop_id);
+  if (set != NULL)
+    {
+      delete set;
+      setsTBR->store (prop_id, NULL);
+    }
+  return true;
 }
 
 long
@@ -1158,6 +1407,7 @@ DataDescriptor::setDatumValue (int prop_id, long idx, const Datum *val)
       Vector<long long> *set = setsTBR->fetch (prop_id);
       if (set != NULL)// Sets are maintained
 	checkEntity (set, d->fetchLong (idx));
+      resetBlockBounds (prop_id, idx);
     }
 }
 
@@ -1173,6 +1423,7 @@ DataDescriptor::setValue (int prop_id, long idx, uint64_t val)
       Vector<long long> *set = setsTBR->fetch (prop_id);
       if (set != NULL)// Sets are maintained
 	checkEntity (set, d->fetchLong (idx));
+      resetBlockBounds (prop_id, idx);
     }
 }
 
@@ -1278,6 +1529,58 @@ DataDescriptor::getSet (int prop_id)
   return set;
 }
 
+/* Set *LO and *HI to the minimum and maximum values of property PROP_ID,
+   as used in filter expressions, in the packets of block BLOCK.  The
+   bounds of the complete blocks are computed when first needed.  Return
+   false if they are not known.  */
+bool
+DataDescriptor::getBlockBounds (int prop_id, long block, uint64_t *lo,
+				uint64_t *hi)
+{
+  if (prop_id < 0 || prop_id >= blockBounds->size ())
+    return false;
+  long nblocks = *ref_size / DATA_BLOCK_SIZE;
+  if (block >= nblocks)
+    return false;
+  Data *d = getData (prop_id);
+  if (d == NULL)
+    return false;
+  Vector<uint64_t> *bounds = blockBounds->fetch (prop_id);
+  if (bounds == NULL)
+    {
+      bounds = new Vector<uint64_t>;
+      blockBounds->store (prop_id, bounds);
+    }
+  uint64_t vals[DATA_BLOCK_SIZE];
+  for (long b = bounds->size () / 2; b <= block; b++)
+    {
+      if (!d->fetchValues (b * DATA_BLOCK_SIZE, DATA_BLOCK_SIZE, vals))
+	return false;
+      uint64_t min = vals[0];
+      uint64_t max = vals[0];
+      for (long i = 1; i < DATA_BLOCK_SIZE; i++)
+	{
+	  min = vals[i] < min ? vals[i] : min;
+	  max = vals[i] > max ? vals[i] : max;
+	}
+      bounds->append (min);
+      bounds->append (max);
+    }
+  *lo = bounds->fetch (2 * block);
+  *hi = bounds->fetch (2 * block + 1);
+  return true;
+}
+
+/* Drop the block bounds of property PROP_ID if the value of packet IDX
+   has changed after they were computed.  */
+void
+DataDescriptor::resetBlockBounds (int prop_id, long idx)
+{
+  Vector<uint64_t> *bounds = blockBounds->fetch (prop_id);
+  if (bounds != NULL && idx < bounds->size () / 2 * DATA_BLOCK_SIZE)
+    bounds->reset ();
+}
+
 /*
  *    class DataView
  */
@@ -1389,12 +1692,34 @@ DataView::checkUpdate ()
     {
       DataView *tmpView = ddscr->createImmutableView ();
       assert (tmpView->getSize () == newSize);
+      uint64_t vals[DATA_BLOCK_SIZE];
+      filter->put (tmpView, ddsize);
       while (ddsize < newSize)
 	{
-	  filter->put (tmpView, ddsize);
-	  if (filter->passes ())
-	    index->append (ddsize);
-	  ddsize += 1;
+	  // Filter a block of packets at a time: whole blocks are often
+	  // selected or rejected by the bounds of their properties alone
+	  long block = ddsize / DATA_BLOCK_SIZE;
+	  long cnt = (block + 1) * DATA_BLOCK_SIZE - ddsize;
+	  if (cnt > newSize - ddsize)
+	    cnt = newSize - ddsize;
+	  int res = cnt == DATA_BLOCK_SIZE ? filter->passesBlock (block) : -1;
+	  if (res == 1)
+	    for (long i = 0; i < cnt; i++)
+	      index->append (ddsize + i);
+	  else if (res == -1 && filter->evalBlock (ddsize, cnt, vals))
+	    {
+	      for (long i = 0; i < cnt; i++)
+		if (vals[i] != 0)
+		  index->append (ddsize + i);
+	    }
+	  else if (res == -1)
+	    for (long i = 0; i < cnt; i++)
+	      {
+		filter->put (tmpView, ddsize + i);
+		if (filter->passes ())
+		  index->append (ddsize + i);
+	      }
+	  ddsize += cnt;
 	}
       delete tmpView;
       return updated;
@@ -373,6 +373,7 @@ class Data
 {
 public:
   static Data *newData (VType_type);
+  static Data *newMappedData (VType_type, const void *vals, long nvals);
 
   virtual
   ~Data () { }
@@ -395,8 +396,21 @@ public:
   virtual void setObjValue (long, void*) = 0;
   virtual int cmpValues (long idx1, long idx2) = 0;
   virtual int cmpDatumValue (long idx, const Datum *val) = 0;
+
+  // Store in VALS the values of the CNT packets from I on, converted
+  // like filter expressions do.  Return false if they are not integers.
+  virtual bool
+  fetchValues (long, long, uint64_t *)
+  {
+    return false;
+  }
 };
 
+// Filters are evaluated on blocks of DATA_BLOCK_SIZE packets.  Blocks
+// can be skipped, or taken as a whole, from the minimum and maximum
+// values of the properties in the block.
+#define DATA_BLOCK_SIZE 1024
+
 enum Data_flag
 {
   DDFLAG_NOSHOW = 0x01
@@ -474,11 +488,13 @@ public:
   long long getLongValue (int prop_id, long pkt_id);
   void *getObjValue (int prop_id, long pkt_id);
   Vector<long long> *getSet (int prop_id); // list of sorted, unique values
+  bool getBlockBounds (int prop_id, long block, uint64_t *lo, uint64_t *hi);
 
   // table creation/reset
   void addProperty (PropDescr*); // add property to all packets
   long addRecord ();            // add packet
   Data *getData (int prop_id);  // get all packets
+  bool setData (int prop_id, Data *d); // set all packets
   void setDatumValue (int prop_id, long pkt_id, const Datum *val);
   void setValue (int prop_id, long pkt_id, uint64_t val);
   void setObjValue (int prop_id, long pkt_id, void *val);
@@ -498,6 +514,8 @@ public:
 
 
 private:
+  void resetBlockBounds (int prop_id, long idx);
+
   bool isMaster;
   int flags;        // see Data_flag enum
   int id;
@@ -514,6 +532,7 @@ private:
   Vector<PropDescr*> *props;
   Vector<Data*> *data;
   Vector<Vector<long long>*> *setsTBR; // Sets of unique values
+  Vector<Vector<uint64_t>*> *blockBounds; // min and max value of each block
 };
 
 typedef struct
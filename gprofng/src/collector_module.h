@@ -32,6 +32,7 @@
 
 struct stat;
 struct tm;
+struct dl_phdr_info;
 
 #define COLLECTOR_MODULE_ERR    ((CollectorModule)-1)
 
@@ -46,6 +47,8 @@ typedef struct CollectorUtilFuncs
   int (*clearenv)(void);
   int (*close)(int);
   int (*closedir)(DIR *);
+  int (*dl_iterate_phdr)(int (*callback)(struct dl_phdr_info *, size_t, void *),
+			  void *data);
   int (*execv)(const char *path, char *const argv[]);
   void (*exit)(int status);
   int (*fclose)(FILE *stream);
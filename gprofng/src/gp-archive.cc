@@ -35,6 +35,7 @@
 #include "ArchiveExp.h"
 #include "Print.h"
 #include "Module.h"
+#include "Data_window.h"
 
 er_archive::er_archive (int argc, char *argv[]) : DbeApplication (argc, argv)
 {
@@ -45,6 +46,7 @@ er_archive::er_archive (int argc, char *argv[]) : DbeApplication (argc, argv)
   use_relative_path = 0;
   s_option = ARCH_EXE_ONLY;
   mask = NULL;
+  compress = 0;
 }
 
 er_archive::~er_archive ()
@@ -124,6 +126,9 @@ er_archive::usage ()
     " -m <regex>         archive only those source, object, and debug info files whose full\n"
     "                    path name matches the given POSIX compliant regular expression.\n"
     "\n"
+    " -z                 compress the data files of the experiment; the tools that read\n"
+    "                    the experiment decompress them transparently.\n"
+    "\n"
     "Limitations:\n"
     "\n"
     "Default archiving does not occur in case the application profiled terminates prematurely,\n"
@@ -271,7 +276,7 @@ er_archive::start (int argc, char *argv[])
   if (check_args (argc, argv) != last)
     usage ();
   check_env_var ();
-  if (s_option == ARCH_NOTHING)
+  if (s_option == ARCH_NOTHING && !compress)
     return;
 
   ArchiveExp *founder_exp = new ArchiveExp (argv[last]);
@@ -282,25 +287,6 @@ er_archive::start (int argc, char *argv[])
 		 pr_mesgs (founder_exp->fetch_errors (), NTXT (""), NTXT ("")));
       exit (1);
     }
-  if (!founder_exp->create_dir (founder_exp->get_arch_name ()))
-    {
-      fprintf (stderr, GTXT ("Unable to create directory `%s'\n"), founder_exp->get_arch_name ());
-      exit (1);
-    }
-  if (!common_archive_dir)
-    common_archive_dir = dbe_strdup (getenv ("GPROFNG_ARCHIVE_COMMON_DIR"));
-  if (common_archive_dir)
-    {
-      if (!founder_exp->create_dir (common_archive_dir))
-	if (dbe_stat (common_archive_dir, NULL) != 0)
-	  {
-	    fprintf (stderr, GTXT ("Unable to create directory for common archive `%s'\n"), common_archive_dir);
-	    exit (1);
-	  }
-    }
-  // Clean old archives if necessary
-  if (force)
-    clean_old_archive (argv[last], founder_exp);
   Vector<ArchiveExp*> *exps = new Vector<ArchiveExp*>();
   exps->append (founder_exp);
   if (descendant)
@@ -326,6 +312,31 @@ er_archive::start (int argc, char *argv[])
 	  delete exp_names;
 	}
     }
+  if (compress)
+    for (long i = 0, sz = exps->size (); i < sz; i++)
+      compress_data (exps->get (i));
+  if (s_option == ARCH_NOTHING)
+    return;
+
+  if (!founder_exp->create_dir (founder_exp->get_arch_name ()))
+    {
+      fprintf (stderr, GTXT ("Unable to create directory `%s'\n"), founder_exp->get_arch_name ());
+      exit (1);
+    }
+  if (!common_archive_dir)
+    common_archive_dir = dbe_strdup (getenv ("GPROFNG_ARCHIVE_COMMON_DIR"));
+  if (common_archive_dir)
+    {
+      if (!founder_exp->create_dir (common_archive_dir))
+	if (dbe_stat (common_archive_dir, NULL) != 0)
+	  {
+	    fprintf (stderr, GTXT ("Unable to create directory for common archive `%s'\n"), common_archive_dir);
+	    exit (1);
+	  }
+    }
+  // Clean old archives if necessary
+  if (force)
+    clean_old_archive (argv[last], founder_exp);
   for (long i = 0, sz = exps->size (); i < sz; i++)
     {
       ArchiveExp *exp = exps->get (i);
@@ -510,7 +521,7 @@ er_archive::check_args (int argc, char *argv[])
   while (1)
     {
       int option_index = 0;
-      opt = getopt_long (argc, argv, NTXT (":VFa:d:qnr:m:"),
+      opt = getopt_long (argc, argv, NTXT (":VFa:d:qnr:m:z"),
 			 long_options, &option_index);
       if (opt == EOF)
 	break;
@@ -537,6 +548,9 @@ er_archive::check_args (int argc, char *argv[])
 	case 'n':
 	  descendant = 0;
 	  break;
+	case 'z':
+	  compress = 1;
+	  break;
 	case 'r': // Common archive directory (relative path)
 	  if (dseen)
 	    {
@@ -678,6 +692,43 @@ er_archive::check_env_var ()
   free (var);
 }
 
+// Compress the binary data files of an experiment.  They are read through
+// Data_window, which decompresses them transparently.
+void
+er_archive::compress_data (ArchiveExp *exp)
+{
+  static const char *data_files[] = {
+    SP_PROFILE_FILE, SP_SYNCTRACE_FILE, SP_IOTRACE_FILE, SP_OMPTRACE_FILE,
+    SP_HWCNTR_FILE, SP_HEAPTRACE_FILE, SP_RACETRACE_FILE, SP_DEADLOCK_FILE,
+    "data." SP_FRINFO_FILE, SP_OVERVIEW_FILE, SP_JCLASSES_FILE,
+    SP_DYNTEXT_FILE, NULL
+  };
+  char *expname = exp->get_expt_name ();
+  if (exp->get_status () != Experiment::SUCCESS)
+    {
+      // The data files may still be written.
+      if (!quiet)
+	fprintf (stderr, GTXT ("gp-archive: %s: experiment was not closed; data files not compressed\n"),
+		 expname);
+      return;
+    }
+  for (int i = 0; data_files[i]; i++)
+    {
+      char *fnm = dbe_sprintf (NTXT ("%s/%s"), expname, data_files[i]);
+      if (dbe_stat_file (fnm, NULL) == 0)
+	{
+	  char *errmsg = Data_window::compress_file (fnm);
+	  if (errmsg)
+	    {
+	      if (!quiet)
+		fprintf (stderr, GTXT ("gp-archive: %s\n"), errmsg);
+	      free (errmsg);
+	    }
+	}
+      free (fnm);
+    }
+}
+
 static int
 real_main (int argc, char *argv[])
 {
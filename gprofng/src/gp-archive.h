@@ -50,6 +50,7 @@ private:
   int clean_old_archive (char *expname, ArchiveExp *founder_exp);
   int mask_is_on (const char *str);
   void check_env_var ();
+  void compress_data (ArchiveExp *exp);
   Vector <LoadObject*> *get_loadObjs ();
 
   Vector<regex_t *> *mask;  // -m <regexp>
@@ -59,6 +60,7 @@ private:
   int quiet;                // -q
   int descendant;           // -n
   int use_relative_path;    // -r
+  int compress;             // -z
 };
 
 #endif
\ No newline at end of file
@@ -862,6 +862,14 @@ er_print::proc_cmd (CmdType cmd_type, int cparam,
 	}
       print_ctree (cmd_type);
       break;
+    case REGRESSIONS:
+      if (!dbev->comparingExperiments ())
+	{
+	  fprintf (out_file, GTXT ("\nOnly available when comparing experiments\n\n"));
+	  break;
+	}
+      print_regressions ();
+      break;
     case CSINGLE:
     case CPREPEND:
     case CAPPEND:
@@ -1448,6 +1456,9 @@ er_print::proc_cmd (CmdType cmd_type, int cparam,
     case DUMPENTITIES:
       dump_entities ();
       break;
+    case DUMP_LOAD_STATS:
+      dump_load_stats ();
+      break;
     case DUMP_PROFILE:
       dbev->dump_profile (out_file);
       break;
@@ -1559,6 +1570,12 @@ er_print::proc_cmd (CmdType cmd_type, int cparam,
 	  }
       }
       break;
+    case REFRESH_EXP:
+      {
+	long cnt = dbeSession->refresh_experiments ();
+	fprintf (out_file, GTXT ("%ld new events have been loaded\n"), cnt);
+      }
+      break;
     case HHELP:
       // automatically load machine model if applicable
       dbeDetectLoadMachineModel (dbevindex);
@@ -2443,6 +2460,18 @@ er_print::print_ctree (CmdType cmd_type)
   delete cd;
 }
 
+/*
+ * Method print_regressions() prints the call paths whose metric values
+ * increased in the compared experiments.
+ */
+void
+er_print::print_regressions ()
+{
+  er_print_regressions *cd = new er_print_regressions (dbev, limit);
+  print_cmd (cd);
+  delete cd;
+}
+
 void
 er_print::memobj (char *name, int cparam)
 {
@@ -2723,6 +2752,12 @@ er_print::dump_map ()
   dbeSession->dump_map (out_file);
 }
 
+void
+er_print::dump_load_stats ()
+{
+  dbeSession->dump_load_stats (out_file);
+}
+
 void
 er_print::dump_entities ()
 {
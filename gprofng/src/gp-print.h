@@ -91,6 +91,7 @@ private:
 		   char *func_name = NULL, char *sel = NULL);
   void print_gprof (CmdType cmd_type, char *func_name, char *sel);
   void print_ctree (CmdType cmd_type);
+  void print_regressions ();
   void print_dobj (Print_mode type, MetricList *mlist1,
 		   char *dobj_name = NULL, char *sel = NULL);
   void memobj (char *, int);
@@ -106,6 +107,7 @@ private:
   void dump_funcs (char *);
   void dump_dataobjects (char *);
   void dump_map ();
+  void dump_load_stats ();
   void dump_entities ();
   void dump_stats ();
   void dump_proc_warnings ();
@@ -120,6 +120,15 @@ Gprofng::usage ()
     "\n"
     " GPROFNG_MAX_CALL_STACK_DEPTH  set the depth of the call stack (default is 256).\n"
     "\n"
+    " GPROFNG_SFRAME_UNWIND         set to 0 to not use SFrame stack trace information\n"
+    "                               to unwind call stacks.\n"
+    "\n"
+    " GPROFNG_HWC_BATCH             set to N > 1 to read hardware counter samples from\n"
+    "                               the kernel in batches of N instead of one by one.\n"
+    "\n"
+    " GPROFNG_EXPERIMENT_CACHE      set to 1 to save the decoded experiment data in\n"
+    "                               the experiment and reuse it in later sessions.\n"
+    "\n"
     " GPROFNG_USE_JAVA_OPTIONS      may be set when profiling a C/C++ application\n"
     "                               that uses dlopen() to execute Java code.\n"
     "\n"
@@ -0,0 +1,82 @@
+/* Spend the time in random paths of a deep call tree, so that the
+   call tree of the profile has many nodes.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEPTH 150
+
+typedef long long hrtime_t;
+
+hrtime_t
+gethrtime (void)
+{
+  struct timespec tp;
+  hrtime_t rc = 0;
+#ifdef CLOCK_MONOTONIC_RAW
+  int r = clock_gettime (CLOCK_MONOTONIC_RAW, &tp);
+#else
+  int r = clock_gettime (CLOCK_MONOTONIC, &tp);
+#endif
+
+  if (r == 0)
+    rc = ((hrtime_t) tp.tv_sec) * 1e9 + (hrtime_t) tp.tv_nsec;
+  return rc;
+}
+
+volatile long x; /* temp variable for long calculation */
+
+static unsigned long seed = 1;
+
+static unsigned long
+next_random (void)
+{
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+  return seed >> 33;
+}
+
+static void __attribute__ ((noinline)) right (int depth);
+
+static void __attribute__ ((noinline))
+left (int depth)
+{
+  for (int j = 0; j < 20000; j++)
+    x = x + 1;
+  if (depth == 0)
+    return;
+  if (next_random () & 1)
+    left (depth - 1);
+  else
+    right (depth - 1);
+}
+
+static void __attribute__ ((noinline))
+right (int depth)
+{
+  for (int j = 0; j < 20000; j++)
+    x = x - 1;
+  if (depth == 0)
+    return;
+  if (next_random () & 1)
+    left (depth - 1);
+  else
+    right (depth - 1);
+}
+
+int
+main (int argc, char **argv)
+{
+  long long count = 0;
+  double secs = argc > 1 ? atof (argv[1]) : 2;
+  hrtime_t start = gethrtime ();
+
+  do
+    {
+      left (DEPTH);
+      count++;
+    }
+  while (start + secs * 1e9 > gethrtime ());
+  printf ("count=%lld  x=%lld\n", count, (long long) x);
+  return 0;
+}
@@ -0,0 +1,111 @@
+/* Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GNU Binutils.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef SHLIB
+int
+sframetest_shlib_func (int arg)
+{
+  return arg + 1;
+}
+#else
+typedef long long hrtime_t;
+
+static hrtime_t
+gethrtime (void)
+{
+  struct timespec tp;
+  hrtime_t rc = 0;
+  int r = clock_gettime (CLOCK_MONOTONIC, &tp);
+
+  if (r == 0)
+    rc = ((hrtime_t) tp.tv_sec) * 1000000000 + (hrtime_t) tp.tv_nsec;
+  return rc;
+}
+
+volatile long x; /* temp variable for long calculation */
+static volatile int done;
+
+__attribute__ ((noinline)) static void
+leaf (void)
+{
+  for (int j = 0; j < 100000; j++)
+    x = x + 1;
+}
+
+__attribute__ ((noinline)) static void
+middle (void)
+{
+  leaf ();
+  x = x + 1;
+}
+
+__attribute__ ((noinline)) static void
+outer (void)
+{
+  middle ();
+  x = x + 1;
+}
+
+/* Load and unload a library while the main thread is being profiled, so
+   that the collector updates its SFrame module table concurrently with
+   the unwinds.  */
+static void *
+dl_loop (void *arg)
+{
+  long n = 0;
+  while (!done)
+    {
+      void *h = dlopen ((const char *) arg, RTLD_NOW);
+      if (h == NULL)
+	{
+	  fprintf (stderr, "dlopen failed: %s\n", dlerror ());
+	  return NULL;
+	}
+      dlclose (h);
+      n++;
+    }
+  return (void *) n;
+}
+
+int
+main (int argc, char **argv)
+{
+  pthread_t thread;
+  void *n = NULL;
+
+  if (argc > 1)
+    pthread_create (&thread, NULL, dl_loop, argv[1]);
+
+  hrtime_t start = gethrtime ();
+  do
+    outer ();
+  while (start + 2000000000LL > gethrtime ());
+
+  done = 1;
+  if (argc > 1)
+    pthread_join (thread, &n);
+  printf ("x=%ld dlopen=%ld\n", x, (long) n);
+  return 0;
+}
+#endif
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 
 typedef long long hrtime_t;
@@ -25,6 +26,7 @@ int
 main (int argc, char **argv)
 {
   long long count = 0;
+  double secs = argc > 1 ? atof (argv[1]) : 2;
   hrtime_t start = gethrtime ();
 
   do
@@ -34,7 +36,7 @@ main (int argc, char **argv)
 	x = x + 1;
       count++;
     }
-  while (start + 2e9 > gethrtime ());
+  while (start + secs * 1e9 > gethrtime ());
   printf("count=%lld  x=%lld\n", count, x);
   return 0;
 }
@@ -0,0 +1,57 @@
+/* Spin in several threads for the given time.  */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NTHREADS 4
+
+typedef long long hrtime_t;
+
+hrtime_t
+gethrtime (void)
+{
+  struct timespec tp;
+  hrtime_t rc = 0;
+#ifdef CLOCK_MONOTONIC_RAW
+  int r = clock_gettime (CLOCK_MONOTONIC_RAW, &tp);
+#else
+  int r = clock_gettime (CLOCK_MONOTONIC, &tp);
+#endif
+
+  if (r == 0)
+    rc = ((hrtime_t) tp.tv_sec) * 1e9 + (hrtime_t) tp.tv_nsec;
+  return rc;
+}
+
+static double secs = 2;
+
+static void *
+spin (void *arg)
+{
+  volatile long x = 0;
+  hrtime_t start = gethrtime ();
+  do
+    for (int j = 0; j < 100000; j++)
+      x = x + 1;
+  while (start + secs * 1e9 > gethrtime ());
+  return arg;
+}
+
+int
+main (int argc, char **argv)
+{
+  pthread_t thr[NTHREADS];
+  if (argc > 1)
+    secs = atof (argv[1]);
+  for (int i = 0; i < NTHREADS; i++)
+    if (pthread_create (&thr[i], NULL, spin, NULL) != 0)
+      {
+	perror ("pthread_create");
+	return 1;
+      }
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_join (thr[i], NULL);
+  return 0;
+}